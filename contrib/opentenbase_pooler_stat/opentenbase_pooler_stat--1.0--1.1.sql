@@ -0,0 +1,26 @@
+/* contrib/opentenbase_pooler_stat/opentenbase_pooler_stat--1.0--1.1.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION opentenbase_pooler_stat UPDATE TO '1.1'" to load this file. \quit
+
+-- building_cnt shows the connections of each node pool being established.
+DROP FUNCTION opentenbase_get_pooler_conn_statistics();
+
+CREATE FUNCTION opentenbase_get_pooler_conn_statistics(
+	OUT database name,
+	OUT user_name name,
+	OUT node_name name,
+	OUT oid Oid,
+	OUT is_coord bool,
+	OUT conn_cnt int4,
+	OUT free_cnt int4,
+	OUT warming_cnt int4,
+	OUT query_cnt int4,
+	OUT exceed_keepalive_cnt int4,
+	OUT exceed_deadtime_cnt int4,
+	OUT exceed_maxlifetime_cnt int4,
+	OUT building_cnt int4
+)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
@@ -167,7 +167,7 @@ opentenbase_reset_pooler_cmd_statistics(PG_FUNCTION_ARGS)
 Datum
 opentenbase_get_pooler_conn_statistics(PG_FUNCTION_ARGS)
 {
-#define  LIST_POOLER_CONN_STATISTICS_COLUMNS 12
+#define  LIST_POOLER_CONN_STATISTICS_COLUMNS 13
     FuncCallContext 	 *funcctx = NULL;
     int32                ret = 0;
     Pooler_ConnState     *status = NULL;
@@ -175,45 +175,37 @@ opentenbase_get_pooler_conn_statistics(PG_FUNCTION_ARGS)
     bool		         nulls[LIST_POOLER_CONN_STATISTICS_COLUMNS];
     HeapTuple	         tuple;
     Datum		         result;
+    ReturnSetInfo        *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
 
     if (SRF_IS_FIRSTCALL())
     {
         MemoryContext oldcontext;
-        TupleDesc	  tupdesc;
+        TupleDesc	  tupdesc = NULL;
 
         /* content will destroy in SRF_RETURN_DONE */
         funcctx = SRF_FIRSTCALL_INIT();
 
         oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
 
-        tupdesc = CreateTemplateTupleDesc(LIST_POOLER_CONN_STATISTICS_COLUMNS, false);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 1, "database",
-                           NAMEOID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 2, "user_name",
-                           NAMEOID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 3, "node_name",
-                           NAMEOID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 4, "oid",
-                           OIDOID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 5, "is_coord",
-                           BOOLOID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 6, "conn_cnt",
-                           INT4OID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 7, "free_cnt",
-                           INT4OID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 8, "warming_cnt",
-                           INT4OID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 9, "query_cnt",
-                           INT4OID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 10, "exceed_keepalive_cnt",
-                           INT4OID, -1, 0);
         /*
-         * This field is reserved for compatibility
+         * Build the rows the way the installed SQL definition expects them,
+         * version 1.0 of the extension does not have building_cnt, which is
+         * the last column.
          */
-        TupleDescInitEntry(tupdesc, (AttrNumber) 11, "exceed_deadtime_cnt",
-                           INT4OID, -1, 0);
-        TupleDescInitEntry(tupdesc, (AttrNumber) 12, "exceed_maxlifetime_cnt",
-                           INT4OID, -1, 0);
+        if (rsinfo && IsA(rsinfo, ReturnSetInfo) && rsinfo->expectedDesc)
+        {
+            tupdesc = CreateTupleDescCopy(rsinfo->expectedDesc);
+        }
+        else if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        {
+            elog(ERROR, "return type must be a row type");
+        }
+
+        if (tupdesc->natts != LIST_POOLER_CONN_STATISTICS_COLUMNS &&
+            tupdesc->natts != LIST_POOLER_CONN_STATISTICS_COLUMNS - 1)
+        {
+            elog(ERROR, "unexpected number of result columns %d", tupdesc->natts);
+        }
 
         funcctx->tuple_desc = BlessTupleDesc(tupdesc);
 
@@ -268,6 +260,7 @@ opentenbase_get_pooler_conn_statistics(PG_FUNCTION_ARGS)
             nulls[9] = true;
             nulls[10] = true;
             nulls[11] = true;
+            nulls[12] = true;
         }
         else
         {
@@ -281,6 +274,8 @@ opentenbase_get_pooler_conn_statistics(PG_FUNCTION_ARGS)
             values[9] = UInt32GetDatum(pq_getmsgint(status->buf, sizeof(uint32)));
             values[10] = UInt32GetDatum(0);
             values[11] = UInt32GetDatum(pq_getmsgint(status->buf, sizeof(uint32)));
+            /* always read, only returned if building_cnt is present */
+            values[12] = UInt32GetDatum(pq_getmsgint(status->buf, sizeof(uint32)));
             status->node_cursor--;
         }
 
@@ -68,6 +68,7 @@
 #include "executor/tuptable.h"
 #ifdef XCP
 #include "lib/stringinfo.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #endif
 #ifdef _MLS_
@@ -1356,22 +1357,116 @@ get_typioparam_mod(Oid typioparam, int32 typmod)
     }
 }
 
+/*
+ * Receive functions of the columns of tupdesc that are not sent raw in a
+ * binary DataRow.
+ */
+static AttInMetadata *
+datarow_recv_metadata(TupleDesc tupdesc)
+{
+    int            natts = tupdesc->natts;
+    int            i;
+    Oid            attrecvfuncid;
+    AttInMetadata *attrecvmeta;
+
+    attrecvmeta = (AttInMetadata *) palloc(sizeof(AttInMetadata));
+    attrecvmeta->tupdesc = tupdesc;
+    attrecvmeta->attinfuncs = (FmgrInfo *) palloc0(natts * sizeof(FmgrInfo));
+    attrecvmeta->attioparams = (Oid *) palloc0(natts * sizeof(Oid));
+    attrecvmeta->atttypmods = (int32 *) palloc0(natts * sizeof(int32));
+
+    for (i = 0; i < natts; i++)
+    {
+        Form_pg_attribute attr = tupdesc->attrs[i];
+
+        if (attr->attisdropped || DATAROW_RAW_BYVAL(attr))
+            continue;
+
+        getTypeBinaryInputInfo(attr->atttypid, &attrecvfuncid,
+                               &attrecvmeta->attioparams[i]);
+        fmgr_info(attrecvfuncid, &attrecvmeta->attinfuncs[i]);
+        attrecvmeta->atttypmods[i] = attr->atttypmod;
+    }
+
+    return attrecvmeta;
+}
+
+/*
+ * Extract a column of a DataRow in binary format, see DATAROW_BINARY_FLAG.
+ */
+static Datum
+datarow_recv_value(TupleTableSlot *slot, int attnum, char *data, int len,
+                   StringInfo buffer)
+{
+    Form_pg_attribute attr = slot->tts_tupleDescriptor->attrs[attnum];
+    AttInMetadata *attrecvmeta = slot->tts_attrecvmeta;
+    Datum        value;
+
+    if (DATAROW_RAW_BYVAL(attr))
+    {
+        uint16        n16;
+        uint32        n32;
+
+        if (len != attr->attlen)
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+                     errmsg("incorrect binary data format in DataRow column %d", attnum + 1)));
+
+        switch (attr->attlen)
+        {
+            case 1:
+                return CharGetDatum(*data);
+            case 2:
+                memcpy(&n16, data, 2);
+                return Int16GetDatum((int16) ntohs(n16));
+            case 4:
+                memcpy(&n32, data, 4);
+                return Int32GetDatum((int32) ntohl(n32));
+#if SIZEOF_DATUM == 8
+            case 8:
+                {
+                    uint64        n64;
+
+                    memcpy(&n32, data, 4);
+                    n64 = (uint64) ntohl(n32) << 32;
+                    memcpy(&n32, data + 4, 4);
+                    n64 |= ntohl(n32);
+                    return Int64GetDatum((int64) n64);
+                }
+#endif
+            default:
+                elog(ERROR, "unsupported byval length: %d", (int) attr->attlen);
+        }
+    }
+
+    resetStringInfo(buffer);
+    appendBinaryStringInfo(buffer, data, len);
+
+    value = ReceiveFunctionCall(attrecvmeta->attinfuncs + attnum,
+                                buffer,
+                                attrecvmeta->attioparams[attnum],
+                                attrecvmeta->atttypmods[attnum]);
+
+    if (buffer->cursor != buffer->len)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+                 errmsg("incorrect binary data format in DataRow column %d", attnum + 1)));
+
+    return value;
+}
+
 /*
  * slot_deform_datarow
  *         Extract data from the DataRow message into Datum/isnull arrays.
  *
- * We always extract all attributes, as specified in tts_tupleDescriptor,
- * because there is no easy way to find random attribute in the DataRow.
- *
- * XXX There's an opportunity for optimization - we might extract only the
- * attributes we already need (up to some attnum), and keep a pointer to
- * the next byte in the DataRow message. On the next call we can either
- * return immediately if the attnum is already extracted, or deform next
- * chunk of the message. Not sure if this is worth the effort, as we're
- * likely to extract all attributes from the message eventually.
+ * Only the attributes up to attnum are extracted, the input functions of
+ * the columns behind the ones the caller needs are not run. There is no
+ * easy way to find random attribute in the DataRow, so the offset of the
+ * next attribute in the message is kept in tts_off and the next call goes
+ * on from there.
  */
 static void
-slot_deform_datarow(TupleTableSlot *slot)
+slot_deform_datarow(TupleTableSlot *slot, int attnum)
 {// #lizard forgives
     int natts;
     int i;
@@ -1381,31 +1476,50 @@ slot_deform_datarow(TupleTableSlot *slot)
     uint16        n16;
     uint32        n32;
     MemoryContext oldcontext;
+    bool        binary;
 
     Assert(slot->tts_tupleDescriptor != NULL);
     Assert(slot->tts_datarow != NULL);
 
     natts = slot->tts_tupleDescriptor->natts;
+    if (attnum > natts)
+        attnum = natts;
 
     /* fastpath: exit if values already extracted */
-    if (slot->tts_nvalid == natts)
+    if (slot->tts_nvalid >= attnum)
         return;
 
     memcpy(&n16, cur, 2);
     cur += 2;
     col_count = ntohs(n16);
+    binary = (col_count & DATAROW_BINARY_FLAG) != 0;
+    col_count &= ~DATAROW_BINARY_FLAG;
 
-    if (col_count != natts)
-        ereport(ERROR,
-                (errcode(ERRCODE_DATA_CORRUPTED),
-				 errmsg("Tuple does not match the descriptor, tuple cols %d, descriptor cols %d", 
-				 col_count, natts)));
+    if (slot->tts_nvalid == 0)
+    {
+        if (col_count != natts)
+            ereport(ERROR,
+                    (errcode(ERRCODE_DATA_CORRUPTED),
+                     errmsg("Tuple does not match the descriptor, tuple cols %d, descriptor cols %d",
+                     col_count, natts)));
+    }
+    else
+    {
+        /* go on behind the attributes extracted before */
+        cur = slot->tts_datarow->msg + slot->tts_off;
+    }
 
-    if (slot->tts_attinmeta == NULL)
+    /*
+     * Ensure info about input functions is available as long as slot lives
+     */
+    if (binary && slot->tts_attrecvmeta == NULL)
+    {
+        oldcontext = MemoryContextSwitchTo(slot->tts_mcxt);
+        slot->tts_attrecvmeta = datarow_recv_metadata(slot->tts_tupleDescriptor);
+        MemoryContextSwitchTo(oldcontext);
+    }
+    else if (!binary && slot->tts_attinmeta == NULL)
     {
-        /*
-         * Ensure info about input functions is available as long as slot lives
-         */
         oldcontext = MemoryContextSwitchTo(slot->tts_mcxt);
         slot->tts_attinmeta = TupleDescGetAttInMetadata(slot->tts_tupleDescriptor);
         MemoryContextSwitchTo(oldcontext);
@@ -1425,7 +1539,7 @@ slot_deform_datarow(TupleTableSlot *slot)
     }
 
     buffer = makeStringInfo();
-    for (i = 0; i < natts; i++)
+    for (i = slot->tts_nvalid; i < attnum; i++)
     {
         Form_pg_attribute attr = slot->tts_tupleDescriptor->attrs[i];
         int len;
@@ -1441,6 +1555,33 @@ slot_deform_datarow(TupleTableSlot *slot)
             slot->tts_values[i] = (Datum) 0;
             slot->tts_isnull[i] = true;
         }
+        else if (binary)
+        {
+            slot->tts_values[i] = datarow_recv_value(slot, i, cur, len, buffer);
+            slot->tts_isnull[i] = false;
+            cur += len;
+
+            /* keep the value as long as the datarow, see below */
+            if (!attr->attbyval)
+            {
+                Pointer        val = DatumGetPointer(slot->tts_values[i]);
+                Size        data_length;
+                void       *data;
+
+                if (attr->attlen == -1)
+                    data_length = VARSIZE_ANY(val);
+                else if (attr->attlen == -2)
+                    data_length = strlen(val) + 1;
+                else
+                    data_length = attr->attlen;
+                data = MemoryContextAlloc(slot->tts_drowcxt, data_length);
+                memcpy(data, val, data_length);
+
+                pfree(val);
+
+                slot->tts_values[i] = PointerGetDatum(data);
+            }
+        }
 #ifdef __OPENTENBASE__
         else if (len == -2)
         {
@@ -1564,7 +1705,8 @@ slot_deform_datarow(TupleTableSlot *slot)
     pfree(buffer->data);
     pfree(buffer);
 
-    slot->tts_nvalid = natts;
+    slot->tts_nvalid = attnum;
+    slot->tts_off = cur - slot->tts_datarow->msg;
 }
 
 /*
@@ -1617,10 +1759,10 @@ slot_getattr(TupleTableSlot *slot, int attnum, bool *isnull)
     }
 
 #ifdef PGXC
-    /* If it is a data row tuple extract all and return requested */
+    /* If it is a data row tuple extract up to the requested one */
     if (slot->tts_datarow)
     {
-        slot_deform_datarow(slot);
+        slot_deform_datarow(slot, attnum);
         *isnull = slot->tts_isnull[attnum - 1];
         return slot->tts_values[attnum - 1];
     }
@@ -1701,7 +1843,7 @@ slot_getallattrs(TupleTableSlot *slot)
     /* Handle the DataRow tuple case */
     if (slot->tts_datarow)
     {
-        slot_deform_datarow(slot);
+        slot_deform_datarow(slot, tdesc_natts);
         return;
     }
 #endif
@@ -1754,7 +1896,7 @@ slot_getsomeattrs(TupleTableSlot *slot, int attnum)
     /* Handle the DataRow tuple case */
     if (slot->tts_datarow)
     {
-        slot_deform_datarow(slot);
+        slot_deform_datarow(slot, attnum);
         return;
     }
 #endif
@@ -1830,10 +1972,10 @@ slot_attisnull(TupleTableSlot *slot, int attnum)
         return true;
 
 #ifdef PGXC
-    /* If it is a data row tuple extract all and return requested */
+    /* If it is a data row tuple extract up to the requested one */
     if (slot->tts_datarow)
     {
-        slot_deform_datarow(slot);
+        slot_deform_datarow(slot, attnum);
         return slot->tts_isnull[attnum - 1];
     }
 #endif
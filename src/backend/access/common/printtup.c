@@ -372,9 +372,10 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
     /*
      * If we are having DataRow-based tuple we do not have to encode attribute
      * values, just send over the DataRow message as we received it from the
-     * Datanode
+     * Datanode. DataRows in binary format are only understood by other nodes.
      */
-    if (slot->tts_datarow && !binary)
+    if (slot->tts_datarow && !binary &&
+        (!DataRowIsBinary(slot->tts_datarow) || !IsConnFromApp()))
     {
         pq_putmessage('D', slot->tts_datarow->msg, slot->tts_datarow->msglen);
 
@@ -86,7 +86,9 @@
 #ifdef __OPENTENBASE__
 #include "storage/nodelock.h"
 #include "access/xact.h"
+#include "pgxc/locator.h"
 #include "pgxc/shardmap.h"
+#include "storage/extentmapping.h"
 #endif
 #ifdef _MLS_
 #include "catalog/pg_authid.h"
@@ -323,6 +325,9 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
     ItemPointerSetInvalid(&scan->rs_ctup.t_self);
     scan->rs_cbuf = InvalidBuffer;
     scan->rs_cblock = InvalidBlockNumber;
+#ifdef _SHARDING_
+    scan->rs_shard_eid = InvalidExtentID;
+#endif
 
     /* page-at-a-time fields are always invalid when not rs_inited */
 
@@ -360,6 +365,23 @@ heap_setscanlimits(HeapScanDesc scan, BlockNumber startBlk, BlockNumber numBlks)
     scan->rs_numblocks = numBlks;
 }
 
+#ifdef _SHARDING_
+/*
+ * heap_setscanshards - restrict a heapscan to the extents of some shards
+ *
+ * The caller guarantees that no tuple outside these shards can qualify, so
+ * whole extents of other shards are skipped without being read.
+ */
+void
+heap_setscanshards(HeapScanDesc scan, Bitmapset *shards)
+{
+    Assert(!scan->rs_inited);    /* else too late to change */
+
+    scan->rs_shards = ShardScanPruningEnabled() ? shards : NULL;
+    scan->rs_shard_eid = InvalidExtentID;
+}
+#endif
+
 /*
  * heapgetpage - subroutine for heapgettup()
  *
@@ -495,6 +517,68 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
     scan->rs_ntuples = ntup;
 }
 
+#ifdef _SHARDING_
+/*
+ * heap_extent_is_hidden - can a page be skipped without reading it?
+ *
+ * Every extent holds the tuples of exactly one shard, and the extent mapping
+ * records which one. When the session can only see part of the shards, or
+ * the scan was restricted to some shards by heap_setscanshards, look up the
+ * extent of the page there so that extents of other shards are skipped
+ * before their pages are read. The answer is cached per extent, so the EMA
+ * is visited once for every PAGES_PER_EXTENTS pages at most.
+ *
+ * Returns false when the EMA does not know the extent; the caller then reads
+ * the page and decides by its header as before.
+ */
+static bool
+heap_extent_is_hidden(HeapScanDesc scan, BlockNumber page)
+{
+    Snapshot    snapshot = scan->rs_snapshot;
+    ExtentID    eid;
+    ShardID        sid;
+    bool        check_visible;
+    bool        shard_is_visible;
+
+    if (!RelationHasExtent(scan->rs_rd))
+        return false;
+
+    check_visible = IS_PGXC_DATANODE
+        && IsConnFromApp()
+        && g_ShardVisibleMode != SHARD_VISIBLE_MODE_ALL
+        && IsMVCCSnapshot(snapshot);
+    if (!check_visible && scan->rs_shards == NULL)
+        return false;
+
+    eid = page / PAGES_PER_EXTENTS;
+    if (eid == scan->rs_shard_eid)
+        return scan->rs_shard_hidden;
+
+    if (!ema_get_eme_shardid(scan->rs_rd, eid, &sid))
+        return false;
+
+    scan->rs_shard_eid = eid;
+    if (scan->rs_shards != NULL && !bms_is_member(sid, scan->rs_shards))
+    {
+        scan->rs_shard_hidden = true;
+    }
+    else if (check_visible)
+    {
+        shard_is_visible = bms_is_member(sid/snapshot->groupsize,
+                                         SnapshotGetShardTable(snapshot));
+        scan->rs_shard_hidden =
+            (!shard_is_visible && g_ShardVisibleMode == SHARD_VISIBLE_MODE_VISIBLE)
+            || (shard_is_visible && g_ShardVisibleMode == SHARD_VISIBLE_MODE_HIDDEN);
+    }
+    else
+    {
+        scan->rs_shard_hidden = false;
+    }
+
+    return scan->rs_shard_hidden;
+}
+#endif
+
 /* ----------------
  *        heapgettup - fetch next heap tuple
  *
@@ -534,6 +618,9 @@ heapgettup(HeapScanDesc scan,
     OffsetNumber lineoff;
     int            linesleft;
     ItemId        lpp;
+#ifdef _SHARDING_
+    bool        skip_unread = false;
+#endif
 
     /*
      * calculate next starting lineoff, given scan direction
@@ -789,16 +876,27 @@ get_next_page:
             return;
         }
 
-        heapgetpage(scan, page);
+#ifdef _SHARDING_
+        /* skip extents of hidden shards before reading any of their pages */
+        skip_unread = heap_extent_is_hidden(scan, page);
+        if (!skip_unread)
+#endif
+        {
+            heapgetpage(scan, page);
 
-        LockBuffer(scan->rs_cbuf, BUFFER_LOCK_SHARE);
+            LockBuffer(scan->rs_cbuf, BUFFER_LOCK_SHARE);
 
-        dp = BufferGetPage(scan->rs_cbuf);
+            dp = BufferGetPage(scan->rs_cbuf);
+        }
 
 #ifdef _SHARDING_
         {
-            bool to_skip = false;
-            if(PageIsNew(dp))
+            bool to_skip = skip_unread;
+            if(to_skip)
+            {
+                /* already decided by the extent mapping */
+            }
+            else if(PageIsNew(dp))
             {
                 to_skip = true;
             }
@@ -824,24 +922,37 @@ get_next_page:
             {
                 if (scan->rs_parallel != NULL)
                 {
+                    pgBufferUsage.shard_blks_skipped++;
                     page = heap_parallelscan_nextpage(scan);
                     finished = (page == InvalidBlockNumber);
                 }
                 else if(ScanDirectionIsForward(dir))
                 {
+                    BlockNumber oldpage = page;
+
                     if(RelationHasExtent(scan->rs_rd))
                         page = (page / PAGES_PER_EXTENTS + 1) * PAGES_PER_EXTENTS;
                     else
                         page++;
+                    pgBufferUsage.shard_blks_skipped +=
+                        Min(page, scan->rs_nblocks) - oldpage;
 
                     if (page >= scan->rs_nblocks)
                         page = 0;
-                    finished = (page == scan->rs_startblock) ||
+                    /* don't jump over a start block in the middle of an extent */
+                    finished = (oldpage < scan->rs_startblock &&
+                                (page > scan->rs_startblock || page == 0)) ||
+                        (page == scan->rs_startblock) ||
                         (scan->rs_numblocks != InvalidBlockNumber ? --scan->rs_numblocks == 0 : false);
             
                 }
                 else if((ScanDirectionIsBackward(dir)))
                 {
+                    if(RelationHasExtent(scan->rs_rd))
+                        pgBufferUsage.shard_blks_skipped += page % PAGES_PER_EXTENTS + 1;
+                    else
+                        pgBufferUsage.shard_blks_skipped++;
+
                     finished = (page == scan->rs_startblock) ||
                         (scan->rs_numblocks != InvalidBlockNumber ? --scan->rs_numblocks == 0 : false);
                     if (page == 0)
@@ -865,7 +976,8 @@ get_next_page:
                         
                 }
 
-                LockBuffer(scan->rs_cbuf, BUFFER_LOCK_UNLOCK);
+                if (!skip_unread)
+                    LockBuffer(scan->rs_cbuf, BUFFER_LOCK_UNLOCK);
                 goto get_next_page;
             }
         }
@@ -916,6 +1028,9 @@ heapgettup_pagemode(HeapScanDesc scan,
     OffsetNumber lineoff;
     int            linesleft;
     ItemId        lpp;
+#ifdef _SHARDING_
+    bool        skip_unread = false;
+#endif
 
     /*
      * calculate next starting lineindex, given scan direction
@@ -1157,14 +1272,25 @@ get_next_page:
             return;
         }
 
-        heapgetpage(scan, page);
+#ifdef _SHARDING_
+        /* skip extents of hidden shards before reading any of their pages */
+        skip_unread = heap_extent_is_hidden(scan, page);
+        if (!skip_unread)
+#endif
+        {
+            heapgetpage(scan, page);
 
-        dp = BufferGetPage(scan->rs_cbuf);
+            dp = BufferGetPage(scan->rs_cbuf);
+        }
 #ifdef _SHARDING_
         if(RelationHasExtent(scan->rs_rd))
         {
-            bool to_skip = false;
-            if(PageIsNew(dp))
+            bool to_skip = skip_unread;
+            if(to_skip)
+            {
+                /* already decided by the extent mapping */
+            }
+            else if(PageIsNew(dp))
             {
                 to_skip = true;
             }
@@ -1190,6 +1316,7 @@ get_next_page:
             {
                 if (scan->rs_parallel != NULL)
                 {
+                    pgBufferUsage.shard_blks_skipped++;
                     page = heap_parallelscan_nextpage(scan);
                     finished = (page == InvalidBlockNumber);
                 }
@@ -1198,6 +1325,8 @@ get_next_page:
                     BlockNumber oldpage = page;
                     page = (page / PAGES_PER_EXTENTS + 1) * PAGES_PER_EXTENTS;
                     scan->rs_numblocks = scan->rs_numblocks - (page - oldpage);
+                    pgBufferUsage.shard_blks_skipped +=
+                        Min(page, scan->rs_nblocks) - oldpage;
 
                     if (page >= scan->rs_nblocks)
                         page = 0;
@@ -1212,6 +1341,7 @@ get_next_page:
                 {
                     BlockNumber oldpage = page;
 
+                    pgBufferUsage.shard_blks_skipped += page % PAGES_PER_EXTENTS + 1;
                     if(page < PAGES_PER_EXTENTS)
                     {
                         page = scan->rs_nblocks - 1;
@@ -1672,6 +1802,9 @@ heap_beginscan_internal(Relation relation, Snapshot snapshot,
     scan->rs_allow_sync = allow_sync;
     scan->rs_temp_snap = temp_snap;
     scan->rs_parallel = parallel_scan;
+#ifdef _SHARDING_
+    scan->rs_shards = NULL;
+#endif
 
     /*
      * we can use page-at-a-time mode if it's an MVCC-safe snapshot
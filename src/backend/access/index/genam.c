@@ -126,6 +126,10 @@ RelationGetIndexScan(Relation indexRelation, int nkeys, int norderbys)
     scan->xs_ctup.t_data = NULL;
     scan->xs_cbuf = InvalidBuffer;
     scan->xs_continue_hot = false;
+#ifdef _SHARDING_
+    scan->xs_shards = NULL;
+    scan->xs_shard_eid = InvalidExtentID;
+#endif
 
     return scan;
 }
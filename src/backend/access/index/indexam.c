@@ -84,6 +84,12 @@
 #include "utils/snapmgr.h"
 #include "utils/tqual.h"
 #include "access/xact.h"
+#ifdef _SHARDING_
+#include "storage/extentmapping.h"
+#endif
+#ifdef __OPENTENBASE__
+#include "pgxc/locator.h"
+#endif
 
 
 /* ----------------------------------------------------------------
@@ -729,6 +735,47 @@ index_fetch_heap(IndexScanDesc scan)
     return NULL;
 }
 
+#ifdef _SHARDING_
+/* ----------------
+ *        index_setscanshards - restrict heap fetches to some shards
+ *
+ * The caller guarantees that no heap tuple outside these shards can qualify,
+ * so TIDs pointing into extents of other shards are dropped before the heap
+ * is visited.  Has no effect on relations without extents.
+ * ----------------
+ */
+void
+index_setscanshards(IndexScanDesc scan, Bitmapset *shards)
+{
+    if (scan->heapRelation && RelationHasExtent(scan->heapRelation) &&
+        ShardScanPruningEnabled())
+        scan->xs_shards = shards;
+    scan->xs_shard_eid = InvalidExtentID;
+}
+
+/*
+ * Does the TID point into an extent of a shard outside xs_shards?  The
+ * answer is cached per extent, so runs of TIDs in the same extent cost a
+ * single EMA lookup.
+ */
+static bool
+index_tid_is_skipped(IndexScanDesc scan, ItemPointer tid)
+{
+    ExtentID    eid = ItemPointerGetBlockNumber(tid) / PAGES_PER_EXTENTS;
+    ShardID        sid;
+
+    if (eid != scan->xs_shard_eid)
+    {
+        scan->xs_shard_eid = eid;
+        scan->xs_shard_skip =
+            ema_get_eme_shardid(scan->heapRelation, eid, &sid) &&
+            !bms_is_member(sid, scan->xs_shards);
+    }
+
+    return scan->xs_shard_skip;
+}
+#endif
+
 /* ----------------
  *        index_getnext - get the next heap tuple from a scan
  *
@@ -770,6 +817,11 @@ index_getnext(IndexScanDesc scan, ScanDirection direction)
             /* If we're out of index entries, we're done */
             if (tid == NULL)
                 break;
+#ifdef _SHARDING_
+            /* don't visit the heap for tuples of shards the scan excludes */
+            if (scan->xs_shards != NULL && index_tid_is_skipped(scan, tid))
+                continue;
+#endif
         }
 
         /*
@@ -46,6 +46,11 @@
 #include "pgxc/nodemgr.h"
 #include "access/xlog.h"
 #include "storage/lmgr.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "portability/instr_time.h"
 #endif
 
 /* To access sequences */
@@ -68,6 +73,7 @@ int reconnect_gtm_retry_interval = 500;
 char *GtmHost = NULL;
 int GtmPort = 0;
 static int GtmConnectTimeout = 60;
+bool enable_gts_batch = false;
 bool IsXidFromGTM = false;
 bool gtm_backup_barrier = false;
 extern bool FirstSnapshotSet;
@@ -86,6 +92,29 @@ typedef struct
 } PG_Storage_status;
 
 #define    GTM_CHECK_DELTA  (10  * 1000 * 1000)
+
+/*
+ * Shared state for coalescing concurrent snapshot GTS requests, see
+ * GetSnapshotGlobalTimestampGTM().
+ */
+typedef struct GTSBatchCtlData
+{
+    pg_atomic_uint64 requests;      /* requests registered so far */
+
+    slock_t        mutex;           /* protects the fields below */
+    uint64         completed;       /* requests answered by last_gts */
+    GTM_Timestamp  last_gts;
+    bool           last_readonly;
+
+    /* statistics */
+    uint64         nbatches;
+    uint64         nrequests;
+    uint64         max_batch_size;
+    uint64         total_latency;   /* in microseconds */
+    uint64         max_latency;
+} GTSBatchCtlData;
+
+static GTSBatchCtlData *GTSBatchCtl = NULL;
 List *g_CreateSeqList = NULL;
 List *g_DropSeqList   = NULL;
 List *g_AlterSeqList  = NULL;
@@ -1473,19 +1502,19 @@ CloseGTM(void)
 }
 
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
-GTM_Timestamp 
-GetGlobalTimestampGTM(void)
+/*
+ * Fetch a global timestamp from GTM over this backend's own connection,
+ * resetting the connection and retrying on failure.  'snapshot' marks
+ * timestamps only used for a snapshot, which a GTM proxy may share between
+ * concurrent requests.
+ */
+static Get_GTS_Result
+FetchGlobalTimestampGTM(bool snapshot)
 {
 	struct rusage start_r;
 	struct timeval start_t;
 	int  retry_cnt = 0;
 	Get_GTS_Result gts_result = {InvalidGlobalTimestamp,false};
-	GTM_Timestamp  latest_gts = InvalidGlobalTimestamp;
-
-	if (!g_set_global_snapshot)
-	{
-		return LocalCommitTimestamp;
-	}
 
     if (log_gtm_stats)
         ResetUsageCommon(&start_r, &start_t);
@@ -1494,7 +1523,8 @@ GetGlobalTimestampGTM(void)
     // TODO Isolation level
     if (conn)
     {
-        gts_result =  get_global_timestamp(conn);
+        gts_result = snapshot ? get_snapshot_global_timestamp(conn) :
+                                get_global_timestamp(conn);
     }
     else if(GTMDebugPrint)
     {
@@ -1519,7 +1549,8 @@ GetGlobalTimestampGTM(void)
 
         if (conn)
         {
-            gts_result = get_global_timestamp(conn);
+            gts_result = snapshot ? get_snapshot_global_timestamp(conn) :
+                                    get_global_timestamp(conn);
 			if (GlobalTimestampIsValid(gts_result.gts))
 			{
 				elog(DEBUG5, "retry get global timestamp gts " INT64_FORMAT,
@@ -1550,6 +1581,18 @@ GetGlobalTimestampGTM(void)
     if (log_gtm_stats)
         ShowUsageCommon("BeginTranGTM", &start_r, &start_t);
 
+	return gts_result;
+}
+
+/*
+ * Validate a timestamp obtained from GTM against the local commit timestamp
+ * and adjust it for standby query delay.
+ */
+static GTM_Timestamp
+FinishGlobalTimestampGTM(Get_GTS_Result gts_result)
+{
+	GTM_Timestamp  latest_gts = InvalidGlobalTimestamp;
+
 	latest_gts = GetLatestCommitTS();
 	if (gts_result.gts != InvalidGlobalTimestamp && latest_gts > (gts_result.gts + GTM_CHECK_DELTA))
 	{
@@ -1573,8 +1616,201 @@ GetGlobalTimestampGTM(void)
 	
 	return gts_result.gts;
 }
+
+GTM_Timestamp 
+GetGlobalTimestampGTM(void)
+{
+	if (!g_set_global_snapshot)
+	{
+		return LocalCommitTimestamp;
+	}
+
+	return FinishGlobalTimestampGTM(FetchGlobalTimestampGTM(false));
+}
+
+/*
+ * Return true and the published timestamp if the last completed batch was
+ * requested from GTM after request number 'reqno' had been registered.
+ */
+static bool
+GTSBatchLookup(uint64 reqno, Get_GTS_Result *result)
+{
+	bool found = false;
+
+	SpinLockAcquire(&GTSBatchCtl->mutex);
+	if (GTSBatchCtl->completed >= reqno)
+	{
+		result->gts = GTSBatchCtl->last_gts;
+		result->gtm_readonly = GTSBatchCtl->last_readonly;
+		found = true;
+	}
+	SpinLockRelease(&GTSBatchCtl->mutex);
+
+	return found;
+}
+
+/*
+ * GetSnapshotGlobalTimestampGTM
+ *
+ * Get a global timestamp for a snapshot.  With enable_gts_batch, concurrent
+ * callers on this node are coalesced in the style of XLogFlush(): whoever
+ * gets GTSBatchLock asks GTM once on behalf of every request registered so
+ * far, and the others pick up the published result.  A request is only ever
+ * answered by a timestamp that was asked for after the request registered,
+ * so the result is no older than the one the caller would have got alone.
+ */
+GTM_Timestamp
+GetSnapshotGlobalTimestampGTM(void)
+{
+	Get_GTS_Result gts_result = {InvalidGlobalTimestamp,false};
+	uint64		reqno;
+
+	if (!g_set_global_snapshot)
+	{
+		return LocalCommitTimestamp;
+	}
+
+	if (!enable_gts_batch || GTSBatchCtl == NULL)
+	{
+		return FinishGlobalTimestampGTM(FetchGlobalTimestampGTM(true));
+	}
+
+	reqno = pg_atomic_add_fetch_u64(&GTSBatchCtl->requests, 1);
+
+	for (;;)
+	{
+		uint64		upto;
+		uint64		batch_size;
+		uint64		latency;
+		instr_time	start;
+		instr_time	duration;
+
+		if (GTSBatchLookup(reqno, &gts_result))
+			break;
+
+		/* someone else is asking GTM, wait for it and look again */
+		if (!LWLockAcquireOrWait(GTSBatchLock, LW_EXCLUSIVE))
+			continue;
+
+		if (GTSBatchLookup(reqno, &gts_result))
+		{
+			LWLockRelease(GTSBatchLock);
+			break;
+		}
+
+		/* we are the leader, everything registered until now rides along */
+		upto = pg_atomic_read_u64(&GTSBatchCtl->requests);
+
+		INSTR_TIME_SET_CURRENT(start);
+		gts_result = FetchGlobalTimestampGTM(true);
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, start);
+		latency = INSTR_TIME_GET_MICROSEC(duration);
+
+		/*
+		 * Only publish valid timestamps, on failure the waiters will each
+		 * take their turn at GTM and report the error themselves.
+		 */
+		if (GlobalTimestampIsValid(gts_result.gts))
+		{
+			SpinLockAcquire(&GTSBatchCtl->mutex);
+			batch_size = upto - GTSBatchCtl->completed;
+			GTSBatchCtl->completed = upto;
+			GTSBatchCtl->last_gts = gts_result.gts;
+			GTSBatchCtl->last_readonly = gts_result.gtm_readonly;
+			GTSBatchCtl->nbatches++;
+			GTSBatchCtl->nrequests += batch_size;
+			GTSBatchCtl->total_latency += latency;
+			if (batch_size > GTSBatchCtl->max_batch_size)
+				GTSBatchCtl->max_batch_size = batch_size;
+			if (latency > GTSBatchCtl->max_latency)
+				GTSBatchCtl->max_latency = latency;
+			SpinLockRelease(&GTSBatchCtl->mutex);
+		}
+
+		LWLockRelease(GTSBatchLock);
+		break;
+	}
+
+	return FinishGlobalTimestampGTM(gts_result);
+}
 #endif
 
+Size
+GTSBatchShmemSize(void)
+{
+	return sizeof(GTSBatchCtlData);
+}
+
+void
+GTSBatchShmemInit(void)
+{
+	bool		found;
+
+	GTSBatchCtl = (GTSBatchCtlData *)
+		ShmemInitStruct("GTS batch control", GTSBatchShmemSize(), &found);
+
+	if (!found)
+	{
+		MemSet(GTSBatchCtl, 0, sizeof(GTSBatchCtlData));
+		pg_atomic_init_u64(&GTSBatchCtl->requests, 0);
+		SpinLockInit(&GTSBatchCtl->mutex);
+		GTSBatchCtl->last_gts = InvalidGlobalTimestamp;
+	}
+}
+
+/*
+ * pg_stat_get_gts_batch - statistics of batched snapshot GTS acquisition
+ * on this node.
+ */
+Datum
+pg_stat_get_gts_batch(PG_FUNCTION_ARGS)
+{
+#define GTS_BATCH_STAT_COLUMNS 6
+	TupleDesc	tupdesc;
+	Datum		values[GTS_BATCH_STAT_COLUMNS];
+	bool		nulls[GTS_BATCH_STAT_COLUMNS];
+	uint64		nbatches;
+	uint64		nrequests;
+	uint64		max_batch_size;
+	uint64		total_latency;
+	uint64		max_latency;
+
+	/* this had better match function's declaration in pg_proc.h */
+	tupdesc = CreateTemplateTupleDesc(GTS_BATCH_STAT_COLUMNS, false);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "batches",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "requests",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "avg_batch_size",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "max_batch_size",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "avg_latency_us",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "max_latency_us",
+					   INT8OID, -1, 0);
+	BlessTupleDesc(tupdesc);
+	MemSet(nulls, false, sizeof(nulls));
+
+	SpinLockAcquire(&GTSBatchCtl->mutex);
+	nbatches = GTSBatchCtl->nbatches;
+	nrequests = GTSBatchCtl->nrequests;
+	max_batch_size = GTSBatchCtl->max_batch_size;
+	total_latency = GTSBatchCtl->total_latency;
+	max_latency = GTSBatchCtl->max_latency;
+	SpinLockRelease(&GTSBatchCtl->mutex);
+
+	values[0] = Int64GetDatum(nbatches);
+	values[1] = Int64GetDatum(nrequests);
+	values[2] = Float8GetDatum(nbatches ? (double) nrequests / nbatches : 0);
+	values[3] = Int64GetDatum(max_batch_size);
+	values[4] = Float8GetDatum(nbatches ? (double) total_latency / nbatches : 0);
+	values[5] = Int64GetDatum(max_latency);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
 GlobalTransactionId
 BeginTranGTM(GTM_Timestamp *timestamp, const char *globalSession)
 {
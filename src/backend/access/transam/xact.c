@@ -53,6 +53,7 @@
 #include "catalog/storage.h"
 #include "commands/async.h"
 #include "commands/dbcommands.h"
+#include "commands/sequence.h"
 #include "commands/tablecmds.h"
 #include "commands/trigger.h"
 #include "executor/spi.h"
@@ -3132,10 +3133,16 @@ CommitTransaction(void)
     AtEOXact_GUC(true, 1);
     AtEOXact_SPI(true);
     AtEOXact_on_commit_actions(true);
+#ifdef __OPENTENBASE__
+    AtEOXact_SeqCache(true);
+#endif
     AtEOXact_Namespace(true, is_parallel_worker);
     AtEOXact_SMgr();
     AtEOXact_Files();
     AtEOXact_ComboCid();
+#ifdef __OPENTENBASE__
+    AtEOXact_SharedQueueFilters();
+#endif
     AtEOXact_HashTables(true);
     AtEOXact_PgStat(true);
     AtEOXact_Snapshot(true, false);
@@ -3571,10 +3578,16 @@ PrepareTransaction(void)
     AtEOXact_GUC(true, 1);
     AtEOXact_SPI(true);
     AtEOXact_on_commit_actions(true);
+#ifdef __OPENTENBASE__
+    AtEOXact_SeqCache(false);
+#endif
     AtEOXact_Namespace(true, false);
     AtEOXact_SMgr();
     AtEOXact_Files();
     AtEOXact_ComboCid();
+#ifdef __OPENTENBASE__
+    AtEOXact_SharedQueueFilters();
+#endif
     AtEOXact_HashTables(true);
     /* don't call AtEOXact_PgStat here; we fixed pgstat state above */
     AtEOXact_Snapshot(true, true);
@@ -4162,10 +4175,16 @@ AbortTransaction(void)
         AtEOXact_GUC(false, 1);
         AtEOXact_SPI(false);
         AtEOXact_on_commit_actions(false);
+#ifdef __OPENTENBASE__
+        AtEOXact_SeqCache(false);
+#endif
         AtEOXact_Namespace(false, is_parallel_worker);
         AtEOXact_SMgr();
         AtEOXact_Files();
         AtEOXact_ComboCid();
+#ifdef __OPENTENBASE__
+        AtEOXact_SharedQueueFilters();
+#endif
         AtEOXact_HashTables(false);
         AtEOXact_PgStat(false);
         AtEOXact_ApplyLauncher(false);
@@ -6287,6 +6306,10 @@ CommitSubTransaction(void)
     AtEOSubXact_SPI(true, s->subTransactionId);
     AtEOSubXact_on_commit_actions(true, s->subTransactionId,
                                   s->parent->subTransactionId);
+#ifdef __OPENTENBASE__
+    AtEOSubXact_SeqCache(true, s->subTransactionId,
+                         s->parent->subTransactionId);
+#endif
     AtEOSubXact_Namespace(true, s->subTransactionId,
                           s->parent->subTransactionId);
     AtEOSubXact_Files(true, s->subTransactionId,
@@ -6459,6 +6482,10 @@ AbortSubTransaction(void)
         AtEOSubXact_SPI(false, s->subTransactionId);
         AtEOSubXact_on_commit_actions(false, s->subTransactionId,
                                       s->parent->subTransactionId);
+#ifdef __OPENTENBASE__
+        AtEOSubXact_SeqCache(false, s->subTransactionId,
+                             s->parent->subTransactionId);
+#endif
         AtEOSubXact_Namespace(false, s->subTransactionId,
                               s->parent->subTransactionId);
         AtEOSubXact_Files(false, s->subTransactionId,
@@ -884,6 +884,16 @@ CREATE VIEW pg_stat_bgwriter AS
         pg_stat_get_buf_alloc() AS buffers_alloc,
         pg_stat_get_bgwriter_stat_reset_time() AS stats_reset;
 
+CREATE VIEW pg_stat_gts_batch AS
+    SELECT
+        s.batches,
+        s.requests,
+        s.avg_batch_size,
+        s.max_batch_size,
+        s.avg_latency_us,
+        s.max_latency_us
+    FROM pg_stat_get_gts_batch() s;
+
 CREATE VIEW pg_stat_progress_vacuum AS
 	SELECT
 		S.pid AS pid, S.datid AS datid, D.datname AS datname,
@@ -69,6 +69,7 @@
 #include "utils/portal.h"
 #include "utils/rel.h"
 #include "utils/rls.h"
+#include "portability/instr_time.h"
 #include "utils/snapmgr.h"
 #ifdef __OPENTENBASE__
 #include "utils/rel.h"
@@ -269,6 +270,20 @@ typedef struct CopyStateData
     int        data_ncolumns;
     int        ndatarows;
     bool       whole_line;
+
+    /*
+     * Partial parsing on the coordinator, see CopyFromSetupPartialParse().
+     * parse_fields is the number of leading fields to tokenize, 0 for all,
+     * and parse_flags marks the columns converted to datums.
+     */
+    int         parse_fields;
+    bool       *parse_flags;
+
+    /* per stage timing of a distributed COPY FROM, see CopyFromReportStats() */
+    bool        copy_stats;
+    instr_time  read_time;      /* reading lines from the source */
+    instr_time  parse_time;     /* tokenizing and converting fields */
+    instr_time  send_time;      /* routing and sending lines to datanodes */
 #endif
 } CopyStateData;
 
@@ -384,6 +399,10 @@ static int CopyReadAttributesInternal(CopyState cstate);
 #endif
 static int    CopyReadAttributesText(CopyState cstate);
 static int    CopyReadAttributesCSV(CopyState cstate);
+#ifdef __OPENTENBASE__
+static void CopyFromSetupPartialParse(CopyState cstate);
+static void CopyFromReportStats(CopyState cstate, uint64 processed);
+#endif
 static Datum CopyReadBinaryAttribute(CopyState cstate,
                         int column_no, FmgrInfo *flinfo,
                         Oid typioparam, int32 typmod,
@@ -2977,6 +2996,8 @@ CopyFrom(CopyState cstate)
     int         npart             = 0;
     bool        need_to_reset     = false;
     bool        nomore            = false;
+    instr_time  stage_start;
+    instr_time  stage_end;
 #endif
 
     Assert(cstate->rel);
@@ -3283,6 +3304,9 @@ CopyFrom(CopyState cstate)
         MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
    
 #ifdef __OPENTENBASE__
+        if (cstate->copy_stats)
+            INSTR_TIME_SET_CURRENT(stage_start);
+
         /* skip error line when copy from */
 
         if (g_enable_copy_silence)
@@ -3338,6 +3362,13 @@ readnextline:
                 break;
 #ifdef __OPENTENBASE__
         }
+
+        if (cstate->copy_stats)
+        {
+            INSTR_TIME_SET_CURRENT(stage_end);
+            INSTR_TIME_ACCUM_DIFF(cstate->parse_time, stage_end, stage_start);
+            stage_start = stage_end;
+        }
 #endif
 
 
@@ -3414,6 +3445,13 @@ readnextline:
                              errmsg("Copy failed on a data node:%s", sql->data)));
             }
             processed++;
+#ifdef __OPENTENBASE__
+            if (cstate->copy_stats)
+            {
+                INSTR_TIME_SET_CURRENT(stage_end);
+                INSTR_TIME_ACCUM_DIFF(cstate->send_time, stage_end, stage_start);
+            }
+#endif
         }
         else
         {
@@ -3926,6 +3964,9 @@ readnextline:
     error_context_stack = errcallback.previous;
 
 #ifdef __OPENTENBASE__
+    if (cstate->copy_stats)
+        CopyFromReportStats(cstate, processed);
+
     if(IS_PGXC_DATANODE && RelationGetNParts(cstate->rel)> 0)
     {
         int i = 0;
@@ -4450,6 +4491,10 @@ BeginCopyFrom(ParseState *pstate,
         cstate->raw_fields = (char **) palloc(nfields * sizeof(char *));
     }
 
+#ifdef __OPENTENBASE__
+    CopyFromSetupPartialParse(cstate);
+#endif
+
     MemoryContextSwitchTo(oldcontext);
 
     return cstate;
@@ -4486,6 +4531,20 @@ NextCopyFromRawFields(CopyState cstate, char ***fields, int *nfields)
     cstate->cur_lineno++;
 
     /* Actually read the line into memory here */
+#ifdef __OPENTENBASE__
+    if (cstate->copy_stats)
+    {
+        instr_time start;
+        instr_time duration;
+
+        INSTR_TIME_SET_CURRENT(start);
+        done = CopyReadLine(cstate);
+        INSTR_TIME_SET_CURRENT(duration);
+        INSTR_TIME_SUBTRACT(duration, start);
+        INSTR_TIME_ADD(cstate->read_time, duration);
+    }
+    else
+#endif
     done = CopyReadLine(cstate);
 
     /*
@@ -4649,6 +4708,12 @@ NextCopyFrom(CopyState cstate, ExprContext *econtext,
             int            attnum = lfirst_int(cur);
             int            m = attnum - 1;
 
+#ifdef __OPENTENBASE__
+            /* the datanodes check and convert the rest of the line */
+            if (cstate->parse_fields > 0 && fieldno >= cstate->parse_fields)
+                break;
+#endif
+
             if (fieldno >= fldct)
                 ereport(ERROR,
                         (errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
@@ -4663,6 +4728,14 @@ NextCopyFrom(CopyState cstate, ExprContext *econtext,
                 continue;
             }
 
+#ifdef __OPENTENBASE__
+            if (cstate->parse_flags && !cstate->parse_flags[m])
+            {
+                /* not needed for routing, leave column as NULL */
+                continue;
+            }
+#endif
+
             if (cstate->csv_mode)
             {
                 if (string == NULL &&
@@ -4699,7 +4772,7 @@ NextCopyFrom(CopyState cstate, ExprContext *econtext,
             cstate->cur_attval = NULL;
         }
 
-        Assert(fieldno == nfields);
+        Assert(fieldno == nfields || cstate->parse_fields > 0);
     }
     else
     {
@@ -4954,6 +5027,104 @@ append_defvals(Datum *values, CopyState cstate)
 #endif
 
 
+#ifdef __OPENTENBASE__
+/*
+ * CopyFromSetupPartialParse
+ *
+ * A coordinator only needs the distribution columns of a text or csv line
+ * to route it, the line itself is forwarded unchanged and the datanodes
+ * convert every column again. With enable_copy_partial_parse, tokenize the
+ * line only up to the last routing column and convert only the routing
+ * columns. Errors in the other columns are then reported by the datanodes.
+ *
+ * Not used when the coordinator has to see whole rows: binary input, OIDs,
+ * INSERT converted to COPY, or enable_copy_silence, which skips bad lines
+ * on the coordinator.
+ */
+static void
+CopyFromSetupPartialParse(CopyState cstate)
+{
+    RemoteCopyData *rcstate = cstate->remoteCopyState;
+    AttrNumber      route_attrs[2];
+    ListCell       *cur;
+    int             fieldno;
+    int             i;
+
+    cstate->parse_fields = 0;
+    cstate->parse_flags = NULL;
+
+    if (!IS_PGXC_COORDINATOR || rcstate == NULL || rcstate->rel_loc == NULL)
+        return;
+
+    cstate->copy_stats = (log_min_messages <= DEBUG1 ||
+                          client_min_messages <= DEBUG1);
+    INSTR_TIME_SET_ZERO(cstate->read_time);
+    INSTR_TIME_SET_ZERO(cstate->parse_time);
+    INSTR_TIME_SET_ZERO(cstate->send_time);
+
+    if (!g_enable_copy_partial_parse || g_enable_copy_silence ||
+        cstate->binary || cstate->insert_into || cstate->file_has_oids ||
+        cstate->convert_select_flags)
+        return;
+
+    route_attrs[0] = rcstate->rel_loc->partAttrNum;
+#ifdef __COLD_HOT__
+    route_attrs[1] = rcstate->rel_loc->secAttrNum;
+#else
+    route_attrs[1] = InvalidAttrNumber;
+#endif
+
+    cstate->parse_flags = (bool *) palloc0(RelationGetNumberOfAttributes(cstate->rel) *
+                                           sizeof(bool));
+
+    /* at least one field, so that empty lines are still told apart */
+    cstate->parse_fields = 1;
+    fieldno = 0;
+    foreach(cur, cstate->attnumlist)
+    {
+        int attnum = lfirst_int(cur);
+
+        fieldno++;
+        for (i = 0; i < lengthof(route_attrs); i++)
+        {
+            if (AttributeNumberIsValid(route_attrs[i]) && attnum == route_attrs[i])
+            {
+                cstate->parse_flags[attnum - 1] = true;
+                cstate->parse_fields = Max(cstate->parse_fields, fieldno);
+            }
+        }
+    }
+}
+
+/*
+ * CopyFromReportStats
+ *
+ * Log the rate of each stage of a distributed COPY FROM, to tell whether a
+ * load is bound by the input, by parsing on the coordinator or by sending.
+ */
+static void
+CopyFromReportStats(CopyState cstate, uint64 processed)
+{
+    double read_ms;
+    double parse_ms;
+    double send_ms;
+
+    read_ms  = INSTR_TIME_GET_MILLISEC(cstate->read_time);
+    parse_ms = INSTR_TIME_GET_MILLISEC(cstate->parse_time) - read_ms;
+    send_ms  = INSTR_TIME_GET_MILLISEC(cstate->send_time);
+
+    elog(DEBUG1, "COPY FROM %s: " UINT64_FORMAT " rows, parsed %d of %d fields, "
+         "read %.3f ms (%.0f rows/s), parse %.3f ms (%.0f rows/s), "
+         "send %.3f ms (%.0f rows/s)",
+         RelationGetRelationName(cstate->rel), processed,
+         cstate->parse_fields > 0 ? cstate->parse_fields : list_length(cstate->attnumlist),
+         list_length(cstate->attnumlist),
+         read_ms, read_ms > 0 ? processed * 1000.0 / read_ms : 0,
+         parse_ms, parse_ms > 0 ? processed * 1000.0 / parse_ms : 0,
+         send_ms, send_ms > 0 ? processed * 1000.0 / send_ms : 0);
+}
+#endif
+
 /*
  * Clean up storage and release resources for COPY FROM.
  */
@@ -5751,6 +5922,11 @@ CopyReadAttributesText(CopyState cstate)
         /* Done if we hit EOL instead of a delim */
         if (!found_delim)
             break;
+#ifdef __OPENTENBASE__
+        /* Done if the remaining fields are not needed */
+        if (cstate->parse_fields > 0 && fieldno >= cstate->parse_fields)
+            break;
+#endif
     }
 
     /* Clean up state of attribute_buf */
@@ -5922,6 +6098,11 @@ endfield:
         /* Done if we hit EOL instead of a delim */
         if (!found_delim)
             break;
+#ifdef __OPENTENBASE__
+        /* Done if the remaining fields are not needed */
+        if (cstate->parse_fields > 0 && fieldno >= cstate->parse_fields)
+            break;
+#endif
     }
 
     /* Clean up state of attribute_buf */
@@ -2845,11 +2845,12 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage)
                                  usage->local_blks_written > 0);
         bool        has_temp = (usage->temp_blks_read > 0 ||
                                 usage->temp_blks_written > 0);
+        bool        has_shard = (usage->shard_blks_skipped > 0);
         bool        has_timing = (!INSTR_TIME_IS_ZERO(usage->blk_read_time) ||
                                   !INSTR_TIME_IS_ZERO(usage->blk_write_time));
 
         /* Show only positive counter values. */
-        if (has_shared || has_local || has_temp)
+        if (has_shared || has_local || has_temp || has_shard)
         {
             appendStringInfoSpaces(es->str, es->indent * 2);
             appendStringInfoString(es->str, "Buffers:");
@@ -2869,7 +2870,7 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage)
                 if (usage->shared_blks_written > 0)
                     appendStringInfo(es->str, " written=%ld",
                                      usage->shared_blks_written);
-                if (has_local || has_temp)
+                if (has_local || has_temp || has_shard)
                     appendStringInfoChar(es->str, ',');
             }
             if (has_local)
@@ -2887,7 +2888,7 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage)
                 if (usage->local_blks_written > 0)
                     appendStringInfo(es->str, " written=%ld",
                                      usage->local_blks_written);
-                if (has_temp)
+                if (has_temp || has_shard)
                     appendStringInfoChar(es->str, ',');
             }
             if (has_temp)
@@ -2899,7 +2900,12 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage)
                 if (usage->temp_blks_written > 0)
                     appendStringInfo(es->str, " written=%ld",
                                      usage->temp_blks_written);
+                if (has_shard)
+                    appendStringInfoChar(es->str, ',');
             }
+            if (has_shard)
+                appendStringInfo(es->str, " shard skipped=%ld",
+                                 usage->shard_blks_skipped);
             appendStringInfoChar(es->str, '\n');
         }
 
@@ -2929,6 +2935,7 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage)
         ExplainPropertyLong("Local Written Blocks", usage->local_blks_written, es);
         ExplainPropertyLong("Temp Read Blocks", usage->temp_blks_read, es);
         ExplainPropertyLong("Temp Written Blocks", usage->temp_blks_written, es);
+        ExplainPropertyLong("Shard Skipped Blocks", usage->shard_blks_skipped, es);
         if (track_io_timing)
         {
             ExplainPropertyFloat("I/O Read Time", INSTR_TIME_GET_MILLISEC(usage->blk_read_time), 3, es);
@@ -95,6 +95,7 @@ InstrOut(StringInfo buf, Plan *plan, Instrumentation *instr, int current_node_id
 	appendStringInfo(buf, "%ld,", instr->bufusage_start.local_blks_written);
 	appendStringInfo(buf, "%ld,", instr->bufusage_start.temp_blks_read);
 	appendStringInfo(buf, "%ld,", instr->bufusage_start.temp_blks_written);
+	appendStringInfo(buf, "%ld,", instr->bufusage_start.shard_blks_skipped);
 	appendStringInfo(buf, "%ld,", instr->bufusage_start.blk_read_time.tv_sec);
 	appendStringInfo(buf, "%ld,", instr->bufusage_start.blk_read_time.tv_nsec);
 	appendStringInfo(buf, "%ld,", instr->bufusage_start.blk_write_time.tv_sec);
@@ -117,6 +118,7 @@ InstrOut(StringInfo buf, Plan *plan, Instrumentation *instr, int current_node_id
 	appendStringInfo(buf, "%ld,", instr->bufusage.local_blks_written);
 	appendStringInfo(buf, "%ld,", instr->bufusage.temp_blks_read);
 	appendStringInfo(buf, "%ld,", instr->bufusage.temp_blks_written);
+	appendStringInfo(buf, "%ld,", instr->bufusage.shard_blks_skipped);
 	appendStringInfo(buf, "%ld,", instr->bufusage.blk_read_time.tv_sec);
 	appendStringInfo(buf, "%ld,", instr->bufusage.blk_read_time.tv_nsec);
 	appendStringInfo(buf, "%ld,", instr->bufusage.blk_write_time.tv_sec);
@@ -352,6 +354,7 @@ InstrIn(StringInfo str, RemoteInstr *rinstr)
 	INSTR_READ_FIELD(bufusage_start.local_blks_written);
 	INSTR_READ_FIELD(bufusage_start.temp_blks_read);
 	INSTR_READ_FIELD(bufusage_start.temp_blks_written);
+	INSTR_READ_FIELD(bufusage_start.shard_blks_skipped);
 	INSTR_READ_FIELD(bufusage_start.blk_read_time.tv_sec);
 	INSTR_READ_FIELD(bufusage_start.blk_read_time.tv_nsec);
 	INSTR_READ_FIELD(bufusage_start.blk_write_time.tv_sec);
@@ -374,6 +377,7 @@ InstrIn(StringInfo str, RemoteInstr *rinstr)
 	INSTR_READ_FIELD(bufusage.local_blks_written);
 	INSTR_READ_FIELD(bufusage.temp_blks_read);
 	INSTR_READ_FIELD(bufusage.temp_blks_written);
+	INSTR_READ_FIELD(bufusage.shard_blks_skipped);
 	INSTR_READ_FIELD(bufusage.blk_read_time.tv_sec);
 	INSTR_READ_FIELD(bufusage.blk_read_time.tv_nsec);
 	INSTR_READ_FIELD(bufusage.blk_write_time.tv_sec);
@@ -665,6 +669,7 @@ combineRemoteInstr(RemoteInstr *rtarget, RemoteInstr *rsrc)
 	INSTR_MAX_FIELD(bufusage_start.local_blks_written);
 	INSTR_MAX_FIELD(bufusage_start.temp_blks_read);
 	INSTR_MAX_FIELD(bufusage_start.temp_blks_written);
+	INSTR_MAX_FIELD(bufusage_start.shard_blks_skipped);
 	INSTR_MAX_FIELD(bufusage_start.blk_read_time.tv_sec);
 	INSTR_MAX_FIELD(bufusage_start.blk_read_time.tv_nsec);
 	INSTR_MAX_FIELD(bufusage_start.blk_write_time.tv_sec);
@@ -687,6 +692,7 @@ combineRemoteInstr(RemoteInstr *rtarget, RemoteInstr *rsrc)
 	INSTR_MAX_FIELD(bufusage.local_blks_written);
 	INSTR_MAX_FIELD(bufusage.temp_blks_read);
 	INSTR_MAX_FIELD(bufusage.temp_blks_written);
+	INSTR_MAX_FIELD(bufusage.shard_blks_skipped);
 	INSTR_MAX_FIELD(bufusage.blk_read_time.tv_sec);
 	INSTR_MAX_FIELD(bufusage.blk_read_time.tv_nsec);
 	INSTR_MAX_FIELD(bufusage.blk_write_time.tv_sec);
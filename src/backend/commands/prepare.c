@@ -1207,6 +1207,27 @@ InactivateDatanodeStatementOnNode(int nodeidx)
 	}
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * Mark all datanode statements as inactive on all nodes, after they have been
+ * deallocated there.
+ */
+void
+InactivateAllDatanodeStatements(void)
+{
+	HASH_SEQ_STATUS seq;
+	DatanodeStatement *entry;
+
+	/* nothing cached */
+	if (!datanode_queries)
+		return;
+
+	hash_seq_init(&seq, datanode_queries);
+	while ((entry = hash_seq_search(&seq)) != NULL)
+		entry->number_of_nodes = 0;
+}
+#endif
+
 #endif
 #ifdef __OPENTENBASE__
 /* prepare remoteDML statement on coordinator */
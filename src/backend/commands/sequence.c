@@ -43,6 +43,14 @@
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "parser/parse_type.h"
+#ifdef __OPENTENBASE__
+#include "port/atomics.h"
+#include "portability/instr_time.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/tuplestore.h"
+#endif
 #include "storage/lmgr.h"
 #include "storage/proc.h"
 #include "storage/smgr.h"
@@ -81,12 +89,84 @@
 
 int            SequenceRangeVal = 1;
 #endif
+#ifdef __OPENTENBASE__
+int            shared_sequence_cache_range = 0;
+#endif
 
 typedef struct sequence_magic
 {
     uint32        magic;
 } sequence_magic;
 
+#ifdef __OPENTENBASE__
+/*
+ * Node-wide cache of sequence values, see nextval_shared().
+ *
+ * Each sequence of the node gets an entry holding a range of values fetched
+ * from GTM.  The backends take values out of it with a fetch-add on cursor,
+ * whose high bits carry the generation of the range and low bits the index
+ * of the next value in it.  A new range is installed in the other slot of
+ * ranges[] and published by moving cursor to the next generation, so a
+ * backend that got an index of an old generation either still finds that
+ * range in its slot or notices the slot was reused and retries.
+ */
+#define SEQ_CACHE_ENTRIES        4096
+#define SEQ_CACHE_GEN_SHIFT        40
+#define SEQ_CACHE_IDX_MASK        ((UINT64CONST(1) << SEQ_CACHE_GEN_SHIFT) - 1)
+#define SEQ_CACHE_GEN_MASK        ((UINT64CONST(1) << (64 - SEQ_CACHE_GEN_SHIFT)) - 1)
+#define SEQ_CACHE_INVALID_GEN    PG_UINT64_MAX
+
+typedef struct SeqCacheKey
+{
+    Oid            dbid;
+    Oid            relid;
+} SeqCacheKey;
+
+typedef struct SeqCacheRange
+{
+    pg_atomic_uint64 gen;        /* generation the range belongs to */
+    int64        start;            /* first value of the range */
+    int64        count;            /* number of values in the range */
+    int64        increment;
+} SeqCacheRange;
+
+typedef struct SeqCacheEntry
+{
+    SeqCacheKey key;
+    pg_atomic_uint64 cursor;    /* generation and index of the next value */
+    SeqCacheRange ranges[2];    /* current range is ranges[generation & 1] */
+
+    slock_t        mutex;            /* protects the fields below */
+    uint64        epoch;            /* bumped when the cached values are reset */
+    bool        next_valid;        /* a range was fetched ahead */
+    int64        next_start;
+    int64        next_count;
+    int64        next_increment;
+
+    /* statistics */
+    pg_atomic_uint64 hits;
+    pg_atomic_uint64 misses;
+    uint64        refills;
+    uint64        refill_time;    /* in microseconds */
+    uint64        max_refill_time;
+} SeqCacheEntry;
+
+static HTAB *SeqCacheHash = NULL;
+
+/*
+ * Sequences dropped by the current transaction.  Their cache entries are
+ * removed when it commits: until then it keeps the sequences locked, so no
+ * other backend is using the entries, and if it aborts they stay valid.
+ */
+typedef struct SeqCacheDropItem
+{
+    Oid            relid;
+    SubTransactionId subid;        /* subtransaction that dropped it */
+} SeqCacheDropItem;
+
+static List *seq_cache_drops = NIL;
+#endif
+
 /*
  * We store a SeqTable item for every sequence we have touched in the current
  * session.  This is needed to hold onto nextval/currval state.  (We can't
@@ -108,6 +188,10 @@ typedef struct SeqTableData
     TimestampTz last_call_time; /* the time when the last call as made */
     int64        range_multiplier; /* multiply this value with 2 next time */
 #endif
+#ifdef __OPENTENBASE__
+    bool        shared_checked;    /* looked up in the node-wide cache? */
+    struct SeqCacheEntry *shared;    /* entry there, NULL if it is full */
+#endif
 } SeqTableData;
 
 typedef SeqTableData *SeqTable;
@@ -158,6 +242,9 @@ static void do_setval(Oid relid, int64 next, bool iscalled);
 static void process_owned_by(Relation seqrel, List *owned_by, bool for_identity);
 #ifdef __OPENTENBASE__
 extern bool  g_GTM_skip_catalog;
+
+static bool nextval_shared(SeqTable elm, Relation seqrel, int64 *result);
+static void SeqCacheReset(Oid relid);
 #endif
 
 #ifdef __OPENTENBASE__
@@ -539,6 +626,9 @@ ResetSequence(Oid seq_relid)
     /* Clear local cache so that we don't think we have cached numbers */
     /* Note that we do not change the currval() state */
     elm->cached = elm->last;
+#ifdef __OPENTENBASE__
+    SeqCacheReset(seq_relid);
+#endif
 
     relation_close(seq_rel, NoLock);
 }
@@ -704,6 +794,9 @@ AlterSequence(ParseState *pstate, AlterSeqStmt *stmt)
         /* Clear local cache so that we don't think we have cached numbers */
         /* Note that we do not change the currval() state */
         elm->cached = elm->last;
+#ifdef __OPENTENBASE__
+        SeqCacheReset(relid);
+#endif
 
         /* Now okay to update the on-disk tuple */
 #ifdef PGXC
@@ -785,6 +878,9 @@ AlterSequence(ParseState *pstate, AlterSeqStmt *stmt)
         /* Clear local cache so that we don't think we have cached numbers */
         /* Note that we do not change the currval() state */
         elm->cached = elm->last;
+#ifdef __OPENTENBASE__
+        SeqCacheReset(relid);
+#endif
 
         /* Now okay to update the on-disk tuple */
 
@@ -851,8 +947,541 @@ DeleteSequenceTuple(Oid relid)
 
     ReleaseSysCache(tuple);
     heap_close(rel, RowExclusiveLock);
+
+#ifdef __OPENTENBASE__
+    if (SeqCacheHash != NULL)
+    {
+        MemoryContext oldcxt = MemoryContextSwitchTo(TopTransactionContext);
+        SeqCacheDropItem *item = (SeqCacheDropItem *) palloc(sizeof(SeqCacheDropItem));
+
+        item->relid = relid;
+        item->subid = GetCurrentSubTransactionId();
+        seq_cache_drops = lappend(seq_cache_drops, item);
+        MemoryContextSwitchTo(oldcxt);
+    }
+#endif
+}
+
+#ifdef __OPENTENBASE__
+Size
+SeqCacheShmemSize(void)
+{
+    return hash_estimate_size(SEQ_CACHE_ENTRIES, sizeof(SeqCacheEntry));
+}
+
+void
+SeqCacheShmemInit(void)
+{
+    HASHCTL        info;
+
+    MemSet(&info, 0, sizeof(info));
+    info.keysize = sizeof(SeqCacheKey);
+    info.entrysize = sizeof(SeqCacheEntry);
+
+    SeqCacheHash = ShmemInitHash("Shared sequence cache",
+                                 SEQ_CACHE_ENTRIES, SEQ_CACHE_ENTRIES,
+                                 &info,
+                                 HASH_ELEM | HASH_BLOBS | HASH_FIXED_SIZE);
 }
 
+/*
+ * Find the cache entry of the sequence, creating it if needed.  Entries are
+ * only removed once their sequence is dropped, so the pointer is remembered
+ * in the SeqTable.  Returns NULL when the cache is full, then the sequence
+ * uses the per-session cache.
+ */
+static SeqCacheEntry *
+SeqCacheLookup(SeqTable elm)
+{
+    SeqCacheKey    key;
+    SeqCacheEntry *entry;
+    bool        found;
+
+    key.dbid = MyDatabaseId;
+    key.relid = elm->relid;
+
+    /* the entry may be gone with a dropped sequence whose OID was reused */
+    if (elm->shared_checked &&
+        (elm->shared == NULL ||
+         memcmp(&elm->shared->key, &key, sizeof(SeqCacheKey)) == 0))
+        return elm->shared;
+
+    LWLockAcquire(SeqCacheLock, LW_SHARED);
+    entry = (SeqCacheEntry *) hash_search(SeqCacheHash, &key, HASH_FIND, NULL);
+    LWLockRelease(SeqCacheLock);
+
+    if (entry == NULL)
+    {
+        LWLockAcquire(SeqCacheLock, LW_EXCLUSIVE);
+        entry = (SeqCacheEntry *) hash_search(SeqCacheHash, &key,
+                                              HASH_ENTER_NULL, &found);
+        if (entry != NULL && !found)
+        {
+            /* start with an empty range, the first nextval fills it */
+            pg_atomic_init_u64(&entry->cursor, 0);
+            pg_atomic_init_u64(&entry->ranges[0].gen, 0);
+            entry->ranges[0].start = 0;
+            entry->ranges[0].count = 0;
+            entry->ranges[0].increment = 1;
+            pg_atomic_init_u64(&entry->ranges[1].gen, SEQ_CACHE_INVALID_GEN);
+            SpinLockInit(&entry->mutex);
+            entry->epoch = 0;
+            entry->next_valid = false;
+            pg_atomic_init_u64(&entry->hits, 0);
+            pg_atomic_init_u64(&entry->misses, 0);
+            entry->refills = 0;
+            entry->refill_time = 0;
+            entry->max_refill_time = 0;
+        }
+        LWLockRelease(SeqCacheLock);
+    }
+
+    elm->shared_checked = true;
+    elm->shared = entry;
+    return entry;
+}
+
+/*
+ * Make [start, start + count * increment) the current range, in place of
+ * the one of generation gen.  taken values of it are already handed out.
+ * Caller holds the entry mutex.
+ */
+static void
+SeqCacheInstall(SeqCacheEntry *entry, uint64 gen, int64 start, int64 count,
+                int64 increment, int64 taken)
+{
+    /* the cursor only has room for the low bits of the generation */
+    uint64        next = (gen + 1) & SEQ_CACHE_GEN_MASK;
+    SeqCacheRange *range = &entry->ranges[next & 1];
+
+    pg_atomic_write_u64(&range->gen, SEQ_CACHE_INVALID_GEN);
+    pg_write_barrier();
+    range->start = start;
+    range->count = count;
+    range->increment = increment;
+    pg_write_barrier();
+    pg_atomic_write_u64(&range->gen, next);
+    pg_atomic_write_u64(&entry->cursor,
+                        (next << SEQ_CACHE_GEN_SHIFT) | (uint64) taken);
+}
+
+/*
+ * Fetch a range of at least size values from GTM.
+ */
+static int64
+SeqCacheFetch(SeqCacheEntry *entry, Relation seqrel, int64 size,
+              int64 increment, int64 *count)
+{
+    char       *seqname = GetGlobalSeqName(seqrel, NULL, NULL);
+    instr_time    start;
+    instr_time    duration;
+    uint64        elapsed;
+    int64        first;
+    int64        rangemax;
+
+    INSTR_TIME_SET_CURRENT(start);
+    first = (int64) GetNextValGTM(seqname, size, &rangemax);
+    INSTR_TIME_SET_CURRENT(duration);
+    INSTR_TIME_SUBTRACT(duration, start);
+    elapsed = INSTR_TIME_GET_MICROSEC(duration);
+    pfree(seqname);
+
+    SpinLockAcquire(&entry->mutex);
+    entry->refills++;
+    entry->refill_time += elapsed;
+    if (elapsed > entry->max_refill_time)
+        entry->max_refill_time = elapsed;
+    SpinLockRelease(&entry->mutex);
+
+    /* a cycling sequence may have wrapped around, then use the first value */
+    *count = (rangemax - first) / increment + 1;
+    if (*count < 1)
+        *count = 1;
+    return first;
+}
+
+/*
+ * Fetch the range following the current one, which ends at last, before
+ * the backends run out of values.  Near the end of a sequence that does not
+ * cycle nothing is fetched, the error GTM would raise belongs to the
+ * nextval() that really runs out of values.
+ */
+static void
+SeqCachePrefetch(SeqCacheEntry *entry, Relation seqrel, int64 last)
+{
+    HeapTuple    pgstuple;
+    Form_pg_sequence pgsform;
+    int64        increment;
+    int64        size;
+    int64        first;
+    int64        count;
+    uint64        epoch;
+    bool        busy;
+
+    pgstuple = SearchSysCache1(SEQRELID, ObjectIdGetDatum(RelationGetRelid(seqrel)));
+    if (!HeapTupleIsValid(pgstuple))
+        elog(ERROR, "cache lookup failed for sequence %u", RelationGetRelid(seqrel));
+    pgsform = (Form_pg_sequence) GETSTRUCT(pgstuple);
+    increment = pgsform->seqincrement;
+    size = Max(pgsform->seqcache, (int64) shared_sequence_cache_range);
+    if (!pgsform->seqcycle)
+    {
+        double        left;
+
+        if (increment > 0)
+            left = ((double) pgsform->seqmax - (double) last) / increment;
+        else
+            left = ((double) last - (double) pgsform->seqmin) / -increment;
+        if (left < 2.0 * size)
+            size = 0;
+    }
+    ReleaseSysCache(pgstuple);
+
+    if (size == 0)
+        return;
+
+    SpinLockAcquire(&entry->mutex);
+    epoch = entry->epoch;
+    busy = entry->next_valid;
+    SpinLockRelease(&entry->mutex);
+    if (busy)
+        return;
+
+    first = SeqCacheFetch(entry, seqrel, size, increment, &count);
+
+    SpinLockAcquire(&entry->mutex);
+    if (entry->epoch == epoch && !entry->next_valid)
+    {
+        entry->next_start = first;
+        entry->next_count = count;
+        entry->next_increment = increment;
+        entry->next_valid = true;
+    }
+    SpinLockRelease(&entry->mutex);
+}
+
+/*
+ * The range of generation gen ran out.  Install the range fetched ahead, if
+ * there is one.  Returns false if the caller has to go to GTM itself.
+ */
+static bool
+SeqCacheSwitch(SeqCacheEntry *entry, uint64 gen)
+{
+    bool        switched = true;
+
+    SpinLockAcquire(&entry->mutex);
+    if ((pg_atomic_read_u64(&entry->cursor) >> SEQ_CACHE_GEN_SHIFT) == gen)
+    {
+        if (entry->next_valid)
+        {
+            SeqCacheInstall(entry, gen, entry->next_start, entry->next_count,
+                            entry->next_increment, 0);
+            entry->next_valid = false;
+        }
+        else
+            switched = false;
+    }
+    SpinLockRelease(&entry->mutex);
+
+    return switched;
+}
+
+/*
+ * The range of generation gen ran out and nothing was fetched ahead: get a
+ * new range from GTM, keep its first value and share the rest.
+ */
+static int64
+SeqCacheMiss(SeqCacheEntry *entry, Relation seqrel, uint64 gen)
+{
+    HeapTuple    pgstuple;
+    Form_pg_sequence pgsform;
+    int64        increment;
+    int64        size;
+    int64        first;
+    int64        count;
+    uint64        epoch;
+
+    pgstuple = SearchSysCache1(SEQRELID, ObjectIdGetDatum(RelationGetRelid(seqrel)));
+    if (!HeapTupleIsValid(pgstuple))
+        elog(ERROR, "cache lookup failed for sequence %u", RelationGetRelid(seqrel));
+    pgsform = (Form_pg_sequence) GETSTRUCT(pgstuple);
+    increment = pgsform->seqincrement;
+    size = Max(pgsform->seqcache, (int64) shared_sequence_cache_range);
+    ReleaseSysCache(pgstuple);
+
+    pg_atomic_fetch_add_u64(&entry->misses, 1);
+
+    SpinLockAcquire(&entry->mutex);
+    epoch = entry->epoch;
+    SpinLockRelease(&entry->mutex);
+
+    first = SeqCacheFetch(entry, seqrel, size, increment, &count);
+
+    if (count > 1)
+    {
+        SpinLockAcquire(&entry->mutex);
+        if (entry->epoch == epoch)
+        {
+            if ((pg_atomic_read_u64(&entry->cursor) >> SEQ_CACHE_GEN_SHIFT) == gen)
+                SeqCacheInstall(entry, gen, first, count, increment, 1);
+            else if (!entry->next_valid)
+            {
+                /* another backend refilled first, keep ours for later */
+                entry->next_start = first + increment;
+                entry->next_count = count - 1;
+                entry->next_increment = increment;
+                entry->next_valid = true;
+            }
+        }
+        SpinLockRelease(&entry->mutex);
+    }
+
+    return first;
+}
+
+/*
+ * nextval() from the node-wide sequence cache.
+ *
+ * With pooled connections sessions are short lived, and the ranges each of
+ * them caches are mostly thrown away before they are used up, so nextval()
+ * keeps going to GTM.  When shared_sequence_cache_range is set, the
+ * backends of the node share a range of at least that many values instead.
+ * Taking a value is a single fetch-add.  The backend that takes the value
+ * three quarters into the range fetches the next range from GTM, so the
+ * others normally find it ready when the current one runs out.
+ *
+ * Returns false if the sequence can not be cached, then the caller goes on
+ * with the per-session cache.
+ */
+static bool
+nextval_shared(SeqTable elm, Relation seqrel, int64 *result)
+{
+    SeqCacheEntry *entry = SeqCacheLookup(elm);
+
+    if (entry == NULL)
+        return false;
+
+    for (;;)
+    {
+        uint64        cursor;
+        uint64        gen;
+        uint64        idx;
+        SeqCacheRange *range;
+        int64        start;
+        int64        count;
+        int64        increment;
+
+        CHECK_FOR_INTERRUPTS();
+
+        cursor = pg_atomic_fetch_add_u64(&entry->cursor, 1);
+        gen = cursor >> SEQ_CACHE_GEN_SHIFT;
+        idx = cursor & SEQ_CACHE_IDX_MASK;
+        range = &entry->ranges[gen & 1];
+
+        /* read the range, retrying if its slot was reused meanwhile */
+        if (pg_atomic_read_u64(&range->gen) != gen)
+            continue;
+        pg_read_barrier();
+        start = range->start;
+        count = range->count;
+        increment = range->increment;
+        pg_read_barrier();
+        if (pg_atomic_read_u64(&range->gen) != gen)
+            continue;
+
+        if (idx < (uint64) count)
+        {
+            pg_atomic_fetch_add_u64(&entry->hits, 1);
+            *result = start + (int64) idx * increment;
+            if (count > 1 && idx == (uint64) (count - count / 4 - 1))
+                SeqCachePrefetch(entry, seqrel,
+                                 start + (count - 1) * increment);
+            break;
+        }
+
+        if (SeqCacheSwitch(entry, gen))
+            continue;
+
+        *result = SeqCacheMiss(entry, seqrel, gen);
+        break;
+    }
+
+    elm->last = *result;
+    elm->cached = elm->last;
+    elm->last_valid = true;
+    return true;
+}
+
+/*
+ * Throw away the cached values of the sequence, after it was altered or
+ * reset on this node.
+ */
+static void
+SeqCacheReset(Oid relid)
+{
+    SeqCacheKey    key;
+    SeqCacheEntry *entry;
+
+    if (SeqCacheHash == NULL)
+        return;
+
+    key.dbid = MyDatabaseId;
+    key.relid = relid;
+
+    LWLockAcquire(SeqCacheLock, LW_SHARED);
+    entry = (SeqCacheEntry *) hash_search(SeqCacheHash, &key, HASH_FIND, NULL);
+    LWLockRelease(SeqCacheLock);
+
+    if (entry == NULL)
+        return;
+
+    SpinLockAcquire(&entry->mutex);
+    entry->epoch++;
+    entry->next_valid = false;
+    SeqCacheInstall(entry,
+                    pg_atomic_read_u64(&entry->cursor) >> SEQ_CACHE_GEN_SHIFT,
+                    0, 0, 1, 0);
+    SpinLockRelease(&entry->mutex);
+}
+
+/*
+ * Remove the cache entries of the sequences dropped by a committed
+ * transaction.  A prepared transaction passes isCommit = false: its entries
+ * stay until they are reused, as the sequences may still come back.
+ */
+void
+AtEOXact_SeqCache(bool isCommit)
+{
+    ListCell   *lc;
+
+    if (isCommit && seq_cache_drops != NIL)
+    {
+        LWLockAcquire(SeqCacheLock, LW_EXCLUSIVE);
+        foreach(lc, seq_cache_drops)
+        {
+            SeqCacheDropItem *item = (SeqCacheDropItem *) lfirst(lc);
+            SeqCacheKey    key;
+
+            key.dbid = MyDatabaseId;
+            key.relid = item->relid;
+            hash_search(SeqCacheHash, &key, HASH_REMOVE, NULL);
+        }
+        LWLockRelease(SeqCacheLock);
+    }
+
+    /* the list lives in TopTransactionContext */
+    seq_cache_drops = NIL;
+}
+
+/*
+ * At subcommit the drops become the parent's, at subabort they are
+ * forgotten.
+ */
+void
+AtEOSubXact_SeqCache(bool isCommit, SubTransactionId mySubid,
+                     SubTransactionId parentSubid)
+{
+    ListCell   *cur_item;
+    ListCell   *prev_item;
+
+    prev_item = NULL;
+    cur_item = list_head(seq_cache_drops);
+
+    while (cur_item != NULL)
+    {
+        SeqCacheDropItem *item = (SeqCacheDropItem *) lfirst(cur_item);
+
+        if (item->subid != mySubid)
+        {
+            prev_item = cur_item;
+            cur_item = lnext(prev_item);
+        }
+        else if (isCommit)
+        {
+            item->subid = parentSubid;
+            prev_item = cur_item;
+            cur_item = lnext(prev_item);
+        }
+        else
+        {
+            seq_cache_drops = list_delete_cell(seq_cache_drops, cur_item, prev_item);
+            pfree(item);
+            if (prev_item)
+                cur_item = lnext(prev_item);
+            else
+                cur_item = list_head(seq_cache_drops);
+        }
+    }
+}
+
+/*
+ * pg_stat_get_sequence_cache - usage of the node-wide sequence cache.
+ */
+Datum
+pg_stat_get_sequence_cache(PG_FUNCTION_ARGS)
+{
+#define SEQ_CACHE_STAT_COLUMNS 7
+    ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+    TupleDesc    tupdesc;
+    Tuplestorestate *tupstore;
+    MemoryContext oldcontext;
+    HASH_SEQ_STATUS hash_seq;
+    SeqCacheEntry *entry;
+
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("set-valued function called in context that cannot accept a set")));
+    if (!(rsinfo->allowedModes & SFRM_Materialize))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("materialize mode required, but it is not allowed in this context")));
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    oldcontext = MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+    tupstore = tuplestore_begin_heap(true, false, work_mem);
+    rsinfo->returnMode = SFRM_Materialize;
+    rsinfo->setResult = tupstore;
+    rsinfo->setDesc = tupdesc;
+    MemoryContextSwitchTo(oldcontext);
+
+    LWLockAcquire(SeqCacheLock, LW_SHARED);
+    hash_seq_init(&hash_seq, SeqCacheHash);
+    while ((entry = (SeqCacheEntry *) hash_seq_search(&hash_seq)) != NULL)
+    {
+        Datum        values[SEQ_CACHE_STAT_COLUMNS];
+        bool        nulls[SEQ_CACHE_STAT_COLUMNS];
+        uint64        refills;
+        uint64        refill_time;
+        uint64        max_refill_time;
+
+        SpinLockAcquire(&entry->mutex);
+        refills = entry->refills;
+        refill_time = entry->refill_time;
+        max_refill_time = entry->max_refill_time;
+        SpinLockRelease(&entry->mutex);
+
+        MemSet(nulls, 0, sizeof(nulls));
+        values[0] = ObjectIdGetDatum(entry->key.dbid);
+        values[1] = ObjectIdGetDatum(entry->key.relid);
+        values[2] = Int64GetDatum(pg_atomic_read_u64(&entry->hits));
+        values[3] = Int64GetDatum(pg_atomic_read_u64(&entry->misses));
+        values[4] = Int64GetDatum(refills);
+        values[5] = Int64GetDatum(refill_time);
+        values[6] = Int64GetDatum(max_refill_time);
+
+        tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+    }
+    LWLockRelease(SeqCacheLock);
+
+    tuplestore_donestoring(tupstore);
+
+    return (Datum) 0;
+}
+#endif
+
 /*
  * Note: nextval with a text argument is no longer exported as a pg_proc
  * entry, but we keep it around to ease porting of C code that may have
@@ -924,6 +1553,17 @@ nextval_internal(Oid relid, bool check_permissions)
      */
     PreventCommandIfParallelMode("nextval()");
 
+#ifdef __OPENTENBASE__
+    if (shared_sequence_cache_range > 0 &&
+        seqrel->rd_rel->relpersistence != RELPERSISTENCE_TEMP &&
+        nextval_shared(elm, seqrel, &result))
+    {
+        relation_close(seqrel, NoLock);
+        last_used_seq = elm;
+        return result;
+    }
+#endif
+
     if (elm->last != elm->cached)    /* some numbers were cached */
     {
         Assert(elm->last_valid);
@@ -1234,6 +1874,9 @@ do_setval(Oid relid, int64 next, bool iscalled)
     }
     /* In any case, forget any future cached numbers */
     elm->cached = elm->last;
+#ifdef __OPENTENBASE__
+    SeqCacheReset(relid);
+#endif
 
     /* check the comment above nextval_internal()'s equivalent call. */
     if (RelationNeedsWAL(seqrel))
@@ -1398,6 +2041,10 @@ init_sequence(Oid relid, SeqTable *p_elm, Relation *p_rel)
 #ifdef XCP
         elm->last_call_time = 0;
         elm->range_multiplier = DEFAULT_CACHEVAL;
+#endif
+#ifdef __OPENTENBASE__
+        elm->shared_checked = false;
+        elm->shared = NULL;
 #endif
         elm->last = elm->cached = 0;
     }
@@ -1422,6 +2069,9 @@ init_sequence(Oid relid, SeqTable *p_elm, Relation *p_rel)
     {
         elm->filenode = seqrel->rd_rel->relfilenode;
         elm->cached = elm->last;
+#ifdef __OPENTENBASE__
+        elm->shared_checked = false;
+#endif
     }
 
     /* Return results */
@@ -85,13 +85,16 @@
 #include "postgres.h"
 
 #include "access/htup_details.h"
+#include "access/transam.h"
 #include "access/tuptoaster.h"
 #include "funcapi.h"
 #include "catalog/pg_type.h"
+#include "mb/pg_wchar.h"
 #include "nodes/nodeFuncs.h"
 #include "storage/bufmgr.h"
 #include "utils/builtins.h"
 #include "utils/lsyscache.h"
+#include "utils/syscache.h"
 #include "utils/typcache.h"
 #ifdef XCP
 #include "pgxc/pgxc.h"
@@ -100,6 +103,20 @@
 #ifdef __OPENTENBASE__
 #include "access/printtup.h"
 #endif
+
+#ifdef PGXC
+/*
+ * Output functions of the columns of a slot, looked up the first time a row
+ * of the slot is copied into a DataRow and kept until its descriptor changes.
+ */
+typedef struct DataRowOutMetadata
+{
+    bool        binary;            /* rows are encoded in binary format */
+    FmgrInfo   *outfuncs;        /* send or output function of each column */
+    bool       *isvarlena;
+} DataRowOutMetadata;
+#endif
+
 static TupleDesc ExecTypeFromTLInternal(List *targetList,
                        bool hasoid, bool skipjunk);
 
@@ -130,6 +147,8 @@ MakeTupleTableSlot(void)
     slot->tts_datarow = NULL;
     slot->tts_drowcxt = NULL;
     slot->tts_attinmeta = NULL;
+    slot->tts_attrecvmeta = NULL;
+    slot->tts_attoutmeta = NULL;
 #endif
     slot->tts_mcxt = CurrentMemoryContext;
     slot->tts_buffer = InvalidBuffer;
@@ -281,6 +300,14 @@ ExecSetSlotDescriptor(TupleTableSlot *slot, /* slot to change */
     /* XXX there in no routine to release AttInMetadata instance */
     if (slot->tts_attinmeta)
         slot->tts_attinmeta = NULL;
+    slot->tts_attrecvmeta = NULL;
+    if (slot->tts_attoutmeta)
+    {
+        pfree(slot->tts_attoutmeta->outfuncs);
+        pfree(slot->tts_attoutmeta->isvarlena);
+        pfree(slot->tts_attoutmeta);
+        slot->tts_attoutmeta = NULL;
+    }
 #endif
 
     if (slot->tts_values)
@@ -714,6 +741,45 @@ ExecCopySlotMinimalTuple(TupleTableSlot *slot)
 }
 
 #ifdef PGXC
+/* GUC parameter: send DataRows of redistributed tuples in binary format */
+bool enable_binary_datarow = false;
+
+static DataRowOutMetadata *
+datarow_out_metadata(TupleTableSlot *slot)
+{
+    TupleDesc    tdesc = slot->tts_tupleDescriptor;
+    int            natts = tdesc->natts;
+    DataRowOutMetadata *meta;
+    int            i;
+
+    meta = (DataRowOutMetadata *) MemoryContextAlloc(slot->tts_mcxt,
+                                                     sizeof(DataRowOutMetadata));
+    meta->binary = DataRowBinaryCapable(tdesc);
+    meta->outfuncs = (FmgrInfo *) MemoryContextAllocZero(slot->tts_mcxt,
+                                                         Max(natts, 1) * sizeof(FmgrInfo));
+    meta->isvarlena = (bool *) MemoryContextAllocZero(slot->tts_mcxt,
+                                                      Max(natts, 1) * sizeof(bool));
+
+    for (i = 0; i < natts; i++)
+    {
+        Form_pg_attribute attr = tdesc->attrs[i];
+        Oid            typOutput;
+
+        if (attr->attisdropped)
+            continue;
+
+        if (!meta->binary)
+            getTypeOutputInfo(attr->atttypid, &typOutput, &meta->isvarlena[i]);
+        else if (!DATAROW_RAW_BYVAL(attr))
+            getTypeBinaryOutputInfo(attr->atttypid, &typOutput, &meta->isvarlena[i]);
+        else
+            continue;
+        fmgr_info_cxt(typOutput, &meta->outfuncs[i], slot->tts_mcxt);
+    }
+
+    return meta;
+}
+
 /* --------------------------------
  *        ExecCopySlotDatarow
  *            Obtain a copy of a slot's data row.  The copy is
@@ -742,10 +808,17 @@ ExecCopySlotDatarow(TupleTableSlot *slot, MemoryContext tmpcxt)
         StringInfoData    buf;
         uint16             n16;
         int             i;
+        DataRowOutMetadata *meta;
+        bool            binary;
 
         /* ensure we have all values */
         slot_getallattrs(slot);
 
+        if (slot->tts_attoutmeta == NULL)
+            slot->tts_attoutmeta = datarow_out_metadata(slot);
+        meta = slot->tts_attoutmeta;
+        binary = meta->binary;
+
         /* if temporary memory context is specified reset it */
         if (tmpcxt)
         {
@@ -755,7 +828,7 @@ ExecCopySlotDatarow(TupleTableSlot *slot, MemoryContext tmpcxt)
 
         initStringInfo(&buf);
         /* Number of parameter values */
-        n16 = htons(tdesc->natts);
+        n16 = htons(tdesc->natts | (binary ? DATAROW_BINARY_FLAG : 0));
         appendBinaryStringInfo(&buf, (char *) &n16, 2);
 
         for (i = 0; i < tdesc->natts; i++)
@@ -767,22 +840,23 @@ ExecCopySlotDatarow(TupleTableSlot *slot, MemoryContext tmpcxt)
                 n32 = htonl(-1);
                 appendBinaryStringInfo(&buf, (char *) &n32, 4);
             }
+            else if (binary)
+            {
+                DataRowAppendBinaryValue(&buf, tdesc->attrs[i], &meta->outfuncs[i],
+                                         slot->tts_values[i]);
+            }
             else
             {
                 Form_pg_attribute attr = tdesc->attrs[i];
-                Oid        typOutput;
-                bool    typIsVarlena;
                 Datum    pval;
                 char   *pstring;
                 int        len;
 
-                /* Get info needed to output the value */
-                getTypeOutputInfo(attr->atttypid, &typOutput, &typIsVarlena);
                 /*
                  * If we have a toasted datum, forcibly detoast it here to avoid
                  * memory leakage inside the type's output routine.
                  */
-                if (typIsVarlena)
+                if (meta->isvarlena[i])
                     pval = PointerGetDatum(PG_DETOAST_DATUM(slot->tts_values[i]));
                 else
                     pval = slot->tts_values[i];
@@ -828,7 +902,7 @@ ExecCopySlotDatarow(TupleTableSlot *slot, MemoryContext tmpcxt)
                 }
 #endif
                 /* Convert Datum to string */
-                pstring = OidOutputFunctionCall(typOutput, pval);
+                pstring = OutputFunctionCall(&meta->outfuncs[i], pval);
 
                 /* copy data to the buffer */
                 len = strlen(pstring);
@@ -853,6 +927,120 @@ ExecCopySlotDatarow(TupleTableSlot *slot, MemoryContext tmpcxt)
         return datarow;
     }
 }
+
+/*
+ * Can rows of tdesc be sent in binary format?
+ *
+ * Type OIDs are only the same on all nodes for built-in types, and the send
+ * functions of composite types and arrays embed them, so values go through
+ * send and receive functions only for built-in base types. Fixed-width pass
+ * by value columns are sent raw, whatever their type.
+ *
+ * The send and receive functions of text-like types convert between the
+ * server and the client encoding, which the text format never does, so
+ * binary is only used while the two are the same.
+ */
+bool
+DataRowBinaryCapable(TupleDesc tdesc)
+{
+    int i;
+
+    if (!enable_binary_datarow)
+        return false;
+
+    if (pg_get_client_encoding() != GetDatabaseEncoding())
+        return false;
+
+    for (i = 0; i < tdesc->natts; i++)
+    {
+        Form_pg_attribute attr = tdesc->attrs[i];
+        HeapTuple    typtup;
+        Form_pg_type typform;
+        bool        capable;
+
+        if (attr->attisdropped)
+            return false;
+
+        if (DATAROW_RAW_BYVAL(attr))
+            continue;
+
+        if (attr->atttypid >= FirstNormalObjectId)
+            return false;
+
+        typtup = SearchSysCache1(TYPEOID, ObjectIdGetDatum(attr->atttypid));
+        if (!HeapTupleIsValid(typtup))
+            elog(ERROR, "cache lookup failed for type %u", attr->atttypid);
+        typform = (Form_pg_type) GETSTRUCT(typtup);
+        capable = typform->typtype == TYPTYPE_BASE &&
+                  OidIsValid(typform->typsend) &&
+                  OidIsValid(typform->typreceive);
+        ReleaseSysCache(typtup);
+
+        if (!capable)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Append a non-null value to a DataRow in binary format, see
+ * DATAROW_BINARY_FLAG. sendfunc is not used for raw columns.
+ */
+void
+DataRowAppendBinaryValue(StringInfo buf, Form_pg_attribute attr,
+                         FmgrInfo *sendfunc, Datum value)
+{
+    uint32    n32;
+
+    if (DATAROW_RAW_BYVAL(attr))
+    {
+        n32 = htonl(attr->attlen);
+        appendBinaryStringInfo(buf, (char *) &n32, 4);
+
+        switch (attr->attlen)
+        {
+            case 1:
+                appendStringInfoCharMacro(buf, DatumGetChar(value));
+                break;
+            case 2:
+                {
+                    uint16 n16 = htons((uint16) DatumGetInt16(value));
+
+                    appendBinaryStringInfo(buf, (char *) &n16, 2);
+                }
+                break;
+            case 4:
+                n32 = htonl((uint32) DatumGetInt32(value));
+                appendBinaryStringInfo(buf, (char *) &n32, 4);
+                break;
+#if SIZEOF_DATUM == 8
+            case 8:
+                {
+                    uint64 n64 = (uint64) DatumGetInt64(value);
+
+                    n32 = htonl((uint32) (n64 >> 32));
+                    appendBinaryStringInfo(buf, (char *) &n32, 4);
+                    n32 = htonl((uint32) n64);
+                    appendBinaryStringInfo(buf, (char *) &n32, 4);
+                }
+                break;
+#endif
+            default:
+                elog(ERROR, "unsupported byval length: %d", (int) attr->attlen);
+        }
+    }
+    else
+    {
+        bytea  *outputbytes = SendFunctionCall(sendfunc, value);
+        int        len = VARSIZE(outputbytes) - VARHDRSZ;
+
+        n32 = htonl(len);
+        appendBinaryStringInfo(buf, (char *) &n32, 4);
+        appendBinaryStringInfo(buf, VARDATA(outputbytes), len);
+        pfree(outputbytes);
+    }
+}
 #endif
 
 /* --------------------------------
@@ -201,6 +201,7 @@ BufferUsageAdd(BufferUsage *dst, const BufferUsage *add)
     dst->local_blks_written += add->local_blks_written;
     dst->temp_blks_read += add->temp_blks_read;
     dst->temp_blks_written += add->temp_blks_written;
+    dst->shard_blks_skipped += add->shard_blks_skipped;
     INSTR_TIME_ADD(dst->blk_read_time, add->blk_read_time);
     INSTR_TIME_ADD(dst->blk_write_time, add->blk_write_time);
 }
@@ -221,6 +222,7 @@ BufferUsageAccumDiff(BufferUsage *dst,
     dst->local_blks_written += add->local_blks_written - sub->local_blks_written;
     dst->temp_blks_read += add->temp_blks_read - sub->temp_blks_read;
     dst->temp_blks_written += add->temp_blks_written - sub->temp_blks_written;
+    dst->shard_blks_skipped += add->shard_blks_skipped - sub->shard_blks_skipped;
     INSTR_TIME_ACCUM_DIFF(dst->blk_read_time,
                           add->blk_read_time, sub->blk_read_time);
     INSTR_TIME_ACCUM_DIFF(dst->blk_write_time,
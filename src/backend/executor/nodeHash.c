@@ -33,6 +33,7 @@
 #include "executor/hashjoin.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "lib/bloomfilter.h"
 #include "miscadmin.h"
 #include "utils/dynahash.h"
 #include "utils/memutils.h"
@@ -137,6 +138,10 @@ MultiExecHash(HashState *node)
                 ExecHashTableInsert(hashtable, slot, hashvalue);
             }
             hashtable->totalTuples += 1;
+#ifdef __OPENTENBASE__
+            if (hashtable->bloom)
+                bloom_add_hash(hashtable->bloom, hashvalue);
+#endif
         }
     }
 
@@ -352,6 +357,9 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
     hashtable->spaceAllowedSkew =
         hashtable->spaceAllowed * SKEW_WORK_MEM_PERCENT / 100;
     hashtable->chunks = NULL;
+#ifdef __OPENTENBASE__
+    hashtable->bloom = NULL;
+#endif
 
 #ifdef HJDEBUG
     printf("Hashjoin %p: initial nbatch = %d, nbuckets = %d\n",
@@ -2420,6 +2428,9 @@ ExecShmHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
     hashtable->spaceAllowedSkew =
         hashtable->spaceAllowed * SKEW_WORK_MEM_PERCENT / 100;
     hashtable->chunks = NULL;
+#ifdef __OPENTENBASE__
+    hashtable->bloom = NULL;
+#endif
 
 #ifdef HJDEBUG
     printf("Hashjoin %p: initial nbatch = %d, nbuckets = %d\n",
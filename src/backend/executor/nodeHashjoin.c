@@ -27,6 +27,10 @@
 #ifdef __OPENTENBASE__
 #include "access/xact.h"
 #include "executor/execParallel.h"
+#include "lib/bloomfilter.h"
+#include "pgxc/execRemote.h"
+#include "pgxc/pgxc.h"
+#include "utils/typcache.h"
 #endif
 
 /*
@@ -46,6 +50,7 @@
 
 #ifdef __OPENTENBASE__
 volatile ParallelHashJoinStatus *statusParallelWorker = NULL;
+bool        enable_runtime_bloom_filter = false;
 #endif
 static TupleTableSlot *ExecHashJoinOuterGetTuple(PlanState *outerNode,
                           HashJoinState *hjstate,
@@ -62,6 +67,10 @@ static HashJoinTable ExecMergeShmHashTable(HashJoinState * hjstate, volatile Par
                                 Hash *node, List *hashOperators, bool keepNulls);
 static void ExecFormNewOuterBufFile(HashJoinState * hjstate, volatile ParallelHashJoinState *parallelState, 
                                  Hash *node);
+static void ExecHashJoinInitRuntimeFilter(HashJoinState *hjstate,
+                                 HashJoinTable hashtable);
+static void ExecHashJoinPushRuntimeFilter(HashJoinState *hjstate,
+                                 HashJoinTable hashtable);
 
 #endif
 /* ----------------------------------------------------------------
@@ -322,6 +331,9 @@ ExecHashJoin(PlanState *pstate)
                                                 node->hj_HashOperators,
                                                 HJ_FILL_INNER(node));
                 node->hj_HashTable = hashtable;
+#ifdef __OPENTENBASE__
+                ExecHashJoinInitRuntimeFilter(node, hashtable);
+#endif
 
                 /*
                  * execute the Hash node, to build the hash table
@@ -345,6 +357,11 @@ ExecHashJoin(PlanState *pstate)
                     return NULL;
                 }
 
+#ifdef __OPENTENBASE__
+                if (hashtable->bloom)
+                    ExecHashJoinPushRuntimeFilter(node, hashtable);
+#endif
+
                 /*
                  * need to remember whether nbatch has increased since we
                  * began scanning the outer relation
@@ -1954,3 +1971,109 @@ ParallelHashJoinEreport(void)
     }
 }
 #endif
+
+#ifdef __OPENTENBASE__
+/*
+ * If the outer side of the join is redistributed to us, collect the hash
+ * values of the inner tuples in a Bloom filter while the hash table is built,
+ * so the producers of the outer side can skip the rows that can not match.
+ *
+ * That is only valid if no unmatched outer row is emitted, every join key is
+ * a plain outer column hashed by the default hash function of its type, and
+ * the hash table holds the same rows each time the outer side is scanned.
+ */
+static void
+ExecHashJoinInitRuntimeFilter(HashJoinState *hjstate, HashJoinTable hashtable)
+{
+    PlanState  *outerNode = outerPlanState(hjstate);
+    PlanState  *hashNode = innerPlanState(hjstate);
+    RemoteSubplan *rplan;
+    TupleDesc    outerdesc;
+    MemoryContext oldcxt;
+    ListCell   *lc;
+    int            i = 0;
+
+    if (!enable_runtime_bloom_filter || !IS_PGXC_DATANODE ||
+        IsParallelWorker() || IsInParallelMode())
+        return;
+
+    if (hjstate->js.jointype != JOIN_INNER &&
+        hjstate->js.jointype != JOIN_SEMI &&
+        hjstate->js.jointype != JOIN_RIGHT)
+        return;
+
+    if (!bms_is_empty(hjstate->js.ps.plan->allParam))
+        return;
+
+    if (!IsA(outerNode, RemoteSubplanState))
+        return;
+    rplan = (RemoteSubplan *) outerNode->plan;
+    if (rplan->cursor == NULL || rplan->distributionNodes == NIL ||
+        rplan->parallelWorkerSendTuple)
+        return;
+
+    if (list_length(hjstate->hj_OuterHashKeys) > SQUEUE_RUNTIME_FILTER_MAX_KEYS)
+        return;
+
+    outerdesc = outerNode->ps_ResultTupleSlot->tts_tupleDescriptor;
+    foreach(lc, hjstate->hj_OuterHashKeys)
+    {
+        Expr       *expr = ((ExprState *) lfirst(lc))->expr;
+        Var           *var = (Var *) expr;
+        TypeCacheEntry *typentry;
+
+        if (!IsA(expr, Var) || var->varno != OUTER_VAR ||
+            var->varattno < 1 || var->varattno > outerdesc->natts ||
+            TupleDescAttr(outerdesc, var->varattno - 1)->atttypid != var->vartype)
+            return;
+
+        if (!hashtable->hashStrict[i])
+            return;
+
+        typentry = lookup_type_cache(var->vartype, TYPECACHE_HASH_PROC);
+        if (hashtable->outer_hashfunctions[i].fn_oid != typentry->hash_proc)
+            return;
+        i++;
+    }
+
+    oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+    hashtable->bloom = bloom_create(hashNode->plan->plan_rows,
+                                    SQUEUE_RUNTIME_FILTER_MAX_BYTES,
+                                    (uint32) random());
+    MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * Send the Bloom filter of the built hash table to the producers of the
+ * outer side, unless it is too full to reject much.
+ */
+static void
+ExecHashJoinPushRuntimeFilter(HashJoinState *hjstate, HashJoinTable hashtable)
+{
+    AttrNumber    attnos[SQUEUE_RUNTIME_FILTER_MAX_KEYS];
+    Oid            keytypes[SQUEUE_RUNTIME_FILTER_MAX_KEYS];
+    ListCell   *lc;
+    int            nkeys = 0;
+
+    if (bloom_prop_bits_set(hashtable->bloom) <= 0.5)
+    {
+        foreach(lc, hjstate->hj_OuterHashKeys)
+        {
+            Var           *var = (Var *) ((ExprState *) lfirst(lc))->expr;
+
+            attnos[nkeys] = var->varattno;
+            keytypes[nkeys] = var->vartype;
+            nkeys++;
+        }
+
+        ExecRemoteSubplanPushFilter((RemoteSubplanState *) outerPlanState(hjstate),
+                                    nkeys, attnos, keytypes, hashtable->bloom);
+    }
+    else
+        elog(DEBUG1, "runtime filter of %.0f inner tuples is too full to push",
+             hashtable->totalTuples);
+
+    bloom_free(hashtable->bloom);
+    hashtable->bloom = NULL;
+}
+#endif
@@ -124,6 +124,10 @@ IndexNext(IndexScanState *node)
                                    estate->es_snapshot,
                                    node->iss_NumScanKeys,
                                    node->iss_NumOrderByKeys);
+#ifdef __OPENTENBASE__
+        index_setscanshards(scandesc,
+                            ((Scan *) node->ss.ps.plan)->scan_shards);
+#endif
 
         node->iss_ScanDesc = scandesc;
 
@@ -236,6 +240,10 @@ IndexNextWithReorder(IndexScanState *node)
                                    estate->es_snapshot,
                                    node->iss_NumScanKeys,
                                    node->iss_NumOrderByKeys);
+#ifdef __OPENTENBASE__
+        index_setscanshards(scandesc,
+                            ((Scan *) node->ss.ps.plan)->scan_shards);
+#endif
 
         node->iss_ScanDesc = scandesc;
 
@@ -1740,6 +1748,10 @@ ExecIndexScanInitializeDSM(IndexScanState *node,
                                  node->iss_NumScanKeys,
                                  node->iss_NumOrderByKeys,
                                  piscan);
+#ifdef __OPENTENBASE__
+    index_setscanshards(node->iss_ScanDesc,
+                        ((Scan *) node->ss.ps.plan)->scan_shards);
+#endif
 
     /*
      * If no run-time keys to calculate or they are ready, go ahead and pass
@@ -1783,6 +1795,10 @@ ExecIndexScanInitializeWorker(IndexScanState *node,
                                  node->iss_NumScanKeys,
                                  node->iss_NumOrderByKeys,
                                  piscan);
+#ifdef __OPENTENBASE__
+    index_setscanshards(node->iss_ScanDesc,
+                        ((Scan *) node->ss.ps.plan)->scan_shards);
+#endif
 
     /*
      * If no run-time keys to calculate or they are ready, go ahead and pass
@@ -2750,6 +2750,12 @@ END:
     /* Restore es_result_relation_info before exiting */
     estate->es_result_relation_info = saved_resultRelInfo;
 
+#ifdef __OPENTENBASE__
+    /* collect the results of the rows still in flight to the datanodes */
+    if (IS_PGXC_COORDINATOR && ((ModifyTable *) node->ps.plan)->remote_plans)
+        ExecRemoteDMLFlush(node);
+#endif
+
     /*
      * We're done, but fire AFTER STATEMENT triggers before exiting.
      */
@@ -82,6 +82,10 @@ SeqNext(SeqScanState *node)
 		scandesc = heap_beginscan(node->ss.ss_currentRelation,
 								  estate->es_snapshot,
 								  0, NULL);
+#ifdef __OPENTENBASE__
+		heap_setscanshards(scandesc,
+						   ((Scan *) node->ss.ps.plan)->scan_shards);
+#endif
 		if(enable_distri_print)
 		{
 			elog(LOG, "seq scan snapshot local %d start ts "INT64_FORMAT " rel %s", estate->es_snapshot->local,
@@ -404,6 +408,10 @@ ExecSeqScanInitializeDSM(SeqScanState *node,
 	shm_toc_insert(pcxt->toc, node->ss.ps.plan->plan_node_id, pscan);
 	node->ss.ss_currentScanDesc =
 		heap_beginscan_parallel(node->ss.ss_currentRelation, pscan);
+#ifdef __OPENTENBASE__
+	heap_setscanshards(node->ss.ss_currentScanDesc,
+					   ((Scan *) node->ss.ps.plan)->scan_shards);
+#endif
 }
 
 /* ----------------------------------------------------------------
@@ -436,4 +444,8 @@ ExecSeqScanInitializeWorker(SeqScanState *node,
 	pscan = shm_toc_lookup(pwcxt->toc, node->ss.ps.plan->plan_node_id, false);
 	node->ss.ss_currentScanDesc =
 		heap_beginscan_parallel(node->ss.ss_currentRelation, pscan);
+#ifdef __OPENTENBASE__
+	heap_setscanshards(node->ss.ss_currentScanDesc,
+					   ((Scan *) node->ss.ps.plan)->scan_shards);
+#endif
 }
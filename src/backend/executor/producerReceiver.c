@@ -51,6 +51,8 @@ typedef struct
 #ifdef __OPENTENBASE__
     uint64      send_tuples;        /* number of tuples sent to remote */
     TimestampTz send_total_time;    /* total time to send tuples */
+    RuntimeFilterCache filters;     /* runtime filters of the consumers */
+    long        filteredcount;      /* tuples dropped by runtime filters */
 #endif
 } ProducerState;
 
@@ -144,7 +146,25 @@ producerReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
         {
             continue;
         }
-        else if (consumerIdx == SQ_CONS_SELF)
+#ifdef __OPENTENBASE__
+        if (myState->filters)
+        {
+            MemoryContext savecontext = CurrentMemoryContext;
+            bool        pass;
+
+            if (myState->tmpcxt)
+                MemoryContextSwitchTo(myState->tmpcxt);
+            pass = SharedQueueRuntimeFilterPass(myState->filters, consumerIdx,
+                                                slot);
+            MemoryContextSwitchTo(savecontext);
+            if (!pass)
+            {
+                myState->filteredcount++;
+                continue;
+            }
+        }
+#endif
+        if (consumerIdx == SQ_CONS_SELF)
         {
             Assert(myState->consumer);
             (*myState->consumer->receiveSlot) (slot, myState->consumer);
@@ -227,8 +247,15 @@ producerDestroyReceiver(DestReceiver *self)
 {// #lizard forgives
     ProducerState *myState = (ProducerState *) self;
 
+#ifdef __OPENTENBASE__
+    elog(DEBUG2, "Producer stats: total %ld tuples, %ld tuples to self, %ld to other nodes, "
+         "%ld dropped by runtime filters",
+         myState->tcount, myState->selfcount, myState->othercount,
+         myState->filteredcount);
+#else
     elog(DEBUG2, "Producer stats: total %ld tuples, %ld tuples to self, %ld to other nodes",
          myState->tcount, myState->selfcount, myState->othercount);
+#endif
 
     if (myState->consumer)
     {
@@ -304,6 +331,8 @@ CreateProducerDestReceiver(void)
     self->send_tuples     = 0;
     self->send_total_time = 0;
     self->nodeMap = NULL;
+    self->filters = NULL;
+    self->filteredcount = 0;
 #endif
 
     return (DestReceiver *) self;
@@ -345,6 +374,9 @@ SetProducerDestReceiverParams(DestReceiver *self,
         myState->tstores = (Tuplestorestate **)
             palloc0(NumDataNodes * sizeof(Tuplestorestate *));
 #endif
+#ifdef __OPENTENBASE__
+    myState->filters = squeue ? SharedQueueRuntimeFilterCacheCreate(squeue) : NULL;
+#endif
 }
 
 
@@ -0,0 +1,192 @@
+/*-------------------------------------------------------------------------
+ *
+ * bloomfilter.c
+ *	  Space-efficient set membership testing on 32-bit hash values
+ *
+ * A Bloom filter answers "is this element in the set?" with no false
+ * negatives and a tunable rate of false positives.  Elements are the 32-bit
+ * hash values callers already compute (for example a hash join's hash value
+ * of a tuple), and the k probe positions are derived from them by double
+ * hashing (Kirsch and Mitzenmacher, "Less Hashing, Same Performance").
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  src/backend/lib/bloomfilter.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/hash.h"
+#include "lib/bloomfilter.h"
+
+#define MAX_HASH_FUNCS		10
+#define BITS_PER_ELEMENT	10
+
+static int	optimal_k(uint32 nbits, double total_elems);
+static void probe_positions(bloom_filter *filter, uint32 hash,
+				uint32 *positions);
+
+/*
+ * Create a Bloom filter sized for total_elems elements.
+ *
+ * The bitset gets about BITS_PER_ELEMENT bits per element, which gives a
+ * false positive rate near 1%, but never more than max_bytes.  Its size is
+ * rounded down to a power of two, so callers should leave some headroom in
+ * total_elems when it is only an estimate.
+ */
+bloom_filter *
+bloom_create(double total_elems, Size max_bytes, uint32 seed)
+{
+	bloom_filter *filter;
+	double		want_bytes;
+	Size		bitset_bytes;
+
+	total_elems = Max(total_elems, 1.0);
+	want_bytes = total_elems * BITS_PER_ELEMENT / BITS_PER_BYTE;
+	want_bytes = Min(want_bytes, (double) max_bytes);
+	want_bytes = Min(want_bytes, (double) (PG_UINT32_MAX / BITS_PER_BYTE));
+
+	bitset_bytes = BLOOM_FILTER_MIN_BYTES;
+	while (bitset_bytes * 2 <= want_bytes)
+		bitset_bytes *= 2;
+
+	filter = palloc0(offsetof(bloom_filter, bitset) + bitset_bytes);
+	filter->nbits = (uint32) (bitset_bytes * BITS_PER_BYTE);
+	filter->k_hash_funcs = optimal_k(filter->nbits, total_elems);
+	filter->seed = seed;
+
+	return filter;
+}
+
+/*
+ * Free the filter
+ */
+void
+bloom_free(bloom_filter *filter)
+{
+	pfree(filter);
+}
+
+/*
+ * Number of bytes that make up the filter, header included
+ */
+Size
+bloom_total_size(bloom_filter *filter)
+{
+	return offsetof(bloom_filter, bitset) + filter->nbits / BITS_PER_BYTE;
+}
+
+/*
+ * Does a filter copied from elsewhere look sane and fit in size bytes?
+ */
+bool
+bloom_check_size(bloom_filter *filter, Size size)
+{
+	if (size < offsetof(bloom_filter, bitset))
+		return false;
+	if (filter->k_hash_funcs < 1 || filter->k_hash_funcs > MAX_HASH_FUNCS)
+		return false;
+	if (filter->nbits < BLOOM_FILTER_MIN_BYTES * BITS_PER_BYTE ||
+		(filter->nbits & (filter->nbits - 1)) != 0)
+		return false;
+	return bloom_total_size(filter) <= size;
+}
+
+/*
+ * Add an element to the filter
+ */
+void
+bloom_add_hash(bloom_filter *filter, uint32 hash)
+{
+	uint32		positions[MAX_HASH_FUNCS];
+	int			i;
+
+	probe_positions(filter, hash, positions);
+	for (i = 0; i < filter->k_hash_funcs; i++)
+		filter->bitset[positions[i] >> 3] |= 1 << (positions[i] & 7);
+}
+
+/*
+ * Is the element certainly not in the set?
+ *
+ * False means the element may or may not have been added.
+ */
+bool
+bloom_lacks_hash(bloom_filter *filter, uint32 hash)
+{
+	uint32		positions[MAX_HASH_FUNCS];
+	int			i;
+
+	probe_positions(filter, hash, positions);
+	for (i = 0; i < filter->k_hash_funcs; i++)
+	{
+		if (!(filter->bitset[positions[i] >> 3] & (1 << (positions[i] & 7))))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Proportion of bits that are set, from 0.0 to 1.0
+ *
+ * Above one half the filter rejects few elements, and callers may prefer
+ * not to use it at all.
+ */
+double
+bloom_prop_bits_set(bloom_filter *filter)
+{
+	uint32		nbytes = filter->nbits / BITS_PER_BYTE;
+	uint64		bits_set = 0;
+	uint32		i;
+
+	for (i = 0; i < nbytes; i++)
+	{
+		unsigned char byte = filter->bitset[i];
+
+		while (byte)
+		{
+			bits_set++;
+			byte &= byte - 1;
+		}
+	}
+
+	return (double) bits_set / filter->nbits;
+}
+
+/*
+ * Number of probes minimizing the false positive rate, ln(2) * m / n
+ */
+static int
+optimal_k(uint32 nbits, double total_elems)
+{
+	int			k = rint(log(2.0) * nbits / total_elems);
+
+	return Max(1, Min(k, MAX_HASH_FUNCS));
+}
+
+/*
+ * Compute the k bit positions of an element.  The caller's hash is remixed
+ * with the seed first, so that the probes do not line up with the bucket and
+ * batch numbers a hash join derives from the same value.
+ */
+static void
+probe_positions(bloom_filter *filter, uint32 hash, uint32 *positions)
+{
+	uint32		mask = filter->nbits - 1;
+	uint32		x;
+	uint32		y;
+	int			i;
+
+	x = DatumGetUInt32(hash_uint32(hash ^ filter->seed));
+	y = DatumGetUInt32(hash_uint32(x)) | 1;
+
+	for (i = 0; i < filter->k_hash_funcs; i++)
+	{
+		positions[i] = x & mask;
+		x += y;
+	}
+}
@@ -1111,6 +1111,65 @@ pq_getbyte_if_available(unsigned char *c)
     return r;
 }
 
+#ifdef __OPENTENBASE__
+/* --------------------------------
+ *        pq_peekbyte_if_available - peek at the next byte from connection,
+ *            if available
+ *
+ * Like pq_getbyte_if_available, but the byte is left in the buffer and the
+ * caller need not be reading a message.  Returns 1 if a byte is available,
+ * 0 if no data was available, or EOF if trouble.
+ * --------------------------------
+ */
+int
+pq_peekbyte_if_available(unsigned char *c)
+{
+    int            r;
+
+    Assert(!PqCommReadingMsg);
+
+    if (PqRecvPointer < PqRecvLength)
+    {
+        *c = PqRecvBuffer[PqRecvPointer];
+        return 1;
+    }
+
+    /* Buffer is empty, so it can be refilled from the start */
+    PqRecvPointer = PqRecvLength = 0;
+
+    /* Put the socket into non-blocking mode */
+    socket_set_nonblocking(true);
+
+    r = secure_read(MyProcPort, PqRecvBuffer, PQ_RECV_BUFFER_SIZE);
+    if (r < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            r = 0;
+        else
+        {
+            /* see pq_getbyte_if_available about why this is COMMERROR */
+            ereport(COMMERROR,
+                    (errcode_for_socket_access(),
+                     errmsg("could not receive data from client: %m")));
+            r = EOF;
+        }
+    }
+    else if (r == 0)
+    {
+        /* EOF detected */
+        r = EOF;
+    }
+    else
+    {
+        PqRecvLength = r;
+        *c = PqRecvBuffer[0];
+        r = 1;
+    }
+
+    return r;
+}
+#endif
+
 /* --------------------------------
  *        pq_getbytes        - get a known number of bytes from connection
  *
@@ -472,6 +472,7 @@ CopyScanFields(const Scan *from, Scan *newnode)
 #ifdef __OPENTENBASE__
     COPY_SCALAR_FIELD(ispartchild);
     COPY_SCALAR_FIELD(childidx);
+    COPY_BITMAPSET_FIELD(scan_shards);
 #endif
 }
 
@@ -610,6 +610,7 @@ _outScanInfo(StringInfo str, const Scan *node)
 #ifdef __OPENTENBASE__
     WRITE_BOOL_FIELD(ispartchild);
     WRITE_INT_FIELD(childidx);
+    WRITE_BITMAPSET_FIELD(scan_shards);
 #endif
 }
 
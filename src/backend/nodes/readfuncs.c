@@ -2646,6 +2646,7 @@ ReadCommonScan(Scan *local_node)
 #ifdef __OPENTENBASE__
     READ_BOOL_FIELD(ispartchild);
     READ_INT_FIELD(childidx);
+    READ_BITMAPSET_FIELD(scan_shards);
 #endif
 }
 
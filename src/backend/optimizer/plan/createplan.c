@@ -893,6 +893,27 @@ create_scan_plan(PlannerInfo *root, Path *best_path, int flags)
     }
 
 #ifdef __OPENTENBASE__
+    /*
+     * Heap and index scans of shard tables can skip the extents of shards
+     * the quals cannot match. The set travels with the plan to datanodes.
+     */
+    if ((IsA(plan, SeqScan) || IsA(plan, IndexScan)) &&
+        rel->rtekind == RTE_RELATION && ShardScanPruningEnabled())
+    {
+        RelationLocInfo *rel_loc_info;
+
+        rte = planner_rt_fetch(rel->relid, root);
+        rel_loc_info = GetRelationLocInfo(rte->relid);
+        if (rel_loc_info)
+        {
+            ((Scan *) plan)->scan_shards =
+                GetRelationShardsByQuals(rte->relid, rel_loc_info, rel->relid,
+                                         (Node *) extract_actual_clauses(rel->baserestrictinfo,
+                                                                         false));
+            FreeRelationLocInfo(rel_loc_info);
+        }
+    }
+
     if((rel->reloptkind == RELOPT_BASEREL || rel->reloptkind == RELOPT_OTHER_MEMBER_REL) && rel->rtekind == RTE_RELATION && rel->intervalparent && !rel->isdefault)
     {        
         /* create append plan with a list of scan.
@@ -125,6 +125,9 @@ typedef struct
 Oid        primary_data_node = InvalidOid;
 int        num_preferred_data_nodes = 0;
 Oid        preferred_data_node[MAX_PREFERRED_NODES];
+#ifdef __OPENTENBASE__
+bool    enable_shard_scan_pruning = true;
+#endif
 
 #ifdef XCP
 
@@ -3000,6 +3003,112 @@ GetRelationNodesByQuals(Oid reloid, RelationLocInfo *rel_loc_info,
     return exec_nodes;
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * GetRelationShardsByQuals
+ * Shard counterpart of GetRelationNodesByQuals. If the quals pin the
+ * distribution column of a shard table to constants, return the set of
+ * ShardIDs those values hash to, so that scans on the datanodes can be
+ * restricted to the extents of these shards. NULL means no restriction.
+ */
+Bitmapset *
+GetRelationShardsByQuals(Oid reloid, RelationLocInfo *rel_loc_info,
+                         Index varno, Node *quals)
+{
+    Expr       *distcol_expr;
+    List       *values;
+    ListCell   *lc;
+    Oid         disttype;
+    int32       disttypmod;
+    Bitmapset  *shards = NULL;
+
+    /*
+     * The shard of a row of a cold-hot table also depends on the secondary
+     * distribution column, leave those alone.
+     */
+    if (!ShardScanPruningEnabled() || !rel_loc_info ||
+        rel_loc_info->locatorType != LOCATOR_TYPE_SHARD ||
+        AttributeNumberIsValid(rel_loc_info->secAttrNum))
+    {
+        return NULL;
+    }
+
+    distcol_expr = pgxc_find_distcol_expr(varno, rel_loc_info->partAttrNum,
+                                          quals);
+    if (!distcol_expr)
+    {
+        return NULL;
+    }
+
+    if (IsA(distcol_expr, ArrayCoerceExpr) &&
+        IsA(((ArrayCoerceExpr *) distcol_expr)->arg, ArrayExpr))
+    {
+        distcol_expr = ((ArrayCoerceExpr *) distcol_expr)->arg;
+    }
+
+    if (IsA(distcol_expr, ArrayExpr))
+    {
+        values = ((ArrayExpr *) distcol_expr)->elements;
+    }
+    else
+    {
+        values = list_make1(distcol_expr);
+    }
+
+    disttype = get_atttype(reloid, rel_loc_info->partAttrNum);
+    disttypmod = get_atttypmod(reloid, rel_loc_info->partAttrNum);
+
+    foreach(lc, values)
+    {
+        Node   *expr = (Node *) lfirst(lc);
+        Const  *const_expr;
+
+        /* convert to distribute column type, as done on insert */
+        expr = coerce_to_target_type(NULL,
+                                     expr,
+                                     exprType(expr),
+                                     disttype, disttypmod,
+                                     COERCION_ASSIGNMENT,
+                                     COERCE_IMPLICIT_CAST, -1);
+        expr = eval_const_expressions(NULL, expr);
+        if (!expr || !IsA(expr, Const))
+        {
+            bms_free(shards);
+            return NULL;
+        }
+
+        /* NULL never matches an equality qual */
+        const_expr = castNode(Const, expr);
+        if (const_expr->constisnull)
+        {
+            continue;
+        }
+
+        shards = bms_add_member(shards,
+                                EvaluateShardId(disttype, false,
+                                                const_expr->constvalue,
+                                                InvalidOid, true, (Datum) 0,
+                                                reloid));
+    }
+
+    return shards;
+}
+
+/*
+ * ShardScanPruningEnabled
+ * Whether scans may be restricted to the shards of their quals. With key
+ * values enabled the shard of a value depends on pgxc_key_values and on the
+ * secondary column, neither of which a plan can know, so never prune then.
+ * Checked both when planning and when starting a scan, as cached plans
+ * outlive a change of either setting.
+ */
+bool
+ShardScanPruningEnabled(void)
+{
+    return enable_shard_scan_pruning && !g_EnableKeyValue;
+}
+#endif
+
 /*
  * GetRelationDistribColumn
  * Return hash column name for relation or NULL if relation is not distributed.
@@ -21,6 +21,7 @@
 #include <time.h>
 #include "postgres.h"
 #include "access/twophase.h"
+#include "access/hash.h"
 #include "access/gtm.h"
 #include "access/sysattr.h"
 #include "access/transam.h"
@@ -69,6 +70,14 @@
 #include "pgxc/squeue.h"
 #include "postmaster/postmaster.h"
 #include "utils/syscache.h"
+#include "funcapi.h"
+#include "port/atomics.h"
+#include "portability/instr_time.h"
+#include "storage/shmem.h"
+#include "pgxc/shardmap.h"
+#include "utils/inval.h"
+#include "lib/bloomfilter.h"
+#include "libpq/pqformat.h"
 #endif
 /*
  * We do not want it too long, when query is terminating abnormally we just
@@ -95,6 +104,8 @@ List *executed_node_list = NULL;
 #ifdef __OPENTENBASE__
 /* GUC parameter */
 int DataRowBufferSize = 0;  /* MBytes */
+bool enable_shard_route_cache = true;
+int remote_dml_batch_size = 64;
 
 #define DATA_ROW_BUFFER_SIZE(n) (DataRowBufferSize * 1024 * 1024 * (n))
 #endif
@@ -119,6 +130,86 @@ struct find_params_context
 #define COPY_BUFFER_SIZE 8192
 #define PRIMARY_NODE_WRITEAHEAD 1024 * 1024
 
+#ifdef __OPENTENBASE__
+/*
+ * Latency of the remote commit phases, see RemoteCommitStatsRecord().
+ */
+typedef enum
+{
+    REMOTE_COMMIT_PREPARE_GTS,      /* prepare timestamp from GTM */
+    REMOTE_COMMIT_PREPARE,          /* PREPARE TRANSACTION on the nodes */
+    REMOTE_COMMIT_COMMIT_GTS,       /* commit timestamp from GTM */
+    REMOTE_COMMIT_COMMIT_PREPARED,  /* COMMIT PREPARED on the nodes */
+    REMOTE_COMMIT_COMMIT,           /* one phase COMMIT on the nodes */
+    REMOTE_COMMIT_PHASES
+} RemoteCommitPhase;
+
+static const char *RemoteCommitPhaseNames[REMOTE_COMMIT_PHASES] =
+{
+    "prepare_gts",
+    "prepare",
+    "commit_gts",
+    "commit_prepared",
+    "commit"
+};
+
+/* bucket i counts latencies below 16us << i, the last one everything else */
+#define REMOTE_COMMIT_LATENCY_BUCKETS 20
+#define REMOTE_COMMIT_LATENCY_BUCKET_BOUND(i) (UINT64CONST(16) << (i))
+
+typedef struct RemoteCommitStatsData
+{
+    pg_atomic_uint64 count[REMOTE_COMMIT_PHASES][REMOTE_COMMIT_LATENCY_BUCKETS];
+    pg_atomic_uint64 one_phase_commits;     /* writes committed with plain COMMIT */
+    pg_atomic_uint64 two_phase_commits;     /* writes committed with implicit 2PC */
+    pg_atomic_uint64 dml_batched_rows;      /* remote INSERT rows sent in batches */
+    pg_atomic_uint64 dml_round_trips_saved; /* waits for datanodes avoided by that */
+} RemoteCommitStatsData;
+
+static RemoteCommitStatsData *RemoteCommitStats = NULL;
+
+static void RemoteCommitStatsRecord(RemoteCommitPhase phase, instr_time start);
+static int  pgxc_count_remote_writers(void);
+static void RemoteCommitStatsCount(bool two_phase);
+static bool remote_dml_can_batch(ModifyTableState *mtstate,
+                                 ResultRelInfo *resultRelInfo);
+static void remote_dml_batch_flush(ModifyTableState *mtstate,
+                                   RemoteQueryState *node);
+
+/*
+ * Target datanode of single-shard statements whose distribution key is only
+ * known at execution time, see shard_route_lookup().
+ */
+#define SHARD_ROUTE_CACHE_SIZE 8192
+
+typedef struct
+{
+    Oid     relid;
+    bool    cacheable;      /* plain shard table, routed by key hash only */
+    Oid     disttype;       /* type of the distribution column */
+    Oid     groupid;        /* node group of the table */
+} ShardRouteRel;
+
+typedef struct
+{
+    Oid     relid;
+    long    hashvalue;
+} ShardRouteKey;
+
+typedef struct
+{
+    ShardRouteKey key;
+    int           nodeindex;
+} ShardRouteEnt;
+
+static HTAB   *ShardRouteRels = NULL;
+static HTAB   *ShardRoutes = NULL;
+static uint32  ShardRouteVersion = 0;
+
+static bool shard_route_lookup(Oid relid, Datum value, int *nodeindex);
+static void RemoteSubplanSendFilter(RemoteSubplanState *node);
+#endif
+
 /*
  * Flag to track if a temporary object is accessed by the current transaction
  */
@@ -145,6 +236,7 @@ static bool pgxc_node_remote_finish(char *prepareGID, bool commit,
                         GlobalTransactionId prepare_gxid);
 static bool
 pgxc_node_remote_prefinish(char *prepareGID, char *nodestring);
+static int pgxc_node_flush_finish(PGXCNodeHandle **connections, int conn_count, bool commit);
 
 #ifdef __OPENTENBASE__
 /*static void pgxc_node_remote_abort_subtxn(void);*/
@@ -154,6 +246,9 @@ static void pgxc_node_remote_commit(TranscationType txn_type, bool need_release_
 static void pgxc_node_remote_abort(TranscationType txn_type, bool need_release_handle);
 static int pgxc_node_remote_commit_internal(PGXCNodeAllHandles *handles, TranscationType txn_type);
 #endif
+#ifdef __TWO_PHASE_TRANS__
+static void RecordTwoPhaseSendError(PGXCNodeHandle *conn, TwoPhaseTransState state);
+#endif
 
 static void pgxc_connections_cleanup(ResponseCombiner *combiner);
 
@@ -759,9 +854,19 @@ HandleDataRow(ResponseCombiner *combiner, char *msg_body, size_t len, Oid node)
 
     /*
      * We are copying message because it points into connection buffer, and
-     * will be overwritten on next socket read
+     * will be overwritten on next socket read. The copy is made in the
+     * context of the result slot, so CopyDataRowTupleToSlot() can store it
+     * without copying it once more.
      */
+#ifdef __OPENTENBASE__
+    combiner->currentRow = (RemoteDataRow)
+        MemoryContextAlloc(combiner->ss.ps.ps_ResultTupleSlot ?
+                           combiner->ss.ps.ps_ResultTupleSlot->tts_mcxt :
+                           CurrentMemoryContext,
+                           sizeof(RemoteDataRowData) + len);
+#else
     combiner->currentRow = (RemoteDataRow) palloc(sizeof(RemoteDataRowData) + len);
+#endif
     memcpy(combiner->currentRow->msg, msg_body, len);
     combiner->currentRow->msglen = len;
     combiner->currentRow->msgnode = node;
@@ -1975,6 +2080,21 @@ CopyDataRowTupleToSlot(ResponseCombiner *combiner, TupleTableSlot *slot)
 {
     RemoteDataRow     datarow;
     MemoryContext    oldcontext;
+
+#ifdef __OPENTENBASE__
+    /*
+     * Rows read from the connections and the row buffers are in the slot's
+     * context already, hand them over as they are. Rows read back from the
+     * spill tuplestore may be elsewhere and still need a copy.
+     */
+    if (GetMemoryChunkContext(combiner->currentRow) == slot->tts_mcxt)
+    {
+        ExecStoreDataRowTuple(combiner->currentRow, slot, true);
+        combiner->currentRow = NULL;
+        return;
+    }
+#endif
+
     oldcontext = MemoryContextSwitchTo(slot->tts_mcxt);
     datarow = (RemoteDataRow) palloc(sizeof(RemoteDataRowData) + combiner->currentRow->msglen);
     datarow->msgnode = combiner->currentRow->msgnode;
@@ -1987,6 +2107,136 @@ CopyDataRowTupleToSlot(ResponseCombiner *combiner, TupleTableSlot *slot)
 }
 
 
+#ifdef __OPENTENBASE__
+/*
+ * Wait until the current connection of the combiner or any other one it
+ * reads from has data.
+ *
+ * All connections are polled at once, so a node that is slow to answer does
+ * not hold up the rows the others have already sent. Suspended portals are
+ * asked for the next batch first, so that every producer keeps a batch of
+ * PGXLRemoteFetchSize rows in flight. Without merge sort the caller just moves
+ * on to a connection with data. With merge sort rows must be consumed in
+ * order from the current connection, the rows of the other ones are moved
+ * to their prefetch buffers instead. Those buffers spill to a tuplestore
+ * without limit, so with merge sort another batch is only requested from a
+ * producer while its in-memory buffer is below DATA_ROW_BUFFER_SIZE, the
+ * rest is fetched when merge sort gets to that connection.
+ *
+ * Returns the connection to read from next.
+ */
+static PGXCNodeHandle *
+pgxc_fetch_wait_any(ResponseCombiner *combiner, PGXCNodeHandle *conn)
+{
+    PGXCNodeHandle **busy;
+    int             *busy_index;
+    int              nbusy;
+    int              i;
+    int              ret;
+    struct timeval   timeout;
+
+    busy = (PGXCNodeHandle **) palloc(sizeof(PGXCNodeHandle *) * (combiner->conn_count + 1));
+    busy_index = (int *) palloc(sizeof(int) * (combiner->conn_count + 1));
+
+    for (;;)
+    {
+        nbusy = 0;
+        busy[nbusy] = conn;
+        busy_index[nbusy++] = combiner->current_conn;
+
+        for (i = 0; i < combiner->conn_count; i++)
+        {
+            PGXCNodeHandle *other = combiner->connections[i];
+
+            if (other == NULL || other == conn || other->combiner != combiner)
+            {
+                continue;
+            }
+
+            if (other->state == DN_CONNECTION_STATE_IDLE &&
+                combiner->extended_query && !combiner->probing_primary &&
+                (!combiner->merge_sort || combiner->dataRowMemSize == NULL ||
+                 combiner->dataRowMemSize[i] < DATA_ROW_BUFFER_SIZE(1)))
+            {
+                if (pgxc_node_send_execute(other, combiner->cursor, PGXLRemoteFetchSize) != 0 ||
+                    pgxc_node_send_flush(other) != 0)
+                {
+                    ereport(ERROR,
+                            (errcode(ERRCODE_INTERNAL_ERROR),
+                             errmsg("Failed to send execute cursor '%s' to node %u",
+                                    combiner->cursor, other->nodeoid)));
+                }
+            }
+
+            if (other->state == DN_CONNECTION_STATE_QUERY)
+            {
+                busy[nbusy] = other;
+                busy_index[nbusy++] = i;
+            }
+        }
+
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 1000;
+        ret = pgxc_node_receive(nbusy, busy, &timeout);
+        if (DNStatus_ERR == ret)
+        {
+            for (i = 0; i < nbusy; i++)
+            {
+                if (busy[i]->state == DN_CONNECTION_STATE_ERROR_FATAL)
+                {
+                    break;
+                }
+            }
+            ereport(ERROR,
+                    (errcode(ERRCODE_INTERNAL_ERROR),
+                     errmsg("Failed to receive more data from data node %u",
+                            busy[i < nbusy ? i : 0]->nodeoid)));
+        }
+        else if (DNStatus_EXPIRED == ret)
+        {
+            continue;
+        }
+
+        if (HAS_MESSAGE_BUFFERED(conn))
+        {
+            break;
+        }
+
+        for (i = 1; i < nbusy; i++)
+        {
+            if (!HAS_MESSAGE_BUFFERED(busy[i]))
+            {
+                continue;
+            }
+
+            if (!combiner->merge_sort)
+            {
+                combiner->current_conn = busy_index[i];
+                combiner->current_conn_rows_consumed = 0;
+                conn = busy[i];
+                break;
+            }
+
+            /* the connection may be done now, recheck the current one */
+            if (PreFetchConnection(busy[i], busy_index[i]))
+            {
+                break;
+            }
+        }
+
+        if (i < nbusy)
+        {
+            break;
+        }
+    }
+
+    pfree(busy);
+    pfree(busy_index);
+
+    return conn;
+}
+#endif
+
 /*
  * FetchTuple
  *
@@ -2349,13 +2599,6 @@ READ_ROWBUFFER:
                         (errcode(ERRCODE_INTERNAL_ERROR),
                          errmsg("Failed flush cursor '%s' node %u", combiner->cursor, conn->nodeoid)));
             }
-
-            if (pgxc_node_receive(1, &conn, NULL))
-            {
-                ereport(ERROR,
-                        (errcode(ERRCODE_INTERNAL_ERROR),
-                         errmsg("Failed receive data from node %u cursor '%s'", conn->nodeoid, combiner->cursor)));
-            }
         }
 
         /* read messages */
@@ -2411,86 +2654,12 @@ READ_ROWBUFFER:
         else if (res == RESPONSE_EOF)
         {
 #ifdef __OPENTENBASE__
-            /* 
-             * We encountered incomplete message, try to read more.
-             * Here if we read timeout, then we move to other connections to read, because we
-             * easily got deadlock if a specific cursor run as producer on two nodes. If we can
-             * consume data from all all connections, we can break the deadlock loop.
-             */            
-            bool   bComplete          = false;
-            DNConnectionState state   = DN_CONNECTION_STATE_IDLE;
-            int    i                  = 0;
-            int    ret                   = 0;
-            PGXCNodeHandle *save_conn = NULL;
-            struct timeval timeout;
-            timeout.tv_sec            = 0;
-            timeout.tv_usec           = 1000;    
-
-            save_conn = conn;
-            while (1)
-            {
-                conn  = save_conn;
-                state = conn->state; /* Save the connection state. */
-                ret   = pgxc_node_receive(1, &conn, &timeout);
-                if (DNStatus_OK == ret)
-                {
-                    /* We got data, handle it. */
-                    break;
-                }
-                else if (DNStatus_ERR == ret)
-                {
-                    ereport(ERROR,
-                            (errcode(ERRCODE_INTERNAL_ERROR),
-                             errmsg("Failed to receive more data from data node %u", conn->nodeoid)));
-                }
-                else
-                {
-                    /* Restore the saved state of connection. */
-                    conn->state = state;
-                }
-
-                /* Try to read data from other connections. */
-                for (i = 0; i < combiner->conn_count; i ++)
-                {
-                    conn  = combiner->connections[i];
-                    if (save_conn != conn && conn != NULL)
-                    {
-                        /* Save the connection state. */
-                        state = conn->state;
-                        if (state == DN_CONNECTION_STATE_QUERY)
-                        {
-                            ret = pgxc_node_receive(1, &conn, &timeout);
-                            if (DNStatus_OK == ret)
-                            {
-                                /* We got data, prefetch it. */
-                                bComplete = PreFetchConnection(conn, i);
-                                if (bComplete)
-                                {
-                                    /* Receive Complete on one connection, we need retry to read from current_conn. */
-                                    break;
-                                }
-                                else
-                                {
-                                    /* Maybe Suspend or Expired, just move to next connection and read. */
-                                    continue;
-                                }
-                            }
-                            else if (DNStatus_EXPIRED == ret)
-                            {
-                                /* Restore the saved state of connection. */
-                                conn->state = state;
-                                continue;
-                            }
-                            else
-                            {
-                                ereport(ERROR,
-                                        (errcode(ERRCODE_INTERNAL_ERROR),
-                                         errmsg("Failed to receive more data from data node %u", conn->nodeoid)));
-                            }
-                        }
-                    }
-                }    
-            }
+            /*
+             * We encountered incomplete message, wait for more on all the
+             * connections. Reading whatever the other nodes send also breaks
+             * the deadlock of a cursor running as producer on two nodes.
+             */
+            conn = pgxc_fetch_wait_any(combiner, conn);
             continue;
 #else
             /* incomplete message, read more */
@@ -3456,6 +3625,18 @@ handle_response(PGXCNodeHandle *conn, ResponseCombiner *combiner)
 					HandleRemoteInstr(msg, msg_len, conn->nodeid, combiner);
 				/* just break to return EOF. */
 				break;
+			case SQUEUE_COMPRESSED_MSG: /* Compressed redistribution data */
+				if (expand_compressed_message(conn, msg, msg_len) != 0)
+				{
+					PGXCNodeSetConnectionState(conn,
+							DN_CONNECTION_STATE_ERROR_FATAL);
+					ereport(ERROR,
+							(errcode(ERRCODE_DATA_CORRUPTED),
+							 errmsg("invalid compressed data from node %s pid %d",
+									conn->nodename, conn->backend_pid)));
+				}
+				/* go on with the messages it carried */
+				break;
 #endif
             default:
                 /* sync lost? */
@@ -3764,6 +3945,9 @@ pgxc_node_remote_cleanup_all(void)
                                "RESET SESSION AUTHORIZATION;"
                                "RESET transaction_isolation;"
                                "RESET global_session";
+#ifdef __OPENTENBASE__
+	bool			deallocate = false;
+#endif
 
     elog(DEBUG5, "pgxc_node_remote_cleanup_all - handles->co_conn_count %d,"
             "handles->dn_conn_count %d", handles->co_conn_count,
@@ -3781,7 +3965,28 @@ pgxc_node_remote_cleanup_all(void)
 	/* Do not cleanup connections if we have prepared statements on nodes */
 	if (HaveActiveDatanodeStatements())
 	{
-		return;
+#ifdef __OPENTENBASE__
+		/*
+		 * When sessions share the connections, drop the statements on the
+		 * nodes instead.  They are prepared again on whatever connection
+		 * the session gets next time.
+		 */
+		if (enable_session_multiplexing && IS_PGXC_COORDINATOR &&
+			!IsConnFromCoord())
+		{
+			resetcmd = "DEALLOCATE ALL;"
+					   "RESET ALL;"
+					   "RESET SESSION AUTHORIZATION;"
+					   "RESET transaction_isolation;"
+					   "RESET global_session";
+			deallocate = true;
+		}
+		else
+#endif
+		{
+			pfree_pgxc_all_handles(handles);
+			return;
+		}
 	}
 
     /*
@@ -3868,6 +4073,10 @@ pgxc_node_remote_cleanup_all(void)
         pgxc_node_receive_responses(new_conn_count, new_connections, NULL, &combiner);
         CloseCombiner(&combiner);
     }
+#ifdef __OPENTENBASE__
+	if (deallocate)
+		InactivateAllDatanodeStatements();
+#endif
     pfree_pgxc_all_handles(handles);
 }
 
@@ -3958,6 +4167,9 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
     int             conn_state_index = 0; 
     int             twophase_index = 0;
     StringInfoData  partnodes;
+#endif
+#ifdef __OPENTENBASE__
+    instr_time      phase_start;
 #endif
     connections = (PGXCNodeHandle**)palloc(sizeof(PGXCNodeHandle*) * (OPENTENBASE_MAX_DATANODE_NUMBER + OPENTENBASE_MAX_COORDINATOR_NUMBER));
     if (connections == NULL)
@@ -3983,7 +4195,13 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
         {
 			elog(LOG, "prepare remote transaction xid %d gid %s", GetTopTransactionIdIfAny(), prepareGID);
         }
+#ifdef __OPENTENBASE__
+        INSTR_TIME_SET_CURRENT(phase_start);
+#endif
         global_prepare_ts = GetGlobalTimestampGTM();
+#ifdef __OPENTENBASE__
+        RemoteCommitStatsRecord(REMOTE_COMMIT_PREPARE_GTS, phase_start);
+#endif
 
 #ifdef __TWO_PHASE_TESTS__
     if (PART_PREPARE_GET_TIMESTAMP == twophase_exception_case)
@@ -4064,6 +4282,9 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
     }
 #endif
 
+#ifdef __OPENTENBASE__
+    INSTR_TIME_SET_CURRENT(phase_start);
+#endif
     for (i = 0; i < handles->dn_conn_count; i++)
     {
         PGXCNodeHandle *conn = handles->datanode_handles[i];
@@ -4073,10 +4294,12 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
          * will be reported at the end of the function, and we will rollback
          * remotes as part of the error handling.
          * Just skip to clean up section and check if we have already prepared
-         * somewhere, we should abort that prepared transaction.
+         * somewhere, we should abort that prepared transaction.  The commands
+         * queued so far are still flushed below, as the clean up section
+         * waits for their responses.
          */
         if (!isOK)
-            goto prepare_err;
+            break;
 
         /*
          * Skip empty slots
@@ -4112,7 +4335,7 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
                 }
 #endif
                 /* Send down prepare command */
-                if (pgxc_node_send_query(conn, commit_cmd))
+                if (pgxc_node_send_query_noflush(conn, commit_cmd))
                 {
                     /*
                      * not a big deal, it was read only, the connection will be
@@ -4206,7 +4429,7 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
                 }
 #endif 
                 /* Send down prepare command */
-                if (pgxc_node_send_query(conn, prepare_cmd))
+                if (pgxc_node_send_query_noflush(conn, prepare_cmd))
                 {
 #ifdef __TWO_PHASE_TRANS__
                     /* record connection error */
@@ -4282,10 +4505,12 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
          * will be reported at the end of the function, and we will rollback
          * remotes as part of the error handling.
          * Just skip to clean up section and check if we have already prepared
-         * somewhere, we should abort that prepared transaction.
+         * somewhere, we should abort that prepared transaction.  The commands
+         * queued so far are still flushed below, as the clean up section
+         * waits for their responses.
          */
         if (!isOK)
-            goto prepare_err;
+            break;
 
         /*
          * Skip empty slots
@@ -4316,7 +4541,7 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
                 }
 #endif
                 /* Send down prepare command */
-                if (pgxc_node_send_query(conn, commit_cmd))
+                if (pgxc_node_send_query_noflush(conn, commit_cmd))
                 {
                     /*
                      * not a big deal, it was read only, the connection will be
@@ -4408,7 +4633,7 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
 #endif
 
                 /* Send down prepare command */
-                if (pgxc_node_send_query(conn, prepare_cmd))
+                if (pgxc_node_send_query_noflush(conn, prepare_cmd))
                 {
 #ifdef __TWO_PHASE_TRANS__
                     /* record connection error */
@@ -4469,6 +4694,47 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
         }
     }
 
+    /*
+     * The commands are only queued so far, send them to all the nodes before
+     * waiting for any of them.  This is done even if something went wrong,
+     * the clean up section reads the responses of the nodes in connections
+     * and would wait for nothing on a node that never got its command.
+     */
+    if (pgxc_node_flush_all(connections, conn_count))
+    {
+        int nsent = 0;
+
+        for (i = 0; i < conn_count; i++)
+        {
+            PGXCNodeHandle *conn = connections[i];
+
+            if (conn->state != DN_CONNECTION_STATE_ERROR_FATAL)
+            {
+                connections[nsent++] = conn;
+            }
+            else if (conn->read_only)
+            {
+                /* not a big deal, the connection will be abandoned later */
+                ereport(LOG,
+                        (errcode(ERRCODE_INTERNAL_ERROR),
+                         errmsg("failed to send COMMIT command to "
+                            "the node %u", conn->nodeoid)));
+            }
+            else
+            {
+#ifdef __TWO_PHASE_TRANS__
+                RecordTwoPhaseSendError(conn, TWO_PHASE_PREPARE_ERROR);
+#endif
+                isOK = false;
+                ereport(WARNING,
+                        (errcode(ERRCODE_INTERNAL_ERROR),
+                         errmsg("failed to send PREPARE TRANSACTION command to "
+                            "the node %u", conn->nodeoid)));
+            }
+        }
+        conn_count = nsent;
+    }
+
     SetSendCommandId(false);
 #ifdef __TWO_PHASE_TESTS__
     if (PREPARE_ERROR_SEND_QUERY == twophase_exception_case ||
@@ -4517,6 +4783,10 @@ pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit)
         for (i = 0; i < conn_count; i++)
             connections[i]->ck_resp_rollback = false;
 
+#ifdef __OPENTENBASE__
+        RemoteCommitStatsRecord(REMOTE_COMMIT_PREPARE, phase_start);
+#endif
+
         clear_handles();
         pfree_pgxc_all_handles(handles);
     }
@@ -4868,6 +5138,11 @@ pgxc_node_remote_commit(TranscationType txn_type, bool need_release_handle)
 	ResponseCombiner combiner;
 	PGXCNodeHandle **connections = NULL;
 	int				conn_count = 0;
+#ifdef __OPENTENBASE__
+	instr_time		phase_start;
+
+	INSTR_TIME_SET_CURRENT(phase_start);
+#endif
 
 #ifdef __OPENTENBASE__
     switch (txn_type)
@@ -4951,7 +5226,7 @@ pgxc_node_remote_commit(TranscationType txn_type, bool need_release_handle)
             }
 #endif
 
-            if (pgxc_node_send_query(conn, commitCmd))
+            if (pgxc_node_send_query_noflush(conn, commitCmd))
             {
                 /*
                  * Do not bother with clean up, just bomb out. The error handler
@@ -5000,7 +5275,7 @@ pgxc_node_remote_commit(TranscationType txn_type, bool need_release_handle)
             }
 #endif
 
-            if (pgxc_node_send_query(conn, commitCmd))
+            if (pgxc_node_send_query_noflush(conn, commitCmd))
             {
                 /*
                  * Do not bother with clean up, just bomb out. The error handler
@@ -5019,6 +5294,23 @@ pgxc_node_remote_commit(TranscationType txn_type, bool need_release_handle)
         }
     }
 
+    /* Send the queued commands to all the nodes at once */
+    if (pgxc_node_flush_all(connections, conn_count))
+    {
+        for (i = 0; i < conn_count; i++)
+        {
+            PGXCNodeHandle *conn = connections[i];
+
+            if (conn->state == DN_CONNECTION_STATE_ERROR_FATAL)
+            {
+                ereport(ERROR,
+                        (errcode(ERRCODE_INTERNAL_ERROR),
+                         errmsg("pgxc_node_remote_commit failed to send COMMIT command to the node %s, pid:%d, for %s",
+                                conn->nodename, conn->backend_pid, strerror(errno))));
+            }
+        }
+    }
+
     /*
      * Release the BarrierLock.
      */
@@ -5055,6 +5347,12 @@ pgxc_node_remote_commit(TranscationType txn_type, bool need_release_handle)
 			}
 		}
 		CloseCombiner(&combiner);
+#ifdef __OPENTENBASE__
+		if (TXN_TYPE_CommitTxn == txn_type)
+		{
+			RemoteCommitStatsRecord(REMOTE_COMMIT_COMMIT, phase_start);
+		}
+#endif
 	}
 
 #ifndef __OPENTENBASE__
@@ -5162,6 +5460,50 @@ void SetLocalTwoPhaseStateHandles(PGXCNodeAllHandles *handles)
     g_twophase_state.datanode_index = 0;
 }
 
+/*
+ * The command queued for the participant could not be sent, record it in the
+ * state of the participant as a failed send would have been.
+ */
+static void
+RecordTwoPhaseSendError(PGXCNodeHandle *conn, TwoPhaseTransState state)
+{
+    int i;
+    PGXCNodeAllHandles *handles = g_twophase_state.handles;
+
+    if (NULL == handles)
+    {
+        return;
+    }
+
+    for (i = 0; i < g_twophase_state.datanode_index; i++)
+    {
+        ConnTransState *conn_state = &g_twophase_state.datanode_state[i];
+
+        if (conn_state->is_participant &&
+            conn_state->handle_idx < handles->dn_conn_count &&
+            handles->datanode_handles[conn_state->handle_idx] == conn)
+        {
+            conn_state->conn_state = TWO_PHASE_SEND_QUERY_ERROR;
+            conn_state->state = state;
+            return;
+        }
+    }
+
+    for (i = 0; i < g_twophase_state.coord_index; i++)
+    {
+        ConnTransState *conn_state = &g_twophase_state.coord_state[i];
+
+        if (conn_state->is_participant &&
+            conn_state->handle_idx < handles->co_conn_count &&
+            handles->coord_handles[conn_state->handle_idx] == conn)
+        {
+            conn_state->conn_state = TWO_PHASE_SEND_QUERY_ERROR;
+            conn_state->state = state;
+            return;
+        }
+    }
+}
+
 void UpdateLocalTwoPhaseState(int result, PGXCNodeHandle *response_handle, int conn_index, char *errmsg)
 {// #lizard forgives
     int index = 0;
@@ -6406,6 +6748,7 @@ get_exec_connections(RemoteQueryState *planstate,
             Datum secValue;
 #endif
 			RelationLocInfo *rel_loc_info;
+			int nodeindex;
 			if (exec_nodes->rewrite_done)
 			{
 				partvalue = exec_nodes->rewrite_value;
@@ -6421,12 +6764,26 @@ get_exec_connections(RemoteQueryState *planstate,
                                            planstate->combiner.ss.ps.ps_ExprContext,
                                            &isnull);
 			}
-			
-			rel_loc_info = GetRelationLocInfo(exec_nodes->en_relid);
 
+			/*
+			 * Point statements on plain shard tables go straight to the node
+			 * remembered for the key hash, without building a locator.
+			 */
+			if (planstate->eflags != EXEC_FLAG_EXPLAIN_ONLY && !isnull &&
 #ifdef __COLD_HOT__
-            if (exec_nodes->sec_en_expr)
-            {
+				exec_nodes->sec_en_expr == NULL &&
+#endif
+				shard_route_lookup(exec_nodes->en_relid, partvalue, &nodeindex))
+			{
+				nodelist = list_make1_int(nodeindex);
+				goto route_done;
+			}
+			
+			rel_loc_info = GetRelationLocInfo(exec_nodes->en_relid);
+
+#ifdef __COLD_HOT__
+            if (exec_nodes->sec_en_expr)
+            {
                 estate = ExecInitExpr(exec_nodes->sec_en_expr,
                                              (PlanState *) planstate);
 				/* For explain, no need to execute expr. */
@@ -6470,6 +6827,8 @@ get_exec_connections(RemoteQueryState *planstate,
                 pfree(nodes);
             }
             FreeRelationLocInfo(rel_loc_info);
+route_done:
+            ;
         }
         else if (OidIsValid(exec_nodes->en_relid))
         {
@@ -7562,10 +7921,36 @@ PreCommit_Remote(char *prepareGID, char *nodestring, bool preparedLocalNode)
         pgxc_node_remote_finish(prepareGID, true, nodestring,
                                 GetAuxilliaryTransactionId(),
                                 GetTopGlobalTransactionId());
+#ifdef __OPENTENBASE__
+        if (IS_PGXC_LOCAL_COORDINATOR)
+        {
+            RemoteCommitStatsCount(true);
+        }
+#endif
     }
 
+    /*
+     * At most one node wrote: commit it with a plain COMMIT. Nothing is
+     * stored on GTM for such a transaction, and the writer takes its commit
+     * timestamp itself after publishing its prepare timestamp, so readers
+     * on that node wait for the commit rather than miss it. A timestamp
+     * fetched here before the COMMIT is sent would not give that guarantee.
+     */
     if(!IsTwoPhaseCommitRequired(preparedLocalNode))
     {
+#ifdef __OPENTENBASE__
+        /*
+         * Only count what 2PC was actually skipped for. Datanodes, local-only
+         * writes and temp-table transactions that wrote on several nodes
+         * are not one-phase remote commits.
+         */
+        if (IS_PGXC_LOCAL_COORDINATOR && !nodestring && !preparedLocalNode &&
+            TransactionIdIsValid(GetTopTransactionIdIfAny()) &&
+            pgxc_count_remote_writers() == 1)
+        {
+            RemoteCommitStatsCount(false);
+        }
+#endif
         
         if(enable_distri_debug && GetTopGlobalTransactionId() && GetGlobalXidNoCheck())
         {
@@ -8528,6 +8913,54 @@ FinishRemotePreparedTransaction(char *prepareGID, bool commit)
 
 
 
+/*
+ * Send the COMMIT/ROLLBACK PREPARED commands queued on the connections.
+ * Connections that can not be flushed are recorded as failed to send and
+ * removed from the array, and from g_twophase_state.connections that follows
+ * it, so no response is waited for on them.  Returns the number of
+ * connections left.
+ */
+static int
+pgxc_node_flush_finish(PGXCNodeHandle **connections, int conn_count, bool commit)
+{
+    int i;
+    int nsent = 0;
+#ifdef __TWO_PHASE_TRANS__
+    int base  = g_twophase_state.connections_num - conn_count;
+#endif
+
+    if (0 == pgxc_node_flush_all(connections, conn_count))
+    {
+        return conn_count;
+    }
+
+    for (i = 0; i < conn_count; i++)
+    {
+        if (connections[i]->state == DN_CONNECTION_STATE_ERROR_FATAL)
+        {
+            elog(LOG, "failed to send %s PREPARED command to the node %s, pid:%d",
+                 commit ? "COMMIT" : "ROLLBACK",
+                 connections[i]->nodename, connections[i]->backend_pid);
+#ifdef __TWO_PHASE_TRANS__
+            RecordTwoPhaseSendError(connections[i],
+                                    commit ? TWO_PHASE_COMMIT_ERROR : TWO_PHASE_ABORT_ERROR);
+#endif
+            continue;
+        }
+
+        connections[nsent] = connections[i];
+#ifdef __TWO_PHASE_TRANS__
+        g_twophase_state.connections[base + nsent] = g_twophase_state.connections[base + i];
+#endif
+        nsent++;
+    }
+
+#ifdef __TWO_PHASE_TRANS__
+    g_twophase_state.connections_num = base + nsent;
+#endif
+    return nsent;
+}
+
 /*
  * Complete previously prepared transactions on remote nodes.
  * Release remote connection after completion.
@@ -8550,6 +8983,9 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
     GlobalTimestamp    global_committs;
 #endif
+#ifdef __OPENTENBASE__
+    instr_time         phase_start;
+#endif
 #ifdef __TWO_PHASE_TRANS__
     /* 
      *any send error in twophase trans will set all_conn_healthy to false 
@@ -8599,7 +9035,16 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
         pg_usleep(delay_before_acquire_committs);
     }
 
+#ifdef __OPENTENBASE__
+    INSTR_TIME_SET_CURRENT(phase_start);
+#endif
     global_committs = GetGlobalTimestampGTM();
+#ifdef __OPENTENBASE__
+    if (commit)
+    {
+        RemoteCommitStatsRecord(REMOTE_COMMIT_COMMIT_GTS, phase_start);
+    }
+#endif
     if(!GlobalTimestampIsValid(global_committs)){
         ereport(ERROR,
         (errcode(ERRCODE_INTERNAL_ERROR),
@@ -8703,6 +9148,9 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
     }
 #endif    
 
+#ifdef __OPENTENBASE__
+    INSTR_TIME_SET_CURRENT(phase_start);
+#endif
     for (i = 0; i < pgxc_handles->dn_conn_count; i++)
     {
         PGXCNodeHandle *conn = pgxc_handles->datanode_handles[i];
@@ -8744,7 +9192,7 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
         }
 #endif
 
-        if (pgxc_node_send_query(conn, finish_cmd))
+        if (pgxc_node_send_query_noflush(conn, finish_cmd))
         {
 #ifdef __TWO_PHASE_TRANS__
             // record conn state :send gxid fail
@@ -8775,6 +9223,19 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
     }
 
     /* Make sure datanode commit first */
+    if (conn_count && is_txn_has_parallel_ddl)
+    {
+        int nsent = pgxc_node_flush_finish(connections, conn_count, commit);
+
+#ifdef __TWO_PHASE_TRANS__
+        if (nsent != conn_count)
+        {
+            all_conn_healthy = false;
+        }
+#endif
+        conn_count = nsent;
+    }
+
     if (conn_count && is_txn_has_parallel_ddl)
     {
         InitResponseCombiner(&combiner, conn_count, COMBINE_TYPE_NONE);
@@ -8839,7 +9300,7 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
         }
 #endif
 
-        if (pgxc_node_send_query(conn, finish_cmd))
+        if (pgxc_node_send_query_noflush(conn, finish_cmd))
         {
 #ifdef __TWO_PHASE_TRANS__
             g_twophase_state.coord_state[twophase_index].conn_state = 
@@ -8867,6 +9328,20 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
         }
     }
 
+    /* Send the queued commands to all the nodes at once */
+    if (conn_count)
+    {
+        int nsent = pgxc_node_flush_finish(connections, conn_count, commit);
+
+#ifdef __TWO_PHASE_TRANS__
+        if (nsent != conn_count)
+        {
+            all_conn_healthy = false;
+        }
+#endif
+        conn_count = nsent;
+    }
+
     if (conn_count)
     {
         InitResponseCombiner(&combiner, conn_count, COMBINE_TYPE_NONE);
@@ -8888,6 +9363,13 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
         else
             CloseCombiner(&combiner);
     }
+
+#ifdef __OPENTENBASE__
+    if (commit)
+    {
+        RemoteCommitStatsRecord(REMOTE_COMMIT_COMMIT_PREPARED, phase_start);
+    }
+#endif
     
 #ifdef __TWO_PHASE_TRANS__
     if (all_conn_healthy == false)
@@ -11245,6 +11727,11 @@ primary_mode_phase_two:
         }
         else
             node->bound = true;
+#ifdef __OPENTENBASE__
+        /* the runtime filter was ready before the subplan started */
+        if (node->bound && node->pending_filter)
+            RemoteSubplanSendFilter(node);
+#endif
     }
 
     if (combiner->tuplesortstate)
@@ -11290,6 +11777,82 @@ primary_mode_phase_two:
     return NULL;
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * Send the runtime filter to the nodes still producing the subplan's rows.
+ */
+static void
+RemoteSubplanSendFilter(RemoteSubplanState *node)
+{
+    ResponseCombiner *combiner = &node->combiner;
+    StringInfo    body = node->pending_filter;
+    int            i;
+
+    node->pending_filter = NULL;
+
+    for (i = 0; i < combiner->conn_count; i++)
+    {
+        PGXCNodeHandle *conn = combiner->connections[i];
+
+        /* skip connections which are done or were buffered for others */
+        if (conn->combiner != combiner ||
+            conn->state != DN_CONNECTION_STATE_QUERY)
+            continue;
+
+        if (pgxc_node_send_runtime_filter(conn, combiner->cursor,
+                                          body->data, body->len) != 0 ||
+            pgxc_node_flush(conn) != 0)
+            ereport(ERROR,
+                    (errcode(ERRCODE_INTERNAL_ERROR),
+                     errmsg("Failed to send runtime filter to node %u",
+                            conn->nodeoid)));
+    }
+
+    pfree(body->data);
+    pfree(body);
+}
+
+/*
+ * Push a Bloom filter of the hash values a hash join can match to the nodes
+ * producing the rows of the subplan, so they do not send the rest.  Keys are
+ * columns of the subplan's tuples, see squeue.h for the hash they are
+ * combined to.  The filter is sent once, when the subplan is started if it
+ * has not been yet.
+ */
+void
+ExecRemoteSubplanPushFilter(RemoteSubplanState *node, int nkeys,
+                            AttrNumber *attnos, Oid *keytypes,
+                            bloom_filter *filter)
+{
+    RemoteSubplan *plan = (RemoteSubplan *) node->combiner.ss.ps.plan;
+    StringInfo    body;
+    MemoryContext oldcxt;
+    int            i;
+
+    if (node->filter_pushed || plan->cursor == NULL || node->local_exec)
+        return;
+    node->filter_pushed = true;
+
+    Assert(nkeys > 0 && nkeys <= SQUEUE_RUNTIME_FILTER_MAX_KEYS);
+
+    oldcxt = MemoryContextSwitchTo(node->combiner.ss.ps.state->es_query_cxt);
+    body = makeStringInfo();
+    MemoryContextSwitchTo(oldcxt);
+
+    pq_sendint(body, nkeys, 2);
+    for (i = 0; i < nkeys; i++)
+    {
+        pq_sendint(body, attnos[i], 2);
+        pq_sendint(body, keytypes[i], 4);
+    }
+    pq_sendint(body, bloom_total_size(filter), 4);
+    pq_sendbytes(body, (char *) filter, bloom_total_size(filter));
+
+    node->pending_filter = body;
+    if (node->bound)
+        RemoteSubplanSendFilter(node);
+}
+#endif
 
 void
 ExecReScanRemoteSubplan(RemoteSubplanState *node)
@@ -12689,6 +13252,229 @@ is_node_prepared(RemoteQueryState *rstate, int node)
     return BIT_SET(rstate->dml_prepared_mask[wordindex], wordoffset) != 0;
 }
 
+/*
+ * Functions the batching of remote INSERTs cannot look into: they might
+ * run statements of their own over the datanode connections.
+ */
+static bool
+remote_dml_batch_func_checker(Oid func_id, void *context)
+{
+    return func_id >= FirstNormalObjectId;
+}
+
+static bool
+remote_dml_batch_expr_walker(Node *node, void *context)
+{
+    if (node == NULL)
+    {
+        return false;
+    }
+
+    if (IsA(node, SubPlan))
+    {
+        return true;
+    }
+
+    if (check_functions_in_node(node, remote_dml_batch_func_checker, context))
+    {
+        return true;
+    }
+
+    return expression_tree_walker(node, remote_dml_batch_expr_walker, context);
+}
+
+static bool
+remote_dml_batch_plan_walker(PlanState *planstate, void *context)
+{
+    Plan *plan = planstate->plan;
+
+    /* the source reads from the datanodes itself */
+    if (IsA(planstate, RemoteSubplanState) || IsA(planstate, RemoteQueryState))
+    {
+        return true;
+    }
+
+    if (remote_dml_batch_expr_walker((Node *) plan->targetlist, context) ||
+        remote_dml_batch_expr_walker((Node *) plan->qual, context))
+    {
+        return true;
+    }
+
+    switch (nodeTag(plan))
+    {
+        case T_ValuesScan:
+            if (remote_dml_batch_expr_walker((Node *) ((ValuesScan *) plan)->values_lists,
+                                             context))
+            {
+                return true;
+            }
+            break;
+        case T_FunctionScan:
+            if (remote_dml_batch_expr_walker((Node *) ((FunctionScan *) plan)->functions,
+                                             context))
+            {
+                return true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return planstate_tree_walker(planstate, remote_dml_batch_plan_walker, context);
+}
+
+/*
+ * Can the rows of this INSERT be sent to the datanodes without waiting for
+ * the result of each of them?
+ *
+ * Nothing may use the datanode connections while responses are outstanding,
+ * and nothing may look at the rows before they are acknowledged. So only
+ * plain INSERTs qualify, without ON CONFLICT, RETURNING, BEFORE row triggers
+ * or check options, whose source and check constraints neither read from the
+ * datanodes nor call user defined functions. AFTER row triggers are fine,
+ * they are queued until the end of the statement.
+ */
+static bool
+remote_dml_can_batch(ModifyTableState *mtstate, ResultRelInfo *resultRelInfo)
+{
+    Relation    rel = resultRelInfo->ri_RelationDesc;
+    TriggerDesc *trigdesc = resultRelInfo->ri_TrigDesc;
+    TupleConstr *constr = RelationGetDescr(rel)->constr;
+    int         i;
+
+    if (remote_dml_batch_size <= 1 ||
+        mtstate->operation != CMD_INSERT ||
+        mtstate->mt_onconflict != ONCONFLICT_NONE ||
+        resultRelInfo->ri_projectReturning != NULL ||
+        resultRelInfo->ri_WithCheckOptions != NIL)
+    {
+        return false;
+    }
+
+    if (trigdesc &&
+        (trigdesc->trig_insert_before_row || trigdesc->trig_insert_instead_row))
+    {
+        return false;
+    }
+
+    if (constr)
+    {
+        for (i = 0; i < constr->num_check; i++)
+        {
+            if (remote_dml_batch_expr_walker(stringToNode(constr->check[i].ccbin), NULL))
+            {
+                return false;
+            }
+        }
+    }
+
+    for (i = 0; i < mtstate->mt_nplans; i++)
+    {
+        if (remote_dml_batch_plan_walker(mtstate->mt_plans[i], NULL))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Collect the results of the INSERTs sent for node but not acknowledged yet.
+ *
+ * The datanode answers every Bind/Execute pair with CommandComplete, or
+ * with an error after which it skips to the next sync and fails the rest of
+ * the commands, so exactly one response per queued row is read back. The
+ * first error is reported once the connections are drained.
+ */
+static void
+remote_dml_batch_flush(ModifyTableState *mtstate, RemoteQueryState *node)
+{
+    ResponseCombiner *combiner = (ResponseCombiner *) node;
+    int         rows = node->dml_batch_rows;
+    int         i;
+
+    if (rows == 0)
+    {
+        return;
+    }
+
+    combiner->DML_processed = 0;
+    for (i = 0; i < node->dml_batch_nconns; i++)
+    {
+        PGXCNodeHandle *conn = node->dml_batch_conns[i];
+
+        while (node->dml_batch_pending[i] > 0)
+        {
+            int res;
+
+            /* every response but the last one leaves the connection idle */
+            PGXCNodeSetConnectionState(conn, DN_CONNECTION_STATE_QUERY);
+            conn->combiner = combiner;
+
+            res = handle_response(conn, combiner);
+            if (res == RESPONSE_EOF)
+            {
+                if (pgxc_node_receive(1, &conn, NULL))
+                {
+                    PGXCNodeSetConnectionState(conn, DN_CONNECTION_STATE_ERROR_FATAL);
+                    add_error_message(conn, "Failed to fetch from data node");
+                    elog(ERROR, "Failed to receive batched insert results from datanode, nodeid:%d.",
+                                conn->nodeid);
+                }
+            }
+            else if (res == RESPONSE_COMPLETE || res == RESPONSE_ERROR)
+            {
+                node->dml_batch_pending[i]--;
+            }
+            else if (conn->state == DN_CONNECTION_STATE_ERROR_FATAL)
+            {
+                elog(ERROR, "Lost connection to datanode while inserting in batch, nodeid:%d.",
+                            conn->nodeid);
+            }
+        }
+    }
+
+    if (RemoteCommitStats)
+    {
+        pg_atomic_fetch_add_u64(&RemoteCommitStats->dml_batched_rows, rows);
+        pg_atomic_fetch_add_u64(&RemoteCommitStats->dml_round_trips_saved,
+                                rows - node->dml_batch_nconns);
+    }
+    node->dml_batch_nconns = 0;
+    node->dml_batch_rows = 0;
+
+    if (combiner->errorMessage)
+    {
+        pgxc_node_report_error(combiner);
+    }
+
+    /* the rows were counted when they were sent */
+    if (combiner->DML_processed < rows && mtstate->canSetTag)
+    {
+        mtstate->ps.state->es_processed -= rows - combiner->DML_processed;
+    }
+}
+
+/*
+ * ExecRemoteDMLFlush----wait for the INSERTs of mtstate still in flight.
+ *
+ * Must be called before anything else uses the datanode connections, in
+ * particular before the AFTER triggers of the statement are fired.
+ */
+void
+ExecRemoteDMLFlush(ModifyTableState *mtstate)
+{
+    ModifyTable *plan = (ModifyTable *) mtstate->ps.plan;
+    int          nremote_plans = list_length(plan->remote_plans);
+    int          i;
+
+    for (i = 0; i < nremote_plans; i++)
+    {
+        remote_dml_batch_flush(mtstate, (RemoteQueryState *) mtstate->mt_remoterels[i]);
+    }
+}
+
 /*
   *   ExecRemoteDML----execute DML on coordinator
   *   return true if insert/update/delete successfully, else false.
@@ -12719,6 +13505,12 @@ ExecRemoteDML(ModifyTableState *mtstate, ItemPointer tupleid, HeapTuple oldtuple
     TupleTableSlot *tupleslot = NULL;
     int nodeid;
 
+    /* decide once per target whether its rows can be sent in batches */
+    if (node->dml_batch == 0)
+    {
+        node->dml_batch = remote_dml_can_batch(mtstate, resultRelInfo) ? 1 : -1;
+    }
+
     if (operation == CMD_INSERT && mtstate->mt_onconflict == ONCONFLICT_UPDATE)
     {
         if (step->action == UPSERT_NONE)
@@ -12760,6 +13552,25 @@ ExecRemoteDML(ModifyTableState *mtstate, ItemPointer tupleid, HeapTuple oldtuple
 
     Assert(regular_conn_count == 1);
 
+    /*
+     * Targets share the datanode connections, partitions of one table for
+     * instance, so the rows other targets have in flight are collected first.
+     */
+    if (node->dml_batch > 0)
+    {
+        ModifyTable *plan = (ModifyTable *) mtstate->ps.plan;
+        int          j;
+
+        for (j = 0; j < list_length(plan->remote_plans); j++)
+        {
+            if (j != rel_index)
+            {
+                remote_dml_batch_flush(mtstate,
+                                       (RemoteQueryState *) mtstate->mt_remoterels[j]);
+            }
+        }
+    }
+
     nodeid = PGXCNodeGetNodeId(connections[i]->nodeoid, NULL);
     
     /* need transaction during execution, but only send begin to datanode once */
@@ -12800,6 +13611,50 @@ ExecRemoteDML(ModifyTableState *mtstate, ItemPointer tupleid, HeapTuple oldtuple
             elog(ERROR, "Failed to send command to datanode in ExecRemoteDML, nodeid:%d.",
                         connections[i]->nodeid);
         }
+
+        /*
+         * Do not wait for the row to be inserted, the results of the batch
+         * are collected together once it is full or the input is exhausted.
+         */
+        if (node->dml_batch > 0)
+        {
+            int j;
+
+            if (node->dml_batch_conns == NULL)
+            {
+                MemoryContext querycxt = combiner->ss.ps.state->es_query_cxt;
+
+                node->dml_batch_conns = (PGXCNodeHandle **)
+                    MemoryContextAllocZero(querycxt, NumDataNodes * sizeof(PGXCNodeHandle *));
+                node->dml_batch_pending = (int *)
+                    MemoryContextAllocZero(querycxt, NumDataNodes * sizeof(int));
+            }
+
+            for (j = 0; j < node->dml_batch_nconns; j++)
+            {
+                if (node->dml_batch_conns[j] == connections[i])
+                {
+                    break;
+                }
+            }
+
+            if (j == node->dml_batch_nconns)
+            {
+                Assert(j < NumDataNodes);
+                node->dml_batch_conns[j] = connections[i];
+                node->dml_batch_pending[j] = 0;
+                node->dml_batch_nconns++;
+            }
+            node->dml_batch_pending[j]++;
+            node->dml_batch_rows++;
+
+            if (node->dml_batch_rows >= remote_dml_batch_size)
+            {
+                remote_dml_batch_flush(mtstate, node);
+            }
+
+            return true;
+        }
     }
     else
 UPSERT:
@@ -13120,3 +13975,416 @@ SetSnapshot(EState *state)
     return result;
 }
 #endif
+
+#ifdef __OPENTENBASE__
+/*
+ * Count the time spent in the phase since start.
+ */
+static void
+RemoteCommitStatsRecord(RemoteCommitPhase phase, instr_time start)
+{
+    instr_time duration;
+    uint64     latency;
+    int        bucket = 0;
+
+    if (NULL == RemoteCommitStats)
+    {
+        return;
+    }
+
+    INSTR_TIME_SET_CURRENT(duration);
+    INSTR_TIME_SUBTRACT(duration, start);
+    latency = INSTR_TIME_GET_MICROSEC(duration);
+
+    while (bucket < REMOTE_COMMIT_LATENCY_BUCKETS - 1 &&
+           latency >= REMOTE_COMMIT_LATENCY_BUCKET_BOUND(bucket))
+    {
+        bucket++;
+    }
+    pg_atomic_fetch_add_u64(&RemoteCommitStats->count[phase][bucket], 1);
+}
+
+/*
+ * Relation cache callback: forget the routes of a changed relation.
+ */
+static void
+shard_route_invalidate(Datum arg, Oid relid)
+{
+    HASH_SEQ_STATUS status;
+    ShardRouteEnt  *route;
+
+    if (NULL == ShardRouteRels)
+    {
+        return;
+    }
+
+    if (!OidIsValid(relid))
+    {
+        hash_destroy(ShardRouteRels);
+        hash_destroy(ShardRoutes);
+        ShardRouteRels = NULL;
+        ShardRoutes = NULL;
+        return;
+    }
+
+    if (hash_search(ShardRouteRels, &relid, HASH_REMOVE, NULL) == NULL)
+    {
+        return;
+    }
+
+    hash_seq_init(&status, ShardRoutes);
+    while ((route = (ShardRouteEnt *) hash_seq_search(&status)) != NULL)
+    {
+        if (route->key.relid == relid)
+        {
+            hash_search(ShardRoutes, &route->key, HASH_REMOVE, NULL);
+        }
+    }
+}
+
+/*
+ * Find the datanode a statement on a shard table with the given distribution
+ * key value goes to. The node index is remembered per key hash, so repeated
+ * executions of a prepared point statement skip GetRelationLocInfo() and the
+ * locator. Routes are dropped when the shard map version changes or the
+ * relation is invalidated.
+ *
+ * Returns false if the relation is not a plain shard table, the caller has
+ * to go through GetRelationNodes() then.
+ */
+static bool
+shard_route_lookup(Oid relid, Datum value, int *nodeindex)
+{
+    ShardRouteRel *rel = NULL;
+    ShardRouteEnt *route;
+    ShardRouteKey  key;
+    uint32         version;
+
+    if (!enable_shard_route_cache || !IS_PGXC_COORDINATOR || !OidIsValid(relid))
+    {
+        return false;
+    }
+
+    version = GetShardMapVersion();
+    if (ShardRouteRels != NULL && version != ShardRouteVersion)
+    {
+        shard_route_invalidate((Datum) 0, InvalidOid);
+    }
+
+    if (ShardRouteRels != NULL)
+    {
+        rel = (ShardRouteRel *) hash_search(ShardRouteRels, &relid, HASH_FIND, NULL);
+    }
+
+    if (NULL == rel)
+    {
+        /*
+         * Catalog lookups may process invalidations and reset the cache, so
+         * collect everything before touching the hash tables.
+         */
+        RelationLocInfo *rel_loc_info = GetRelationLocInfo(relid);
+        ShardRouteRel    newrel;
+
+        MemSet(&newrel, 0, sizeof(newrel));
+        newrel.relid = relid;
+        if (rel_loc_info != NULL &&
+            rel_loc_info->locatorType == LOCATOR_TYPE_SHARD &&
+            !AttributeNumberIsValid(rel_loc_info->secAttrNum) &&
+            !OidIsValid(rel_loc_info->coldGroupId) &&
+            OidIsValid(rel_loc_info->groupId))
+        {
+            newrel.cacheable = true;
+            newrel.disttype = get_atttype(relid, rel_loc_info->partAttrNum);
+            newrel.groupid = rel_loc_info->groupId;
+        }
+
+        if (rel_loc_info != NULL)
+        {
+            FreeRelationLocInfo(rel_loc_info);
+        }
+
+        if (NULL == ShardRouteRels)
+        {
+            static bool callback_registered = false;
+            HASHCTL     ctl;
+
+            if (!callback_registered)
+            {
+                CacheRegisterRelcacheCallback(shard_route_invalidate, (Datum) 0);
+                callback_registered = true;
+            }
+
+            MemSet(&ctl, 0, sizeof(ctl));
+            ctl.keysize = sizeof(Oid);
+            ctl.entrysize = sizeof(ShardRouteRel);
+            ShardRouteRels = hash_create("Shard route relations", 64, &ctl,
+                                         HASH_ELEM | HASH_BLOBS);
+
+            MemSet(&ctl, 0, sizeof(ctl));
+            ctl.keysize = sizeof(ShardRouteKey);
+            ctl.entrysize = sizeof(ShardRouteEnt);
+            ShardRoutes = hash_create("Shard routes", 1024, &ctl,
+                                      HASH_ELEM | HASH_BLOBS);
+            ShardRouteVersion = version;
+        }
+
+        rel = (ShardRouteRel *) hash_search(ShardRouteRels, &relid, HASH_ENTER, NULL);
+        *rel = newrel;
+    }
+
+    if (!rel->cacheable)
+    {
+        return false;
+    }
+
+    MemSet(&key, 0, sizeof(key));
+    key.relid = relid;
+    key.hashvalue = compute_hash(rel->disttype, value, LOCATOR_TYPE_SHARD);
+
+    route = (ShardRouteEnt *) hash_search(ShardRoutes, &key, HASH_FIND, NULL);
+    if (route == NULL)
+    {
+        int index = GetNodeIndexByHashValue(rel->groupid, key.hashvalue);
+
+        /* keep memory bounded, a long tail of keys is not worth caching */
+        if (hash_get_num_entries(ShardRoutes) >= SHARD_ROUTE_CACHE_SIZE)
+        {
+            *nodeindex = index;
+            return true;
+        }
+
+        route = (ShardRouteEnt *) hash_search(ShardRoutes, &key, HASH_ENTER, NULL);
+        route->nodeindex = index;
+    }
+
+    *nodeindex = route->nodeindex;
+    return true;
+}
+
+/*
+ * Number of remote nodes with write activity in the current transaction.
+ */
+static int
+pgxc_count_remote_writers(void)
+{
+    PGXCNodeAllHandles *handles = get_current_txn_handles();
+    int                 writers = 0;
+    int                 i;
+
+    for (i = 0; i < handles->dn_conn_count; i++)
+    {
+        PGXCNodeHandle *conn = handles->datanode_handles[i];
+
+        if (conn->sock != NO_SOCKET && !conn->read_only &&
+            conn->transaction_status == 'T')
+        {
+            writers++;
+        }
+    }
+    for (i = 0; i < handles->co_conn_count; i++)
+    {
+        PGXCNodeHandle *conn = handles->coord_handles[i];
+
+        if (conn->sock != NO_SOCKET && !conn->read_only &&
+            conn->transaction_status == 'T')
+        {
+            writers++;
+        }
+    }
+    pfree_pgxc_all_handles(handles);
+
+    return writers;
+}
+
+/*
+ * Count a write transaction committed by this coordinator.
+ */
+static void
+RemoteCommitStatsCount(bool two_phase)
+{
+    if (NULL == RemoteCommitStats)
+    {
+        return;
+    }
+
+    if (two_phase)
+    {
+        pg_atomic_fetch_add_u64(&RemoteCommitStats->two_phase_commits, 1);
+    }
+    else
+    {
+        pg_atomic_fetch_add_u64(&RemoteCommitStats->one_phase_commits, 1);
+    }
+}
+
+Size
+RemoteCommitStatsShmemSize(void)
+{
+    return sizeof(RemoteCommitStatsData);
+}
+
+void
+RemoteCommitStatsShmemInit(void)
+{
+    bool found;
+    int  phase;
+    int  bucket;
+
+    RemoteCommitStats = (RemoteCommitStatsData *)
+        ShmemInitStruct("Remote commit statistics", RemoteCommitStatsShmemSize(), &found);
+
+    if (!found)
+    {
+        for (phase = 0; phase < REMOTE_COMMIT_PHASES; phase++)
+        {
+            for (bucket = 0; bucket < REMOTE_COMMIT_LATENCY_BUCKETS; bucket++)
+            {
+                pg_atomic_init_u64(&RemoteCommitStats->count[phase][bucket], 0);
+            }
+        }
+        pg_atomic_init_u64(&RemoteCommitStats->one_phase_commits, 0);
+        pg_atomic_init_u64(&RemoteCommitStats->two_phase_commits, 0);
+        pg_atomic_init_u64(&RemoteCommitStats->dml_batched_rows, 0);
+        pg_atomic_init_u64(&RemoteCommitStats->dml_round_trips_saved, 0);
+    }
+}
+
+/*
+ * pg_stat_get_remote_commit_latency - latency histogram of the commit phases
+ * of the transactions coordinated by this node.  One row per phase and
+ * bucket, le_us is the exclusive upper bound of the bucket, NULL for the last.
+ */
+Datum
+pg_stat_get_remote_commit_latency(PG_FUNCTION_ARGS)
+{
+#define REMOTE_COMMIT_STAT_COLUMNS 3
+    FuncCallContext *funcctx;
+    int              call;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        TupleDesc     tupdesc;
+        MemoryContext oldcontext;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        /* this had better match function's declaration in pg_proc.h */
+        tupdesc = CreateTemplateTupleDesc(REMOTE_COMMIT_STAT_COLUMNS, false);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 1, "phase",
+                           TEXTOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 2, "le_us",
+                           INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 3, "count",
+                           INT8OID, -1, 0);
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+        funcctx->max_calls = RemoteCommitStats ?
+            REMOTE_COMMIT_PHASES * REMOTE_COMMIT_LATENCY_BUCKETS : 0;
+
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    call = funcctx->call_cntr;
+
+    if (call < funcctx->max_calls)
+    {
+        Datum     values[REMOTE_COMMIT_STAT_COLUMNS];
+        bool      nulls[REMOTE_COMMIT_STAT_COLUMNS];
+        HeapTuple tuple;
+        int       phase  = call / REMOTE_COMMIT_LATENCY_BUCKETS;
+        int       bucket = call % REMOTE_COMMIT_LATENCY_BUCKETS;
+
+        MemSet(values, 0, sizeof(values));
+        MemSet(nulls, 0, sizeof(nulls));
+
+        values[0] = CStringGetTextDatum(RemoteCommitPhaseNames[phase]);
+        if (bucket < REMOTE_COMMIT_LATENCY_BUCKETS - 1)
+        {
+            values[1] = Int64GetDatum(REMOTE_COMMIT_LATENCY_BUCKET_BOUND(bucket));
+        }
+        else
+        {
+            nulls[1] = true;
+        }
+        values[2] = Int64GetDatum(pg_atomic_read_u64(&RemoteCommitStats->count[phase][bucket]));
+
+        tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+    }
+
+    SRF_RETURN_DONE(funcctx);
+}
+
+/*
+ * pg_stat_get_remote_commit_counts - write transactions coordinated by this
+ * node committed in one phase and with implicit two-phase commit.
+ */
+Datum
+pg_stat_get_remote_commit_counts(PG_FUNCTION_ARGS)
+{
+#define REMOTE_COMMIT_COUNT_COLUMNS 2
+    TupleDesc   tupdesc;
+    Datum       values[REMOTE_COMMIT_COUNT_COLUMNS];
+    bool        nulls[REMOTE_COMMIT_COUNT_COLUMNS];
+
+    /* this had better match function's declaration in pg_proc.h */
+    tupdesc = CreateTemplateTupleDesc(REMOTE_COMMIT_COUNT_COLUMNS, false);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 1, "one_phase",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 2, "two_phase",
+                       INT8OID, -1, 0);
+    BlessTupleDesc(tupdesc);
+    MemSet(values, 0, sizeof(values));
+    MemSet(nulls, false, sizeof(nulls));
+
+    if (RemoteCommitStats)
+    {
+        values[0] = Int64GetDatum(pg_atomic_read_u64(&RemoteCommitStats->one_phase_commits));
+        values[1] = Int64GetDatum(pg_atomic_read_u64(&RemoteCommitStats->two_phase_commits));
+    }
+    else
+    {
+        values[0] = Int64GetDatum(0);
+        values[1] = Int64GetDatum(0);
+    }
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+/*
+ * pg_stat_get_remote_dml_batch_counts - rows of coordinator side INSERTs
+ * sent to the datanodes in batches, and the waits for a datanode that saved.
+ */
+Datum
+pg_stat_get_remote_dml_batch_counts(PG_FUNCTION_ARGS)
+{
+#define REMOTE_DML_BATCH_COLUMNS 2
+    TupleDesc   tupdesc;
+    Datum       values[REMOTE_DML_BATCH_COLUMNS];
+    bool        nulls[REMOTE_DML_BATCH_COLUMNS];
+
+    /* this had better match function's declaration in pg_proc.h */
+    tupdesc = CreateTemplateTupleDesc(REMOTE_DML_BATCH_COLUMNS, false);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 1, "batched_rows",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 2, "round_trips_saved",
+                       INT8OID, -1, 0);
+    BlessTupleDesc(tupdesc);
+    MemSet(values, 0, sizeof(values));
+    MemSet(nulls, false, sizeof(nulls));
+
+    if (RemoteCommitStats)
+    {
+        values[0] = Int64GetDatum(pg_atomic_read_u64(&RemoteCommitStats->dml_batched_rows));
+        values[1] = Int64GetDatum(pg_atomic_read_u64(&RemoteCommitStats->dml_round_trips_saved));
+    }
+    else
+    {
+        values[0] = Int64GetDatum(0);
+        values[1] = Int64GetDatum(0);
+    }
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+#endif
@@ -43,6 +43,7 @@
 #include "gtm/gtm_c.h"
 #include "nodes/nodes.h"
 #include "pgxc/pgxcnode.h"
+#include "pgxc/squeue.h"
 #include "pgxc/execRemote.h"
 #include "catalog/pgxc_node.h"
 #include "catalog/pg_collation.h"
@@ -154,6 +155,9 @@ static bool DoRefreshRemoteHandles(void);
 #ifdef XCP
 static void pgxc_node_init(PGXCNodeHandle *handle, int sock,
 		bool global_session, int pid);
+#ifdef __OPENTENBASE__
+static void pgxc_node_init_finish(PGXCNodeHandle *handle);
+#endif
 #else
 static void pgxc_node_init(PGXCNodeHandle *handle, int sock);
 #endif
@@ -717,7 +721,18 @@ pgxc_node_init(PGXCNodeHandle *handle, int sock, bool global_session, int pid)
         init_str = PGXCNodeGetSessionParamStr();
 		if (init_str)
         {
+#ifdef __OPENTENBASE__
+			/*
+			 * The response is read by pgxc_node_init_finish(), once the
+			 * parameters are sent to all the new connections.
+			 */
+			if (pgxc_node_send_query(handle, init_str) != 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_INTERNAL_ERROR),
+						 errmsg("Failed to send query %s", init_str)));
+#else
 			pgxc_node_set_query(handle, init_str);
+#endif
         }
     }
 
@@ -762,6 +777,20 @@ pgxc_node_init(PGXCNodeHandle *handle, int sock, bool global_session, int pid)
 #endif    
 }
 
+#ifdef __OPENTENBASE__
+/*
+ * Read the response to the session parameters pgxc_node_init() sent down.
+ * Callers initialize all their new connections before calling this, so the
+ * round trips to the nodes overlap instead of adding up.
+ */
+static void
+pgxc_node_init_finish(PGXCNodeHandle *handle)
+{
+    if (handle->sock != NO_SOCKET && handle->state == DN_CONNECTION_STATE_QUERY)
+        pgxc_node_set_query_finish(handle);
+}
+#endif
+
 /*
  * Wait while at least one of specified connections has data available and read
  * the data into the buffer
@@ -1402,6 +1431,72 @@ get_message(PGXCNodeHandle *conn, int *len, char **msg)
 }
 
 
+#ifdef __OPENTENBASE__
+/*
+ * expand_compressed_message
+ * Replace the compressed redistribution frame just returned by get_message()
+ * with the messages it carries, so that they are read next.  msg and len are
+ * as returned by get_message().  Returns EOF if the frame is corrupted.
+ */
+int
+expand_compressed_message(PGXCNodeHandle *conn, char *msg, int len)
+{
+    size_t  frame_start;
+    size_t  rest_start;
+    size_t  rest_len;
+    int32   raw_len;
+    uint32  n32;
+    char   *zdata;
+    int32   zlen;
+
+    if (len < SQUEUE_COMPRESSED_HDRSZ - 5 || msg[0] != SQUEUE_CODEC_LZ)
+    {
+        add_error_message(conn, "invalid compressed data frame");
+        return EOF;
+    }
+
+    memcpy(&n32, msg + 1, sizeof(n32));
+    raw_len = (int32) ntohl(n32);
+    if (raw_len <= 0 || raw_len >= (MaxAllocSize >> 1))
+    {
+        add_error_message(conn, "invalid compressed data frame");
+        return EOF;
+    }
+
+    /* Save the compressed data, the buffer is rearranged below. */
+    zlen  = len - (SQUEUE_COMPRESSED_HDRSZ - 5);
+    zdata = palloc(zlen);
+    memcpy(zdata, msg + SQUEUE_COMPRESSED_HDRSZ - 5, zlen);
+
+    frame_start = (msg - conn->inBuffer) - 5;
+    rest_start  = conn->inCursor;
+    rest_len    = conn->inEnd - rest_start;
+
+    if (ensure_in_buffer_capacity(frame_start + raw_len + rest_len, conn) != 0)
+    {
+        pfree(zdata);
+        add_error_message(conn, "out of memory");
+        return EOF;
+    }
+
+    memmove(conn->inBuffer + frame_start + raw_len,
+            conn->inBuffer + rest_start, rest_len);
+    if (SqueueDecompressData(zdata, zlen,
+                             conn->inBuffer + frame_start, raw_len) != raw_len)
+    {
+        pfree(zdata);
+        add_error_message(conn, "invalid compressed data frame");
+        return EOF;
+    }
+    pfree(zdata);
+
+    conn->inStart  = frame_start;
+    conn->inCursor = frame_start;
+    conn->inEnd    = frame_start + raw_len + rest_len;
+    return 0;
+}
+#endif
+
 /*
  * Release all Datanode and Coordinator connections
  * back to pool and release occupied memory.
@@ -2482,6 +2577,43 @@ pgxc_node_send_execute(PGXCNodeHandle * handle, const char *portal, int fetch)
 }
 
 
+#ifdef __OPENTENBASE__
+/*
+ * Send a runtime filter for the portal down to the Datanode.  The body is
+ * everything after the portal name, see squeue.h.
+ */
+int
+pgxc_node_send_runtime_filter(PGXCNodeHandle *handle, const char *portal,
+                              const char *body, int bodylen)
+{
+    int            pnameLen = strlen(portal) + 1;
+
+    /* size + pnameLen + body */
+    int            msgLen = 4 + pnameLen + bodylen;
+
+    /* msgType + msgLen */
+    if (ensure_out_buffer_capacity(handle->outEnd + 1 + msgLen, handle) != 0)
+    {
+        add_error_message(handle, "out of memory");
+        return EOF;
+    }
+
+    handle->outBuffer[handle->outEnd++] = SQUEUE_RUNTIME_FILTER_MSG;
+    /* size */
+    msgLen = htonl(msgLen);
+    memcpy(handle->outBuffer + handle->outEnd, &msgLen, 4);
+    handle->outEnd += 4;
+    /* portal name */
+    memcpy(handle->outBuffer + handle->outEnd, portal, pnameLen);
+    handle->outEnd += pnameLen;
+    /* filter */
+    memcpy(handle->outBuffer + handle->outEnd, body, bodylen);
+    handle->outEnd += bodylen;
+
+    return 0;
+}
+#endif
+
 /*
  * Send FLUSH message down to the Datanode
  */
@@ -2686,6 +2818,29 @@ pgxc_node_flush(PGXCNodeHandle *handle)
     return 0;
 }
 
+/*
+ * Flush the output buffers of all the connections, so that every node has got
+ * its command before we start waiting for the responses.  Connections that
+ * can not be flushed are marked fatal, thus no response is waited for on
+ * them.  Returns the number of such connections.
+ */
+int
+pgxc_node_flush_all(PGXCNodeHandle **connections, int count)
+{
+    int i;
+    int nfailed = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if (pgxc_node_flush(connections[i]))
+        {
+            PGXCNodeSetConnectionState(connections[i], DN_CONNECTION_STATE_ERROR_FATAL);
+            nfailed++;
+        }
+    }
+    return nfailed;
+}
+
 /*
  * This method won't return until network buffer is empty or error occurs
  * To ensure all data in network buffers is read and wasted
@@ -2765,7 +2920,7 @@ pgxc_node_flush_read(PGXCNodeHandle *handle)
  */
 static int
 pgxc_node_send_query_internal(PGXCNodeHandle * handle, const char *query,
-        bool rollback)
+        bool rollback, bool flush)
 {
     int            strLen;
     int            msgLen;
@@ -2806,6 +2961,10 @@ pgxc_node_send_query_internal(PGXCNodeHandle * handle, const char *query,
     PGXCNodeSetConnectionState(handle, DN_CONNECTION_STATE_QUERY);
 
     handle->in_extended_query = false;
+    if (!flush)
+    {
+        return 0;
+    }
      return pgxc_node_flush(handle);
 }
 
@@ -2818,7 +2977,7 @@ pgxc_node_send_rollback(PGXCNodeHandle *handle, const char *query)
         capacity_stack = SEND_ROLLBACK;
     }
 #endif
-    return pgxc_node_send_query_internal(handle, query, true);
+    return pgxc_node_send_query_internal(handle, query, true, true);
 }
 
 int
@@ -2833,7 +2992,27 @@ pgxc_node_send_query(PGXCNodeHandle *handle, const char *query)
         capacity_stack = SEND_QUERY;
     }
 #endif
-    return pgxc_node_send_query_internal(handle, query, false);
+    return pgxc_node_send_query_internal(handle, query, false, true);
+}
+
+/*
+ * Put the query into the output buffer of the connection without sending it,
+ * so that the commands of all the nodes can be queued first and sent together
+ * by pgxc_node_flush_all().
+ */
+int
+pgxc_node_send_query_noflush(PGXCNodeHandle *handle, const char *query)
+{
+#ifdef __TWO_PHASE_TESTS__
+     if ((IN_REMOTE_PREPARE == twophase_in && !handle->read_only) ||
+        IN_PREPARE_ERROR == twophase_in ||
+        IN_REMOTE_FINISH == twophase_in ||
+        IN_PG_CLEAN == twophase_in)
+    {
+        capacity_stack = SEND_QUERY;
+    }
+#endif
+    return pgxc_node_send_query_internal(handle, query, false, false);
 }
 
 /*
@@ -3791,6 +3970,9 @@ get_any_handle(List *datanodelist)
                     
                     node_handle = &dn_handles[node];
 					pgxc_node_init(node_handle, fds[0], true, pids[0]);
+#ifdef __OPENTENBASE__
+					pgxc_node_init_finish(node_handle);
+#endif
                     datanode_count++;
 
                     elog(DEBUG1, "Established a connection with datanode \"%s\","
@@ -4151,6 +4333,14 @@ get_handles(List *datanodelist, List *coordlist, bool is_coord_only_query, bool
 
         pfree(fds);
 
+#ifdef __OPENTENBASE__
+        /* Now wait for all the new connections to apply the parameters */
+        foreach(node_list_item, dn_allocate)
+            pgxc_node_init_finish(&dn_handles[lfirst_int(node_list_item)]);
+        foreach(node_list_item, co_allocate)
+            pgxc_node_init_finish(&co_handles[lfirst_int(node_list_item)]);
+#endif
+
         if (co_allocate)
             list_free(co_allocate);
         if (dn_allocate)
@@ -5166,6 +5356,17 @@ pgxc_node_set_query(PGXCNodeHandle *handle, const char *set_query)
 				(errcode(ERRCODE_INTERNAL_ERROR),
 						errmsg("Failed to send query %s",set_query)));
 	}
+#ifdef __OPENTENBASE__
+	pgxc_node_set_query_finish(handle);
+}
+
+/*
+ * Read the response to a SET query sent with pgxc_node_send_query().
+ */
+void
+pgxc_node_set_query_finish(PGXCNodeHandle *handle)
+{
+#endif
     /*
      * Now read responses until ReadyForQuery.
      * XXX We may need to handle possible errors here.
@@ -39,6 +39,7 @@
 #include "postgres.h"
 #include <poll.h>
 #include <signal.h>
+#include <sys/epoll.h>
 #include "libpq/pqsignal.h"
 #include "miscadmin.h"
 #include "access/xact.h"
@@ -96,6 +97,7 @@ int         PoolCheckSlotTimeout   = -1;   /* Pooler check slot. One slot can on
 int         PoolPrintStatTimeout   = -1;
     
 bool        PersistentConnections    = false;
+bool        enable_session_multiplexing = false;
 char        *g_PoolerWarmBufferInfo  = "postgres:postgres";
 
 char        *g_unpooled_database     = "template1";
@@ -528,6 +530,9 @@ static void destroy_slot_ex(int32 nodeidx, Oid node, PGXCNodePoolSlot *slot, boo
 static void close_slot(int32 nodeidx, Oid node, PGXCNodePoolSlot *slot);
 
 static PGXCNodePool *grow_pool(DatabasePool *dbPool, int32 nodeidx, Oid node, bool bCoord);
+static PGXCNodePool *lookup_node_pool(DatabasePool *dbPool, int32 nodeidx, Oid node, bool bCoord);
+static void remember_node_pool(DatabasePool *dbPool, int32 nodeidx, bool bCoord, PGXCNodePool *nodePool);
+static void forget_node_pool(DatabasePool *dbPool, PGXCNodePool *nodePool);
 static void destroy_node_pool(PGXCNodePool *node_pool);
 static void destroy_node_pool_free_slots(PGXCNodePool *node_pool);
 
@@ -575,6 +580,7 @@ static void  *pooler_async_utility_thread(void *arg);
 static void  *pooler_async_connection_management_thread(void *arg);
 static void  *pooler_sync_remote_operator_thread(void *arg);
 
+static void   pooler_async_connect_batch(PGXCPoolConnectReq *request);
 static bool   pooler_async_build_connection(DatabasePool *pool, int64 pool_version, int32 nodeidx, Oid node, 
                                             int32 size, char *connStr, bool bCoord);
 static BitmapMgr *BmpMgrCreate(uint32 objnum);
@@ -2237,9 +2243,12 @@ agent_handle_input(PoolAgent * agent, StringInfo s)
                 pool_getmessage(&agent->port, s, 4);
                 pq_getmsgend(s);
 
-                /* Ping all the pools */
-                // TODO: task should done in thread.
-                PoolPingNodes();
+                /*
+                 * Ping all the pools.  The pings run on the utility thread,
+                 * which updates the health map when a node answers, so a
+                 * dead host does not stall the pooler loop.
+                 */
+                PoolAsyncPingNodes();
                 break;
                 
             case 'q':            /* Check connection info consistency */
@@ -4429,6 +4438,12 @@ create_database_pool(const char *database, const char *user_name, const char *pg
     databasePool->bneed_precreate = false;
     databasePool->bneed_pool       = need_pool;
     databasePool->version         = 0;
+
+    /* Node pool arrays are sized on first use */
+    databasePool->dnNodePools  = NULL;
+    databasePool->cnNodePools  = NULL;
+    databasePool->ndnNodePools = 0;
+    databasePool->ncnNodePools = 0;
     return databasePool;
 }
 
@@ -4517,6 +4532,7 @@ reload_database_pools(PoolAgent *agent)
 						nodePool->size, nodePool->freeSize,
 						nodePool->nodeoid, nodePool->node_name);
                     destroy_node_pool(nodePool);
+                    forget_node_pool(databasePool, nodePool);
                     hash_search(databasePool->nodePools, &nodePool->nodeoid,
                                 HASH_REMOVE, NULL);
                 }
@@ -4593,8 +4609,7 @@ acquire_connection(DatabasePool *dbPool, PGXCNodePool **pool,int32 nodeidx, Oid
 
     Assert(dbPool);
 
-    nodePool = (PGXCNodePool *) hash_search(dbPool->nodePools, &node, HASH_FIND,
-                                            NULL);
+    nodePool = lookup_node_pool(dbPool, nodeidx, node, bCoord);
 
     /*
      * When a Coordinator pool is initialized by a Coordinator Postmaster,
@@ -4736,8 +4751,7 @@ release_connection(DatabasePool *dbPool, PGXCNodePoolSlot *slot,
     Assert(dbPool);
     Assert(slot);
 
-    nodePool = (PGXCNodePool *) hash_search(dbPool->nodePools, &node, HASH_FIND,
-                                            NULL);
+    nodePool = lookup_node_pool(dbPool, nodeidx, node, bCoord);
 	/*
 	 * The node pool of connections may has been created just now and the size is
 	 * initialized to 0. This situation needs to be excluded.
@@ -4955,8 +4969,16 @@ grow_pool(DatabasePool *dbPool, int32 nodeidx, Oid node, bool bCoord)
 
     Assert(dbPool);
     
-    nodePool = (PGXCNodePool *) hash_search(dbPool->nodePools, &node,
-                                            HASH_ENTER, &found);    
+    /* Pools are looked up on every acquire, try the index first */
+    nodePool = lookup_node_pool(dbPool, nodeidx, node, bCoord);
+    found = (nodePool != NULL);
+    if (!found)
+    {
+        nodePool = (PGXCNodePool *) hash_search(dbPool->nodePools, &node,
+                                                HASH_ENTER, &found);
+        Assert(!found);
+        remember_node_pool(dbPool, nodeidx, bCoord, nodePool);
+    }
     
     if (!found)
     {
@@ -4985,6 +5007,7 @@ grow_pool(DatabasePool *dbPool, int32 nodeidx, Oid node, bool bCoord)
         nodePool->coord      = bCoord;        
         nodePool->nwarming   = 0;
         nodePool->nquery     = 0;
+        nodePool->nbuilding  = 0;
 
         name_str = get_node_name_by_nodeoid(node);
         if (NULL == name_str)
@@ -5024,6 +5047,7 @@ grow_pool(DatabasePool *dbPool, int32 nodeidx, Oid node, bool bCoord)
     				if (pooler_async_build_connection(dbPool, nodePool->m_version, nodeidx, node, size, nodePool->connstr, bCoord))
 					{
     					nodePool->asyncInProgress = true;
+    					nodePool->nbuilding = size;
 					}
                 }
             }
@@ -5041,6 +5065,99 @@ grow_pool(DatabasePool *dbPool, int32 nodeidx, Oid node, bool bCoord)
 }
 
 
+/*
+ * Find the pool of the node in the database pool.
+ *
+ * Every acquire and release looks the pool up, so the entries of the
+ * nodePools hash are also kept in arrays indexed by the node index of the
+ * agent.  The node index of a node may change when the node map is
+ * refreshed, thus the cached entry is only used when it is still for the
+ * node asked for, otherwise the hash is searched and the array refreshed.
+ */
+static PGXCNodePool *
+lookup_node_pool(DatabasePool *dbPool, int32 nodeidx, Oid node, bool bCoord)
+{
+    PGXCNodePool  *nodePool = NULL;
+    PGXCNodePool **nodePools = bCoord ? dbPool->cnNodePools : dbPool->dnNodePools;
+    int32          nnodePools = bCoord ? dbPool->ncnNodePools : dbPool->ndnNodePools;
+
+    if (nodeidx >= 0 && nodeidx < nnodePools)
+    {
+        nodePool = nodePools[nodeidx];
+        if (nodePool && nodePool->nodeoid == node)
+        {
+            return nodePool;
+        }
+    }
+
+    nodePool = (PGXCNodePool *) hash_search(dbPool->nodePools, &node, HASH_FIND, NULL);
+    if (nodePool)
+    {
+        remember_node_pool(dbPool, nodeidx, bCoord, nodePool);
+    }
+    return nodePool;
+}
+
+/*
+ * Remember the pool of the node at its node index.
+ */
+static void
+remember_node_pool(DatabasePool *dbPool, int32 nodeidx, bool bCoord, PGXCNodePool *nodePool)
+{
+    PGXCNodePool ***nodePools = bCoord ? &dbPool->cnNodePools : &dbPool->dnNodePools;
+    int32          *nnodePools = bCoord ? &dbPool->ncnNodePools : &dbPool->ndnNodePools;
+
+    if (nodeidx < 0)
+    {
+        return;
+    }
+
+    if (nodeidx >= *nnodePools)
+    {
+        int32 newsize = bCoord ? OPENTENBASE_MAX_COORDINATOR_NUMBER : OPENTENBASE_MAX_DATANODE_NUMBER;
+
+        newsize = Max(newsize, nodeidx + 1);
+        if (NULL == *nodePools)
+        {
+            *nodePools = (PGXCNodePool **) MemoryContextAllocZero(dbPool->mcxt,
+                                                                  newsize * sizeof(PGXCNodePool *));
+        }
+        else
+        {
+            *nodePools = (PGXCNodePool **) repalloc(*nodePools, newsize * sizeof(PGXCNodePool *));
+            memset(*nodePools + *nnodePools, 0, (newsize - *nnodePools) * sizeof(PGXCNodePool *));
+        }
+        *nnodePools = newsize;
+    }
+    (*nodePools)[nodeidx] = nodePool;
+}
+
+/*
+ * Drop all references to the pool, must be called before the pool is removed
+ * from the nodePools hash.
+ */
+static void
+forget_node_pool(DatabasePool *dbPool, PGXCNodePool *nodePool)
+{
+    int32 i;
+
+    for (i = 0; i < dbPool->ndnNodePools; i++)
+    {
+        if (dbPool->dnNodePools[i] == nodePool)
+        {
+            dbPool->dnNodePools[i] = NULL;
+        }
+    }
+
+    for (i = 0; i < dbPool->ncnNodePools; i++)
+    {
+        if (dbPool->cnNodePools[i] == nodePool)
+        {
+            dbPool->cnNodePools[i] = NULL;
+        }
+    }
+}
+
 /*
  * Destroy pool slot, including slot itself.
  */
@@ -6085,6 +6202,7 @@ shrink_pool(DatabasePool *pool)
 					nodePool->nodeoid, nodePool->node_name);
 			}
             destroy_node_pool(nodePool);
+            forget_node_pool(pool, nodePool);
             hash_search(pool->nodePools, &nodePool->nodeoid, HASH_REMOVE, NULL);
         }
     }
@@ -6770,6 +6888,7 @@ static void pooler_sync_connections_to_nodepool(void)
                     nodePool->coord      = false; /* in this case, only datanode */
                     nodePool->nwarming   = 0;
                     nodePool->nquery     = 0;
+                    nodePool->nbuilding  = 0;
 					nodePool->m_version = asyncInfo->dbPool->version++;
 
                     name_str = get_node_name_by_nodeoid(asyncInfo->node);
@@ -6932,6 +7051,7 @@ static void pooler_sync_connections_to_nodepool(void)
                         nodePool->coord      = connRsp->bCoord; 
                         nodePool->nwarming   = 0;
                         nodePool->nquery     = 0;
+                        nodePool->nbuilding  = 0;
 
                         name_str = get_node_name_by_nodeoid(connRsp->nodeoid);
                         if (NULL == name_str)
@@ -7005,6 +7125,7 @@ static void pooler_sync_connections_to_nodepool(void)
                                     
                     }
                     nodePool->asyncInProgress = false;
+                    nodePool->nbuilding = 0;
 
                     if (PoolConnectDebugPrint)
                     {
@@ -7541,6 +7662,7 @@ preconnect_and_warm(DatabasePool *dbPool)
             nodePool->coord    = false;
             nodePool->nwarming   = 0;
             nodePool->nquery     = 0;
+            nodePool->nbuilding  = 0;
 
             name_str = get_node_name_by_nodeoid(dnOids[i]);
             if (NULL == name_str)
@@ -7682,19 +7804,10 @@ void *pooler_async_connection_management_thread(void *arg)
 			{
 				case COMMAND_CONNECTION_BUILD:
 				{
-					for (i = 0; i < request->size; i++, request->validSize++)
+					pooler_async_connect_batch(request);
+					for (i = 0; i < request->validSize; i++)
 					{			
 						slot =  &request->slot[i]; 
-						/* If connection fails, be sure that slot is destroyed cleanly */
-						slot->xc_cancelConn = NULL;
-
-						/* Establish connection */
-						slot->conn = PGXCNodeConnectBarely(request->connstr);
-						if (!PGXCNodeConnected(slot->conn))
-						{		
-							request->failed = true;
-							break;
-						}		
 						slot->xc_cancelConn = (NODE_CANCEL *) PQgetCancel((PGconn *)slot->conn);
 						slot->bwarmed       = false;
 						SetSockKeepAlive(((PGconn *)slot->conn)->sock);
@@ -7731,6 +7844,175 @@ void *pooler_async_connection_management_thread(void *arg)
 }
 
 
+/*
+ * Establish all the connections of a build request at once.
+ *
+ * Every connection is started with PQconnectStart() and then driven by
+ * PQconnectPoll() whenever its socket is ready, all of them waiting in one
+ * epoll set.  A batch thus costs about one connection setup rather than
+ * request->size of them, which is what refilling the pools after a node
+ * failover is bound by.  The whole batch is given pooler_connect_timeout
+ * seconds.
+ *
+ * The established connections are moved to the front of the slot array and
+ * counted in validSize.  If some failed, request->failed is set and the
+ * first failed connection is left right after the valid ones, so that the
+ * main thread can report its error; the other failed ones are closed here.
+ */
+static void
+pooler_async_connect_batch(PGXCPoolConnectReq *request)
+{// #lizard forgives
+	int32				size = request->size;
+	int32				pending = 0;
+	int32				i;
+	int32				j;
+	int				   *socks;
+	bool			   *ok;
+	struct epoll_event *events;
+	int					epfd;
+	time_t				deadline;
+
+	for (i = 0; i < size; i++)
+	{
+		/* If connection fails, be sure that slot is destroyed cleanly */
+		request->slot[i].conn = NULL;
+		request->slot[i].xc_cancelConn = NULL;
+	}
+
+	socks = (int *) malloc(size * sizeof(int));
+	ok = (bool *) calloc(size, sizeof(bool));
+	events = (struct epoll_event *) malloc(size * sizeof(struct epoll_event));
+	epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (!socks || !ok || !events || epfd < 0)
+	{
+		pooler_thread_logger(LOG, "could not set up connection build for node:%u, errno %d",
+							 request->nodeoid, errno);
+		if (epfd >= 0)
+			close(epfd);
+		free(socks);
+		free(ok);
+		free(events);
+		request->validSize = 0;
+		request->failed = true;
+		return;
+	}
+
+	for (i = 0; i < size; i++)
+	{
+		PGconn	   *conn = PQconnectStart(request->connstr);
+		struct epoll_event ev;
+
+		request->slot[i].conn = (NODE_CONNECTION *) conn;
+		socks[i] = conn ? PQsocket(conn) : PGINVALID_SOCKET;
+		if (conn == NULL || PQstatus(conn) == CONNECTION_BAD ||
+			socks[i] == PGINVALID_SOCKET)
+			continue;
+
+		/* a fresh connection first waits for connect() to complete */
+		ev.events = EPOLLOUT;
+		ev.data.u32 = i;
+		if (epoll_ctl(epfd, EPOLL_CTL_ADD, socks[i], &ev) == 0)
+			pending++;
+	}
+
+	deadline = time(NULL) + PoolConnectTimeOut;
+	while (pending > 0)
+	{
+		time_t	now = time(NULL);
+		int		nevents;
+		int		k;
+
+		if (now >= deadline)
+		{
+			pooler_thread_logger(LOG, "connection build for node:%u timed out with %d of %d connections pending",
+								 request->nodeoid, pending, size);
+			break;
+		}
+
+		nevents = epoll_wait(epfd, events, size, (deadline - now) * 1000);
+		if (nevents < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			pooler_thread_logger(LOG, "epoll_wait failed during connection build for node:%u, errno %d",
+								 request->nodeoid, errno);
+			break;
+		}
+
+		for (k = 0; k < nevents; k++)
+		{
+			PGconn	   *conn;
+			PostgresPollingStatusType status;
+			struct epoll_event ev;
+
+			i = events[k].data.u32;
+			conn = (PGconn *) request->slot[i].conn;
+			status = PQconnectPoll(conn);
+
+			if (status == PGRES_POLLING_OK || status == PGRES_POLLING_FAILED)
+			{
+				epoll_ctl(epfd, EPOLL_CTL_DEL, socks[i], NULL);
+				ok[i] = (status == PGRES_POLLING_OK);
+				pending--;
+				continue;
+			}
+
+			ev.events = (status == PGRES_POLLING_READING) ? EPOLLIN : EPOLLOUT;
+			ev.data.u32 = i;
+
+			/* libpq opens a new socket when it moves on to the next address */
+			if (PQsocket(conn) != socks[i])
+			{
+				epoll_ctl(epfd, EPOLL_CTL_DEL, socks[i], NULL);
+				socks[i] = PQsocket(conn);
+				if (epoll_ctl(epfd, EPOLL_CTL_ADD, socks[i], &ev) == 0)
+					continue;
+			}
+			else if (epoll_ctl(epfd, EPOLL_CTL_MOD, socks[i], &ev) == 0)
+				continue;
+
+			pending--;
+		}
+	}
+	close(epfd);
+
+	/* move the established connections to the front */
+	for (i = 0, j = 0; i < size; i++)
+	{
+		if (ok[i])
+		{
+			if (i != j)
+			{
+				PGXCNodePoolSlot tmp = request->slot[j];
+
+				request->slot[j] = request->slot[i];
+				request->slot[i] = tmp;
+				ok[i] = ok[j];
+				ok[j] = true;
+			}
+			j++;
+		}
+	}
+	request->validSize = j;
+
+	if (j < size)
+	{
+		request->failed = true;
+
+		/* keep the first failed connection for the error report */
+		for (i = j + 1; i < size; i++)
+		{
+			PGXCNodeClose(request->slot[i].conn);
+			request->slot[i].conn = NULL;
+		}
+	}
+
+	free(socks);
+	free(ok);
+	free(events);
+}
+
+
 /*
  * Thread that will handle sync network operation
  */
@@ -8578,8 +8860,9 @@ void *pooler_async_utility_thread(void *arg)
                 case COMMAND_PING_NODE:
                 {
                     char connstr[MAXPGPATH * 2 + 256] = {0};
-                    sprintf(connstr, "host=%s port=%d", NameStr(pWarmInfo->nodehost),
-                                    pWarmInfo->nodeport);
+                    /* do not let a dead host hold up the warm requests queued behind */
+                    sprintf(connstr, "host=%s port=%d connect_timeout=%d", NameStr(pWarmInfo->nodehost),
+                                    pWarmInfo->nodeport, PoolConnectTimeOut);
                     pWarmInfo->nodestatus = PGXCNodePing(connstr);
                 }
                 break;
@@ -10318,8 +10601,8 @@ TryPingUnhealthyNode(Oid nodeoid)
     elog(LOG, "node (%s:%u) down! Trying ping",
          NameStr(nodeDef->nodename), nodeoid);
     sprintf(connstr,
-            "host=%s port=%d", NameStr(nodeDef->nodehost),
-            nodeDef->nodeport);
+            "host=%s port=%d connect_timeout=%d", NameStr(nodeDef->nodehost),
+            nodeDef->nodeport, PoolConnectTimeOut);
     status = PGXCNodePing(connstr);
     if (status != 0)
     {
@@ -11081,6 +11364,7 @@ refresh_database_pools(PoolAgent *agent)
 						nodePool->size, nodePool->freeSize,
 						connstr_chk, nodePool->connstr);
                 destroy_node_pool(nodePool);
+                forget_node_pool(databasePool, nodePool);
                 hash_search(databasePool->nodePools, &nodePool->nodeoid,
                             HASH_REMOVE, NULL);
             }
@@ -11626,6 +11910,7 @@ handle_get_conn_statistics(PoolAgent *agent)
 
             pq_sendint(&buf, exceed_keepalive_cnt, sizeof(uint32));
             pq_sendint(&buf, exceed_maxlifetime_cnt, sizeof(uint32));
+            pq_sendint(&buf, node_pool->nbuilding, sizeof(uint32));
         }
 
 
@@ -95,6 +95,7 @@ typedef struct
 {
     bool           inited;
     bool           needLock;                      /* whether we need lock */
+    pg_atomic_uint32 version;                     /* bumped whenever the map changes */
     slock_t           lock[MAX_SHARDING_NODE_GROUP]; /* locks to protect used fields */
     bool            used[MAX_SHARDING_NODE_GROUP];
 
@@ -326,6 +327,7 @@ void InvalidateShmemShardMap(bool iscommit)
                         RemoveShardMapEntry(g_UpdateShardingGroupInfo.group[i]);
                     }                    
                 }
+                pg_atomic_fetch_add_u32(&g_GroupShardingMgr->version, 1);
                 LWLockRelease(ShardMapLock);
                 /* reset flag */
                 g_GroupShardingMgr->needLock = false;
@@ -415,6 +417,7 @@ void ShardMapShmemInit_CN(void)
     }
     g_GroupShardingMgr->inited   = false;
     g_GroupShardingMgr->needLock = false;
+    pg_atomic_init_u32(&g_GroupShardingMgr->version, 0);
     
     groupshard = (GroupShardInfo *)ShmemInitStruct("Group shard major",
                                                         MAXALIGN64(sizeof(GroupShardInfo)) + MAXALIGN64(sizeof(ShardMapItemDef)) * (SHARD_MAP_GROUP_NUM - 1),
@@ -578,6 +581,7 @@ static void SyncShardMapList_CN(bool force)
 	g_GroupShardingMgr->inited = false;
     SyncShardMapList_Node_CN();
     g_GroupShardingMgr->inited = true;
+    pg_atomic_fetch_add_u32(&g_GroupShardingMgr->version, 1);
         
     LWLockRelease(ShardMapLock);
     
@@ -1219,6 +1223,19 @@ List* ShardMapRouter(Oid group, Oid relation, Oid type, Datum dvalue, RelationAc
     return list_make1_int(GetNodeIndexByHashValue(group, hashvalue));
 }
 #endif
+/*
+ * Version of the coordinator shard map, changes whenever the map in shared
+ * memory is rebuilt or a group is added or removed. Always 0 on datanodes.
+ */
+uint32 GetShardMapVersion(void)
+{
+    if (!IS_PGXC_COORDINATOR || NULL == g_GroupShardingMgr)
+    {
+        return 0;
+    }
+    return pg_atomic_read_u32(&g_GroupShardingMgr->version);
+}
+
 int32  GetNodeIndexByHashValue(Oid group, long hashvalue)
 {// #lizard forgives    
     int            shardIdx;
@@ -1892,7 +1909,7 @@ void ForceRefreshShardMap(Oid groupoid)
 			g_GroupShardingMgr->inited = false;
             SyncShardMapList_Node_CN();
             g_GroupShardingMgr->inited = true;
-
+            pg_atomic_fetch_add_u32(&g_GroupShardingMgr->version, 1);
         }
         else if (IS_PGXC_DATANODE)
         {    
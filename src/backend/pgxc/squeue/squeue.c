@@ -51,6 +51,7 @@
 #include "libpq/libpq-be.h"
 #include "utils/lsyscache.h"
 #include "storage/fd.h"
+#include "storage/buffile.h"
 #include "storage/shm_toc.h"
 #include "access/parallel.h"
 #include "postmaster/postmaster.h"
@@ -59,9 +60,19 @@
 #include "utils/typcache.h"
 #include "access/htup_details.h"
 #include "executor/execParallel.h"
+#include "executor/nodeHashjoin.h"
 #include "utils/memutils.h"
 #include "utils/elog.h"
 #include "commands/vacuum.h"
+#include "utils/builtins.h"
+#include "funcapi.h"
+#include "port/atomics.h"
+#include "lib/bloomfilter.h"
+#include "libpq/libpq.h"
+#include "libpq/pqformat.h"
+#include "storage/dsm.h"
+#include "tcop/tcopprot.h"
+#include "utils/portal.h"
 #endif
 int   NSQueues = 64;
 int   SQueueSize = 64;
@@ -74,6 +85,7 @@ bool  g_DataPumpDebug       = false;/* enable debug info */
 int32 g_SndThreadNum        = 8;    /* Two sender threads default.  */
 int32 g_SndThreadBufferSize = 16;   /* in Kilo bytes. */
 int32 g_SndBatchSize        = 8;    /* in Kilo bytes. */
+int32 g_SndCompressThreshold = -1;  /* in bytes, -1 disables compression. */
 int   consumer_connect_timeout = 128; /* in seconds */
 int   g_DisConsumer_timeout = 60; /* in minutes */
 
@@ -91,6 +103,17 @@ int   g_DisConsumer_timeout = 60; /* in minutes */
 
 
 
+/* Node wide counters of compressed redistribution streams. */
+typedef struct SqueueCompressStats
+{
+    pg_atomic_uint64    streams;    /* streams sent compressed */
+    pg_atomic_uint64    frames;     /* compressed frames sent */
+    pg_atomic_uint64    raw_bytes;  /* stream bytes before compression */
+    pg_atomic_uint64    sent_bytes; /* stream bytes put on the wire */
+} SqueueCompressStats;
+
+static SqueueCompressStats *CompressStats = NULL;
+
 static dsm_handle parallel_send_seg_handle = DSM_HANDLE_INVALID;
 static dsm_segment *dsm_seg                = NULL;
 
@@ -161,6 +184,7 @@ typedef struct
 #ifdef __OPENTENBASE__
     bool        send_fd;        /* true if send fd to producer */
     bool        cs_done;
+    dsm_handle  cs_filter;      /* runtime filter pushed by the consumer */
 #endif
 #ifdef SQUEUE_STAT
     long         stat_writes;
@@ -198,6 +222,8 @@ typedef struct SQueueHeader
     bool        producer_done;
     int         nConsumer_done;
     slock_t        lock;
+    dsm_handle  sq_self_filter; /* runtime filter of the producer's own
+                                 * consumer */
 #endif
     int            sq_nconsumers;    /* Number of consumers */
     ConsState     sq_consumers[0];/* variable length array */
@@ -276,6 +302,9 @@ static void *SQueueSyncs;
 static bool sq_push_long_tuple(ConsState *cstate, RemoteDataRow datarow);
 static void sq_pull_long_tuple(ConsState *cstate, RemoteDataRow datarow,
                                 int consumerIdx, SQueueSync *sqsync);
+#ifdef __OPENTENBASE__
+static bool RuntimeFilterCanWait(void);
+#endif
 
 #ifdef __OPENTENBASE__
 typedef struct DisConsumer
@@ -340,6 +369,34 @@ typedef enum
     DataPumpSndStatus_error           = 5, 
     DataPumpSndStatus_butty 
 }DataPumpSndStatus;
+/* Rows spooled for a consumer that can not take them yet. */
+typedef struct DataRowSpool
+{
+    BufFile            *file;        /* temp file, NULL until first written */
+    int                 rfileno;     /* read position in the file */
+    off_t               roffset;
+    int                 wfileno;     /* write position in the file */
+    off_t               woffset;
+    uint64              file_bytes;  /* bytes in the file not read yet */
+
+    int                 chunk_size;
+    char               *wbuf;        /* rows not written to the file */
+    int                 wlen;
+    int                 wpos;        /* rows before wpos are replayed */
+    char               *rbuf;        /* rows read ahead from the file */
+    int                 rsize;
+    int                 rlen;
+    int                 rpos;        /* rows before rpos are replayed */
+    bool                from_file;   /* last peeked row is in rbuf */
+
+    uint64              nrows;         /* rows not replayed yet */
+    uint64              total_bytes;   /* bytes put into the spool */
+    uint64              spilled_bytes; /* bytes written to the file */
+}DataRowSpool;
+
+#define DATAROW_SPOOL_MIN_CHUNK   (64 * 1024)
+#define DATAROW_SPOOL_MAX_CHUNK   (16 * 1024 * 1024)
+
 typedef struct
 {
     int32              nodeindex; /* Node index */
@@ -363,8 +420,29 @@ typedef struct
     size_t                nfast_send;  /* counter for tuple */
 
     size_t                sleep_count; /* counter sleep */
+
+    DataRowSpool       *spool;      /* rows waiting for the consumer */
+
+    /* stream compression, see DataPumpSendNodeData */
+    int32               compress_threshold; /* -1 if not compressed */
+    char               *zbuf;       /* compressed frame being sent */
+    uint32              zlen;       /* length of the frame */
+    uint32              zoff;       /* bytes of the frame already sent */
+    uint32             *zhash;      /* match finder of the compressor */
+    uint32              msg_left;   /* bytes left of the message sent raw */
+    uint32              hdr_len;    /* header bytes of the next message seen */
+    char                hdr[5];     /* header of the next message */
+    uint64              raw_bytes;  /* stream bytes taken from the buffer */
+    uint64              sent_bytes; /* bytes written to the socket for them */
+    uint64              nframes;    /* compressed frames sent */
 }DataPumpNodeControl;
 
+#define DataPumpFramePending(node) ((node)->zoff != (node)->zlen)
+
+/* hash table size of the stream compressor, see SqueueCompressData */
+#define SQUEUE_LZ_HASH_BITS     12
+#define SQUEUE_LZ_HASH_SIZE     (1 << SQUEUE_LZ_HASH_BITS)
+
 typedef struct
 {
     /* Nodes control of the cursor. */
@@ -399,6 +477,17 @@ typedef struct ConvertControl
     TimestampTz   finish_stamp;
 }ConvertControl;
 
+/*
+ * Output function info of one column, cached by the fast send path. finfo
+ * is the send function if the rows are sent in binary format.
+ */
+typedef struct DataRowColumnOut
+{
+    Oid                   typid;
+    bool                  typisvarlena;
+    FmgrInfo              finfo;
+}DataRowColumnOut;
+
 /* One struct for each cursor. */
 typedef struct DataPumpSenderControl
 {
@@ -410,8 +499,14 @@ typedef struct DataPumpSenderControl
 
     ConvertControl        convert_control;/* control info of thread convert */
 
-    TupleTableSlot        *temp_slot;     /* temp slot used to put_tuplestore */
     int32                  tuple_len;      /* MAX tuplelen of sent tuple */
+
+    /* row encoder state of ExecFastSendDatarow */
+    TupleDesc              out_tdesc;      /* descriptor out_cols was last checked against */
+    int32                  out_natts;      /* number of entries in out_cols */
+    bool                   out_binary;     /* rows are sent in binary format */
+    DataRowColumnOut      *out_cols;       /* cached output info per column */
+    StringInfoData         row_buf;        /* encoded row, reused */
 }DataPumpSenderControl;
 
 /*
@@ -585,6 +680,8 @@ typedef struct ParallelSendDestReceiver
 
 static bool DataPumpNodeCheck(void *sndctl, int32 nodeindex);
 static int    DataPumpRawSendData(DataPumpNodeControl *node, int32 sock, char *data, int32 len, int32 *reason);
+static int    DataPumpSendNodeData(DataPumpNodeControl *node, char *data, int32 len, int32 *reason);
+static int    DataPumpFlushFrame(DataPumpNodeControl *node, int32 *reason);
 static uint32 DataSize(DataPumpBuf *buf);
 static uint32 FreeSpace(DataPumpBuf *buf);
 static char  *GetData(DataPumpBuf *buf, uint32 *uiLen);
@@ -592,7 +689,6 @@ static void   IncDataOff(DataPumpBuf *buf, uint32 uiLen);
 static char  *GetWriteOff(DataPumpBuf *buf, uint32 *uiLen);
 static void   IncWriteOff(DataPumpBuf *buf, uint32 uiLen);
 static char  *GetWriteOff(DataPumpBuf *buf, uint32 *uiLen);
-static int    ReserveSpace(DataPumpBuf *buf, uint32 len, uint32 *offset);
 static void   FillReserveSpace(DataPumpBuf *buf, uint32 offset, char *p, uint32 len);
 static uint32 FreeSpace(DataPumpBuf *buf);
 static void   SetBorder(DataPumpBuf *buf);
@@ -618,14 +714,16 @@ static void *ConvertThreadMain(void *arg);
 static bool ConvertDone(ConvertControl *convert);
 static int32 DataPumpNodeReadyForSend(void *sndctl, int32 nodeindex, int32 nodeId);
 static int32 DataPumpSendToNode(void *sndctl, char *data, size_t len, int32 nodeindex);
-static bool DataPumpTupleStoreDump(void *sndctl, int32 nodeindex, int32 nodeId,
-                                             TupleTableSlot *tmpslot, 
-                                             Tuplestorestate *tuplestore);
+static DataRowSpool *DataRowSpoolCreate(MemoryContext cxt);
+static void DataRowSpoolDestroy(DataRowSpool *spool);
+static void DataRowSpoolPut(DataRowSpool *spool, char *msg, int len);
+static bool DataRowSpoolPeek(DataRowSpool *spool, char **msg, int *len);
+static void DataRowSpoolAdvance(DataRowSpool *spool);
+#define DataRowSpoolIsEmpty(spool) (0 == (spool)->nrows)
+static bool DataPumpSpoolDump(void *sndctl, int32 nodeindex, int32 nodeId, DataRowSpool *spool);
 static bool socket_set_nonblocking(int fd, bool non_block);
 static void DataPumpWakeupSender(void *sndctl, int32 nodeindex);
 static bool ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryContext tmpcxt);
-static int  ReturnSpace(DataPumpBuf *buf, uint32 offset);
-static uint32 BufferOffsetAdd(DataPumpBuf *buf, uint32 pointer, uint32 offset);
 
 static ParallelSendControl* BuildParallelSendControl(SharedQueue sq);
 static void InitParallelSendNodeControl(int32 nodeId, ParallelSendNodeControl *control, int32 numParallelWorkers);
@@ -715,6 +813,16 @@ SharedQueuesInit(void)
         DisConsumerHash = ShmemInitHash("Disconnect Consumers", NUM_SQUEUES,
                              NUM_SQUEUES, &ctl, flags);
     }
+
+    CompressStats = ShmemInitStruct("Shared Queue Compression",
+                                    sizeof(SqueueCompressStats), &found);
+    if (!found)
+    {
+        pg_atomic_init_u64(&CompressStats->streams, 0);
+        pg_atomic_init_u64(&CompressStats->frames, 0);
+        pg_atomic_init_u64(&CompressStats->raw_bytes, 0);
+        pg_atomic_init_u64(&CompressStats->sent_bytes, 0);
+    }
 #endif
 
     /*
@@ -786,6 +894,9 @@ SharedQueueShmemSize(void)
 	    /* Disconnect Consumers */
         sqs_size = add_size(sqs_size, hash_estimate_size(NUM_SQUEUES, sizeof(DisConsumer)));
     }
+
+    /* Compression counters */
+    sqs_size = add_size(sqs_size, sizeof(SqueueCompressStats));
 #endif
 
     /* Shared Queues */
@@ -874,6 +985,7 @@ tryagain:
 
         sq->producer_done = false;
         sq->nConsumer_done = 0;
+        sq->sq_self_filter = DSM_HANDLE_INVALID;
 
         SpinLockInit(&sq->lock);
 #endif
@@ -933,6 +1045,7 @@ tryagain:
 #ifdef __OPENTENBASE__
             cstate->send_fd = false;
             cstate->cs_done = false;
+            cstate->cs_filter = DSM_HANDLE_INVALID;
             InitSharedLatch(&sqsync->sqs_consumer_sync[i].cs_latch);
 #endif
             heapPtr += qsize;
@@ -1097,6 +1210,9 @@ SharedQueueBind(const char *sqname, List *consNodes,
             sq->sq_pid = MyProcPid;
             sq->sq_nodeid = PGXC_PARENT_NODE_ID;
             OwnLatch(&sq->sq_sync->sqs_producer_latch);
+#ifdef __OPENTENBASE__
+            sq->sq_self_filter = DSM_HANDLE_INVALID;
+#endif
 
             for (i = 0; i < MAX_NODES_NUMBER; i++)
             {
@@ -1410,6 +1526,9 @@ SharedQueueBind(const char *sqname, List *consNodes,
 
                         /* Set up the consumer */
                         cstate->cs_pid = MyProcPid;
+#ifdef __OPENTENBASE__
+                        cstate->cs_filter = DSM_HANDLE_INVALID;
+#endif
 
                         elog(DEBUG1, "SQueue %s, consumer at %d, status %d - "
                                 "setting up consumer node %d, pid %d",
@@ -1984,10 +2103,26 @@ SharedQueueRead(SharedQueue squeue, int consumerIdx,
             SetLatch(&sqsync->sqs_producer_latch);
             LWLockRelease(sqsync->sqs_producer_lwlock);
 
+#ifdef __OPENTENBASE__
+            /*
+             * The consumer may push a runtime filter to the producer while
+             * we wait, so watch its connection as well.
+             */
+            SharedQueuePollRuntimeFilter();
+            if (RuntimeFilterCanWait())
+                WaitLatchOrSocket(&sqsync->sqs_consumer_sync[consumerIdx].cs_latch,
+                        WL_LATCH_SET | WL_POSTMASTER_DEATH | WL_TIMEOUT |
+                        WL_SOCKET_READABLE, MyProcPort->sock, 1000L,
+                        WAIT_EVENT_MQ_INTERNAL);
+            else
+#endif
             /* Wait for notification about available info */
             WaitLatch(&sqsync->sqs_consumer_sync[consumerIdx].cs_latch,
                     WL_LATCH_SET | WL_POSTMASTER_DEATH | WL_TIMEOUT, 1000L,
                     WAIT_EVENT_MQ_INTERNAL);
+#ifdef __OPENTENBASE__
+            SharedQueuePollRuntimeFilter();
+#endif
 
             /* got the notification, restore lock and try again */
             LWLockAcquire(sqsync->sqs_producer_lwlock, LW_SHARED);
@@ -1997,6 +2132,9 @@ SharedQueueRead(SharedQueue squeue, int consumerIdx,
         {
             LWLockRelease(sqsync->sqs_consumer_sync[consumerIdx].cs_lwlock);
             LWLockRelease(sqsync->sqs_producer_lwlock);
+#ifdef __OPENTENBASE__
+            SharedQueuePollRuntimeFilter();
+#endif
 
             elog(DEBUG3, "SQueue %s, consumer (node %d, pid %d, status %d) - "
                     "no queued tuples to read, caller can't wait ",
@@ -2704,20 +2842,20 @@ SEND_DATA:
                             LWLockRelease(sqsync->sqs_consumer_sync[i].cs_lwlock);
                         }
 
-                        if (tuplestore[i])
+                        if (node->spool)
                         {
-                            /* If the consumer is not reading just destroy the tuplestore */
+                            /* If the consumer is not reading just destroy the spool */
                             if ((cstate->cs_status != CONSUMER_ACTIVE && cstate->cs_node != squeue->sq_nodeid) ||
                                 (cstate->cs_node == squeue->sq_nodeid && squeue->producer_done) ||
                                 (cstate->cs_done && cstate->send_fd))
                             {
-                                tuplestore_end(tuplestore[i]);
-                                tuplestore[i] = NULL;
+                                DataRowSpoolDestroy(node->spool);
+                                node->spool = NULL;
 
                                 if (g_DataPumpDebug)
                                 {
                                     elog(LOG, "Squeue %s finish: consumer idx %d, nodeid %d does not need the data,"
-                                              "destroy the tuplestore.", squeue->sq_key, i, cstate->cs_node);
+                                              "destroy the spool.", squeue->sq_key, i, cstate->cs_node);
                                 }
 
                                 /* consumer do not need more data, such as limit case */
@@ -2750,20 +2888,11 @@ SEND_DATA:
                             else
                             {
                                 nstores++;
-                            
-                                if (tmpslot == NULL)
-                                {
-                                    tmpslot = MakeSingleTupleTableSlot(tupDesc);
-                                }
-                                else
-                                {
-                                    ExecClearTuple(tmpslot);
-                                }
-                                tuplestore_done = DataPumpTupleStoreDump(squeue->sender, i, 
-                                                                         cstate->cs_node,
-                                                                         tmpslot, 
-                                                                         tuplestore[i]);
-                                                     
+
+                                tuplestore_done = DataPumpSpoolDump(squeue->sender, i,
+                                                                    cstate->cs_node,
+                                                                    node->spool);
+
                                 if (tuplestore_done)
                                 {                
                                     while (node->buffer->m_Head != node->buffer->m_Tail)
@@ -2787,8 +2916,12 @@ SEND_DATA:
                                             cstate->cs_node, squeue->sq_key, node->ntuples_put, node->ntuples_get);
                                     }
                                     
-                                    tuplestore_end(tuplestore[i]);
-                                    tuplestore[i] = NULL;
+                                    elog(DEBUG1, "ended spool with nodeid:%d, cursor %s, spooled_bytes:" UINT64_FORMAT ", spilled_bytes:" UINT64_FORMAT,
+                                         cstate->cs_node, squeue->sq_key,
+                                         node->spool->total_bytes, node->spool->spilled_bytes);
+
+                                    DataRowSpoolDestroy(node->spool);
+                                    node->spool = NULL;
 
                                     LWLockAcquire(sqsync->sqs_consumer_sync[i].cs_lwlock, LW_EXCLUSIVE);
                                     if (cstate->cs_status == CONSUMER_ACTIVE)
@@ -3805,43 +3938,7 @@ void IncWriteOff(DataPumpBuf *buf, uint32 uiLen)
     }
 }
 
-/* Reserve space in print buffer */
-int ReserveSpace(DataPumpBuf *buf, uint32 len, uint32 *offset)
-{
-    /* not enough space avaliable, wait */
-    if (FreeSpace(buf) < len)
-    {
-        return -1;
-    }
-
-    if (buf)
-    {
-        *offset    = buf->m_Head;
-           buf->m_Head  =  (buf->m_Head  + len)% buf->m_Length;
-    }
-    return 0;        
-}
-
-uint32 BufferOffsetAdd(DataPumpBuf *buf, uint32 pointer, uint32 offset)
-{
-
-    if (buf)
-    {    
-           return (pointer + offset) % buf->m_Length;
-    }
-    return 0;        
-}
-/* No need to lock, reader never read the data before we set border. */
-int ReturnSpace(DataPumpBuf *buf, uint32 offset)
-{
-    if (buf)
-    {
-        buf->m_Head = offset;
-    }
-    return 0;        
-}
-
-/* Fill data into reserved by ReserveSpace */
+/* Copy data into the buffer at offset, wrapping around the end. */
 void FillReserveSpace(DataPumpBuf *buf, uint32 offset, char *p, uint32 len)
 {
     uint32 bytes2end      = 0;
@@ -4007,6 +4104,14 @@ void InitDataPumpNodeControl(int32 nodeindex, DataPumpNodeControl *control)
     control->buffer      = BuildDataPumpBuf();
     control->ntuples_get = 0;
     control->ntuples_put = 0;
+
+    /* Sender threads can not palloc, set up the compressor here. */
+    control->compress_threshold = g_SndCompressThreshold;
+    if (control->compress_threshold >= 0)
+    {
+        control->zbuf  = (char*)palloc(control->buffer->m_Length + SQUEUE_COMPRESSED_HDRSZ);
+        control->zhash = (uint32*)palloc(sizeof(uint32) * SQUEUE_LZ_HASH_SIZE);
+    }
 }
 /*
  * Build data pump thread control.
@@ -4075,6 +4180,12 @@ DataPumpSender BuildDataPumpSenderControl(SharedQueue sq)
 
     sender_control = palloc0(sizeof(DataPumpSenderControl));
     sender_control->node_num = sq->sq_nconsumers;
+
+    /*
+     * Whether the stream is compressed is decided here, when the producer
+     * binds, from sender_thread_compress_threshold of the session.  Every
+     * consumer expands compressed frames in handle_response().
+     */
     sender_control->nodes    = (DataPumpNodeControl*)palloc0(sizeof(DataPumpNodeControl) * sender_control->node_num);
 
     for(i = 0; i < sq->sq_nconsumers; i++)
@@ -4148,6 +4259,16 @@ void DestoryDataPumpSenderControl (void* sndctl, int nodeid)
         for (i = 0; i < sender->node_num; i++)
         {        
             DestoryDataPumpBuf(sender->nodes[i].buffer);
+            if (sender->nodes[i].zbuf)
+            {
+                pfree(sender->nodes[i].zbuf);
+                pfree(sender->nodes[i].zhash);
+            }
+            if (sender->nodes[i].spool)
+            {
+                DataRowSpoolDestroy(sender->nodes[i].spool);
+                sender->nodes[i].spool = NULL;
+            }
 
             if (sender->nodes[i].sock != NO_SOCKET && sender->nodes[i].nodeindex != nodeid)
             {
@@ -4158,6 +4279,15 @@ void DestoryDataPumpSenderControl (void* sndctl, int nodeid)
         pfree(sender->nodes);
         sender->nodes = NULL;
 
+        if (sender->out_cols)
+        {
+            pfree(sender->out_cols);
+        }
+        if (sender->row_buf.data)
+        {
+            pfree(sender->row_buf.data);
+        }
+
         pfree(sender);
     }
     
@@ -4193,10 +4323,28 @@ void DataPumpSendLoop(DataPumpNodeControl  *nodes, DataPumpThreadControl* contro
             {
                 do 
                 {
+                    /* Finish the compressed frame first. */
+                    if (DataPumpFramePending(&nodes[nodeindex]))
+                    {
+                        if (EOF == DataPumpFlushFrame(&nodes[nodeindex], &reason))
+                        {
+                            spinlock_lock(&nodes[nodeindex].lock);
+                            nodes[nodeindex].status  = DataPumpSndStatus_error;
+                            nodes[nodeindex].errorno = errno;
+                            spinlock_unlock(&nodes[nodeindex].lock);
+                            break;
+                        }
+                        if (DataPumpFramePending(&nodes[nodeindex]))
+                        {
+                            stuck_nodes++;
+                            break;
+                        }
+                    }
+
                     data = GetData(nodes[nodeindex].buffer, &len);
                     if (data)
                     {
-                        ret = DataPumpRawSendData(&nodes[nodeindex], nodes[nodeindex].sock, data, len, &reason);                
+                        ret = DataPumpSendNodeData(&nodes[nodeindex], data, len, &reason);
                         if (EOF == ret)
                         {
                             /* We got error. */
@@ -4214,7 +4362,7 @@ void DataPumpSendLoop(DataPumpNodeControl  *nodes, DataPumpThreadControl* contro
                         if (reason == EAGAIN || reason == EWOULDBLOCK)
                         {
                             len = DataSize(nodes[nodeindex].buffer);
-                            if (len > 0)
+                            if (len > 0 || DataPumpFramePending(&nodes[nodeindex]))
                             {
                                 /* Break sending to the node, switch to the next one. */
                                 stuck_nodes++;
@@ -4267,6 +4415,25 @@ bool DataPumpFlushAllData(DataPumpNodeControl  *nodes, DataPumpThreadControl* co
             {
                 do 
                 {
+                    /* Finish the compressed frame first. */
+                    if (DataPumpFramePending(&nodes[nodeindex]))
+                    {
+                        if (EOF == DataPumpFlushFrame(&nodes[nodeindex], &reason))
+                        {
+                            spinlock_lock(&nodes[nodeindex].lock);
+                            nodes[nodeindex].status  = DataPumpSndStatus_error;
+                            nodes[nodeindex].errorno = errno;
+                            spinlock_unlock(&nodes[nodeindex].lock);
+                            succeed = false;
+                            break;
+                        }
+                        if (DataPumpFramePending(&nodes[nodeindex]))
+                        {
+                            stuck_nodes++;
+                            break;
+                        }
+                    }
+
                     /* Data left in buffer, send them all. */
                     if (nodes[nodeindex].buffer->m_Tail != nodes[nodeindex].buffer->m_Head)
                     {
@@ -4276,7 +4443,7 @@ bool DataPumpFlushAllData(DataPumpNodeControl  *nodes, DataPumpThreadControl* co
                     data = GetData(nodes[nodeindex].buffer, &len);
                     if (data)
                     {
-                        ret = DataPumpRawSendData(&nodes[nodeindex], nodes[nodeindex].sock, data, len, &reason);                
+                        ret = DataPumpSendNodeData(&nodes[nodeindex], data, len, &reason);
                         if (EOF == ret)
                         {
                             /* We got error. */
@@ -4295,7 +4462,7 @@ bool DataPumpFlushAllData(DataPumpNodeControl  *nodes, DataPumpThreadControl* co
                         if (reason == EAGAIN || reason == EWOULDBLOCK)
                         {
                             len = DataSize(nodes[nodeindex].buffer);
-                            if (len > 0)
+                            if (len > 0 || DataPumpFramePending(&nodes[nodeindex]))
                             {
                                 /* Break sending to the node, switch to the next one. */
                                 stuck_nodes++;
@@ -4434,164 +4601,685 @@ static int DataPumpRawSendData(DataPumpNodeControl *node, int32 sock, char *data
     return offset;
 }
 
-bool
-DataPumpTupleStoreDump(void *sndctl, int32 nodeindex, int32 nodeId,
-                                 TupleTableSlot *tmpslot, 
-                                 Tuplestorestate *tuplestore)
-{// #lizard forgives    
-    bool                  sendall   = false;
-    int32                   ret        = 0;    
-    DataPumpNodeControl   *node     = NULL;
-    DataPumpSenderControl *sender   = (DataPumpSenderControl*)sndctl;
+/*
+ * Block codec of the compressed redistribution stream.
+ *
+ * The format is the LZ4 block format: each sequence is a token byte holding
+ * the literal length and the match length minus four in its high and low
+ * nibble (15 means more length bytes follow, each adding up to 255), the
+ * literals, and a little-endian 16 bit match offset.  The last sequence has
+ * literals only.  pglz is not used because it keeps its history in static
+ * variables and the sender threads compress concurrently, so the caller
+ * passes the hash table here.
+ */
+#define SQUEUE_LZ_MIN_MATCH     4
+#define SQUEUE_LZ_MAX_OFFSET    65535
+#define SQUEUE_LZ_LAST_LITERALS 5
+#define SQUEUE_LZ_MF_LIMIT      12
 
-    node = &sender->nodes[nodeindex];
-    ret = DataPumpNodeReadyForSend(sndctl, nodeindex, nodeId);
-    /* Can't send data now, append data to the tuplestore. */
-    if (ret != DataPumpOK)
+#define SQUEUE_LZ_HASH(seq) \
+    (((seq) * 2654435761U) >> (32 - SQUEUE_LZ_HASH_BITS))
+
+static inline uint32
+squeue_lz_read32(const char *p)
+{
+    uint32 v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Append one sequence, return the new output offset or -1 if out of room. */
+static int32
+squeue_lz_emit(const char *src, int32 lit_start, int32 lit_len,
+               int32 offset, int32 match_len,
+               char *dst, int32 op, int32 dstcap)
+{
+    int32   need;
+    int32   token_pos = op;
+    int32   l;
+
+    need = 1 + lit_len + lit_len / 255 + 1;
+    if (match_len)
     {
-        if (DataPumpSndError_unreachable_node == ret)
+        need += 2 + match_len / 255 + 1;
+    }
+    if (op + need > dstcap)
+    {
+        return -1;
+    }
+
+    op++;
+    l = lit_len;
+    if (l >= 15)
+    {
+        for (l -= 15; l >= 255; l -= 255)
         {
-            /* No need to send data, trade it as done. */
-            elog(LOG, "DataPumpTupleStoreDump::remote node:%d never read data.", nodeId);
-            
-            return true;
+            dst[op++] = (char) 255;
         }
-        else if (DataPumpConvert_error == ret ||
-                 DataPumpSndError_node_error == ret ||
-                 DataPumpSndError_io_error == ret)
-        {
-            elog(ERROR, "DataPumpTupleStoreDump::DataPump status:%d abnormal!", ret);
+        dst[op++] = (char) l;
+    }
+    memcpy(dst + op, src + lit_start, lit_len);
+    op += lit_len;
+    dst[token_pos] = (char) (Min(lit_len, 15) << 4);
 
-            return false;
-        }
-        
-        /* Append the slot to the store... */
-        if (!TupIsNull(tmpslot))
-        {
-            tuplestore_puttupleslot(tuplestore, tmpslot);
+    if (match_len)
+    {
+        dst[op++] = (char) (offset & 0xff);
+        dst[op++] = (char) (offset >> 8);
 
-            node->ntuples_put++;
+        l = match_len - SQUEUE_LZ_MIN_MATCH;
+        dst[token_pos] |= (char) Min(l, 15);
+        if (l >= 15)
+        {
+            for (l -= 15; l >= 255; l -= 255)
+            {
+                dst[op++] = (char) 255;
+            }
+            dst[op++] = (char) l;
         }
-        sendall = false;
     }
-    else 
+    return op;
+}
+
+/*
+ * Compress srclen bytes into dst.  Returns the compressed length, or -1 if
+ * the result does not fit into dstcap bytes.  htab must hold
+ * SQUEUE_LZ_HASH_SIZE entries.
+ */
+int32
+SqueueCompressData(const char *src, int32 srclen, char *dst, int32 dstcap, uint32 *htab)
+{
+    int32   ip     = 0;
+    int32   anchor = 0;
+    int32   op     = 0;
+    int32   limit  = srclen - SQUEUE_LZ_MF_LIMIT;
+
+    memset(htab, 0, sizeof(uint32) * SQUEUE_LZ_HASH_SIZE);
+
+    while (ip < limit)
     {
-        
-        /* Read from tuplestore and send the tuple.*/
-        /*
-         * Tuplestore does not clear eof flag on the active read pointer, causing
-         * the store is always in EOF state once reached when there is a single
-         * read pointer. We do not want behavior like this and workaround by using
-         * secondary read pointer. Primary read pointer (0) is active when we are
-         * writing to the tuple store, also it is used to bookmark current position
-         * when reading to be able to roll back and return just read tuple back to
-         * the store if we failed to write it out to the queue.
-         * Secondary read pointer is for reading, and its eof flag is cleared if a
-         * tuple is written to the store.
-         */
-        tuplestore_select_read_pointer(tuplestore, 1);
+        uint32  seq = squeue_lz_read32(src + ip);
+        uint32  h   = SQUEUE_LZ_HASH(seq);
+        int32   ref = htab[h];
 
-        /* If we have something in the tuplestore try to push this to the queue */
-        while (!tuplestore_ateof(tuplestore))
+        htab[h] = ip;
+        if (ref < ip && ip - ref <= SQUEUE_LZ_MAX_OFFSET &&
+            squeue_lz_read32(src + ref) == seq)
         {
-            /* save position */
-            tuplestore_copy_read_pointer(tuplestore, 1, 0);
+            int32 match_len = SQUEUE_LZ_MIN_MATCH;
 
-            /* Try to get next tuple to the temporary slot */
-            if (!tuplestore_gettupleslot(tuplestore, true, false, tmpslot))
+            while (ip + match_len < srclen - SQUEUE_LZ_LAST_LITERALS &&
+                   src[ref + match_len] == src[ip + match_len])
             {
-                /* false means the tuplestore in EOF state */    
-                sendall = true;
-                break;
+                match_len++;
             }
 
-            node->ntuples_get++;
-            
-            /* The slot should contain a data row */
-            Assert(tmpslot->tts_datarow);
-
-            ret = DataPumpSendToNode(sndctl, tmpslot->tts_datarow->msg, tmpslot->tts_datarow->msglen, nodeindex);
-            /* check if queue has enough room for the data */
-            if (ret != DataPumpOK)
+            op = squeue_lz_emit(src, anchor, ip - anchor, ip - ref, match_len,
+                                dst, op, dstcap);
+            if (op < 0)
             {
+                return -1;
+            }
+            ip += match_len;
+            anchor = ip;
+        }
+        else
+        {
+            ip++;
+        }
+    }
 
-                /* Restore read position to get same tuple next time */
-                tuplestore_copy_read_pointer(tuplestore, 0, 1);
+    return squeue_lz_emit(src, anchor, srclen - anchor, 0, 0, dst, op, dstcap);
+}
 
-                /* We might advance the mark, try to truncate */
-                tuplestore_trim(tuplestore);
+/*
+ * Decompress srclen bytes into dst.  Returns the decompressed length, or -1
+ * if the input is corrupted or does not fit into dstcap bytes.
+ */
+int32
+SqueueDecompressData(const char *src, int32 srclen, char *dst, int32 dstcap)
+{
+    const unsigned char *in = (const unsigned char *) src;
+    int32   ip = 0;
+    int32   op = 0;
 
-                /* Prepare for writing, set proper read pointer */
-                tuplestore_select_read_pointer(tuplestore, 0);
-                
-                sendall = false;
+    while (ip < srclen)
+    {
+        int32   token = in[ip++];
+        int32   len   = token >> 4;
+        int32   offset;
 
-                node->ntuples_get--;
-                break;
-            }
-            else
+        if (len == 15)
+        {
+            int32 b;
+
+            do
             {
-                /* Big enough, send data. */
-                if (DataSize(node->buffer) > g_SndBatchSize * 1024)
-                {    
-                    DataPumpWakeupSender(sndctl, nodeindex);
+                if (ip >= srclen)
+                {
+                    return -1;
                 }
-            }
+                b = in[ip++];
+                len += b;
+            } while (b == 255);
+        }
+        if (len > srclen - ip || len > dstcap - op)
+        {
+            return -1;
         }
+        memcpy(dst + op, src + ip, len);
+        ip += len;
+        op += len;
 
-        /* Handle the latest row. */
-        if (!tuplestore_ateof(tuplestore))
+        /* the last sequence has no match */
+        if (ip == srclen)
         {
-            sendall = false;
+            break;
         }
-        else
+
+        if (ip + 2 > srclen)
         {
-            sendall = true;
+            return -1;
+        }
+        offset = in[ip] | (in[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op)
+        {
+            return -1;
         }
-        /* Remove rows we have just read */
-        tuplestore_trim(tuplestore);
 
-        /* prepare for writes, set read pointer 0 as active */
-        tuplestore_select_read_pointer(tuplestore, 0);
-    }
-    return sendall;
-}
-int32 DataPumpSendToNode(void *sndctl, char *data, size_t len, int32 nodeindex)
-{// #lizard forgives
-    bool                  long_tuple = false;
-    int                   cursor     = 0;
-    size_t                   tuple_len = 0;
+        len = (token & 15) + SQUEUE_LZ_MIN_MATCH;
+        if ((token & 15) == 15)
+        {
+            int32 b;
 
-    DataPumpSenderControl *sender   = (DataPumpSenderControl*)sndctl;
-    DataPumpNodeControl *node = &sender->nodes[nodeindex];
-        
-    tuple_len = 1; /* msg type 'D' */
-    if (PG_PROTOCOL_MAJOR(FrontendProtocol) >= 3)
-    {
-        tuple_len += 4;
-    }
-    tuple_len += len;
+            do
+            {
+                if (ip >= srclen)
+                {
+                    return -1;
+                }
+                b = in[ip++];
+                len += b;
+            } while (b == 255);
+        }
+        if (len > dstcap - op)
+        {
+            return -1;
+        }
 
-    if (tuple_len >= node->buffer->m_Length - 1)
-    {
-        long_tuple = true;
-    }
-    
-    if (FreeSpace(node->buffer) < (uint32)tuple_len)
-    {
-        if (!long_tuple)
+        /* byte by byte, the match may overlap the output */
+        while (len-- > 0)
         {
-            DataPumpWakeupSender(sndctl, nodeindex);
-            return DataPumpSndError_no_space;
+            dst[op] = dst[op - offset];
+            op++;
         }
     }
+    return op;
+}
 
-    if (!long_tuple)
+/*
+ * Track message boundaries over bytes that were sent raw, so that frames are
+ * only started at the beginning of a message.
+ */
+static void
+DataPumpTrackMessages(DataPumpNodeControl *node, char *data, uint32 len)
+{
+    while (len)
     {
-        /* MsgType */
-        PutData(node->buffer, "D", 1);
+        uint32 n;
 
-        /* Data length */
+        if (node->msg_left)
+        {
+            n = Min(node->msg_left, len);
+            node->msg_left -= n;
+        }
+        else
+        {
+            n = Min(sizeof(node->hdr) - node->hdr_len, len);
+            memcpy(node->hdr + node->hdr_len, data, n);
+            node->hdr_len += n;
+            if (node->hdr_len == sizeof(node->hdr))
+            {
+                uint32 n32;
+
+                memcpy(&n32, node->hdr + 1, sizeof(n32));
+                node->msg_left = ntohl(n32) - 4;
+                node->hdr_len  = 0;
+            }
+        }
+        data += n;
+        len  -= n;
+    }
+}
+
+/* Return length of the longest prefix of data made of complete messages. */
+static uint32
+DataPumpCompleteMessages(char *data, uint32 len)
+{
+    uint32 offset = 0;
+
+    while (offset + 5 <= len)
+    {
+        uint32 n32;
+        uint32 msglen;
+
+        memcpy(&n32, data + offset + 1, sizeof(n32));
+        msglen = 1 + ntohl(n32);
+        if (msglen > len - offset)
+        {
+            break;
+        }
+        offset += msglen;
+    }
+    return offset;
+}
+
+/* Send the rest of the pending frame.  Returns EOF on error. */
+static int
+DataPumpFlushFrame(DataPumpNodeControl *node, int32 *reason)
+{
+    int ret;
+
+    *reason = 0;
+    if (!DataPumpFramePending(node))
+    {
+        return 0;
+    }
+
+    ret = DataPumpRawSendData(node, node->sock, node->zbuf + node->zoff,
+                              node->zlen - node->zoff, reason);
+    if (EOF == ret)
+    {
+        return EOF;
+    }
+
+    node->zoff += ret;
+    if (node->zoff == node->zlen)
+    {
+        node->zoff = node->zlen = 0;
+    }
+    return ret;
+}
+
+/*
+ * Send data taken from the buffer of the node.  Returns the number of bytes
+ * consumed from the buffer, or EOF on error.
+ *
+ * For a compressed stream, a run of complete messages of at least
+ * compress_threshold bytes is packed into one frame, which is then owned by
+ * the node until it is written out completely.  Anything else goes out raw.
+ */
+static int
+DataPumpSendNodeData(DataPumpNodeControl *node, char *data, int32 len, int32 *reason)
+{
+    int     ret;
+
+    *reason = 0;
+    if (node->compress_threshold < 0)
+    {
+        return DataPumpRawSendData(node, node->sock, data, len, reason);
+    }
+
+    /* A frame is still on its way, no new data before it is done. */
+    if (DataPumpFramePending(node))
+    {
+        if (EOF == DataPumpFlushFrame(node, reason))
+        {
+            return EOF;
+        }
+        if (DataPumpFramePending(node))
+        {
+            return 0;
+        }
+    }
+
+    if (0 == node->msg_left && 0 == node->hdr_len && len >= node->compress_threshold)
+    {
+        uint32 complete = DataPumpCompleteMessages(data, len);
+
+        if (complete > 0 && complete >= node->compress_threshold)
+        {
+            int32 zlen;
+
+            /* Only worth it if we save at least an eighth. */
+            zlen = SqueueCompressData(data, complete,
+                                      node->zbuf + SQUEUE_COMPRESSED_HDRSZ,
+                                      complete - complete / 8, node->zhash);
+            if (zlen > 0)
+            {
+                uint32 n32;
+
+                node->zbuf[0] = SQUEUE_COMPRESSED_MSG;
+                n32 = htonl(zlen + SQUEUE_COMPRESSED_HDRSZ - 1);
+                memcpy(node->zbuf + 1, &n32, sizeof(n32));
+                node->zbuf[5] = SQUEUE_CODEC_LZ;
+                n32 = htonl(complete);
+                memcpy(node->zbuf + 6, &n32, sizeof(n32));
+
+                node->zlen = zlen + SQUEUE_COMPRESSED_HDRSZ;
+                node->zoff = 0;
+                node->nframes++;
+                node->raw_bytes  += complete;
+                node->sent_bytes += node->zlen;
+
+                if (EOF == DataPumpFlushFrame(node, reason))
+                {
+                    return EOF;
+                }
+                return complete;
+            }
+        }
+    }
+
+    ret = DataPumpRawSendData(node, node->sock, data, len, reason);
+    if (EOF != ret)
+    {
+        DataPumpTrackMessages(node, data, ret);
+        node->raw_bytes  += ret;
+        node->sent_bytes += ret;
+    }
+    return ret;
+}
+
+/*
+ * DataRow spool of a consumer.
+ *
+ * Rows are kept as the DataRow messages they will be sent as, each one
+ * preceded by its length.  New rows are appended to the write chunk, which
+ * goes to the temp file in one piece when it is full.  On replay the file is
+ * read back a chunk at a time, and only when it is drained are rows taken from
+ * the write chunk directly, so small spills never touch the disk.
+ */
+static DataRowSpool *
+DataRowSpoolCreate(MemoryContext cxt)
+{
+    DataRowSpool *spool = (DataRowSpool *) MemoryContextAllocZero(cxt, sizeof(DataRowSpool));
+    long          chunk_size;
+
+    /* Write and read chunk together take the budget the tuplestore had. */
+    chunk_size = (work_mem * 1024L) / Max(NumDataNodes, 1) / 2;
+    chunk_size = Max(chunk_size, DATAROW_SPOOL_MIN_CHUNK);
+    chunk_size = Min(chunk_size, DATAROW_SPOOL_MAX_CHUNK);
+
+    spool->chunk_size = (int) chunk_size;
+    spool->wbuf  = (char *) MemoryContextAlloc(cxt, spool->chunk_size);
+    spool->rsize = spool->chunk_size;
+    spool->rbuf  = (char *) MemoryContextAlloc(cxt, spool->rsize);
+    return spool;
+}
+
+static void
+DataRowSpoolDestroy(DataRowSpool *spool)
+{
+    if (spool->file)
+    {
+        BufFileClose(spool->file);
+    }
+    pfree(spool->wbuf);
+    pfree(spool->rbuf);
+    pfree(spool);
+}
+
+/* Append data at the write position of the temp file. */
+static void
+DataRowSpoolWriteFile(DataRowSpool *spool, char *data, int len)
+{
+    if (NULL == spool->file)
+    {
+        MemoryContext oldcxt = MemoryContextSwitchTo(GetMemoryChunkContext(spool));
+
+        spool->file = BufFileCreateTemp(false);
+        MemoryContextSwitchTo(oldcxt);
+    }
+
+    if (BufFileSeek(spool->file, spool->wfileno, spool->woffset, SEEK_SET) != 0 ||
+        BufFileWrite(spool->file, data, len) != len)
+    {
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not write to shared queue spool file: %m")));
+    }
+    BufFileTell(spool->file, &spool->wfileno, &spool->woffset);
+
+    spool->file_bytes    += len;
+    spool->spilled_bytes += len;
+}
+
+static void
+DataRowSpoolPut(DataRowSpool *spool, char *msg, int len)
+{
+    int need = sizeof(int32) + len;
+
+    if (spool->wlen + need > spool->chunk_size && spool->wlen > spool->wpos)
+    {
+        DataRowSpoolWriteFile(spool, spool->wbuf + spool->wpos, spool->wlen - spool->wpos);
+        spool->wlen = spool->wpos = 0;
+    }
+    else if (spool->wpos == spool->wlen)
+    {
+        spool->wlen = spool->wpos = 0;
+    }
+
+    if (need > spool->chunk_size)
+    {
+        int32 n32 = len;
+
+        DataRowSpoolWriteFile(spool, (char *) &n32, sizeof(n32));
+        DataRowSpoolWriteFile(spool, msg, len);
+    }
+    else
+    {
+        memcpy(spool->wbuf + spool->wlen, &len, sizeof(int32));
+        memcpy(spool->wbuf + spool->wlen + sizeof(int32), msg, len);
+        spool->wlen += need;
+    }
+
+    spool->nrows++;
+    spool->total_bytes += need;
+}
+
+/* Read ahead from the temp file until the read chunk holds need bytes. */
+static void
+DataRowSpoolFill(DataRowSpool *spool, int need)
+{
+    int avail = spool->rlen - spool->rpos;
+
+    if (spool->rpos > 0)
+    {
+        memmove(spool->rbuf, spool->rbuf + spool->rpos, avail);
+        spool->rlen = avail;
+        spool->rpos = 0;
+    }
+
+    if (need > spool->rsize)
+    {
+        spool->rsize = need;
+        spool->rbuf  = (char *) repalloc(spool->rbuf, spool->rsize);
+    }
+
+    while (spool->rlen < need)
+    {
+        size_t nread = Min(spool->file_bytes, (uint64) (spool->rsize - spool->rlen));
+
+        if (0 == nread ||
+            BufFileSeek(spool->file, spool->rfileno, spool->roffset, SEEK_SET) != 0 ||
+            BufFileRead(spool->file, spool->rbuf + spool->rlen, nread) != nread)
+        {
+            ereport(ERROR,
+                    (errcode_for_file_access(),
+                     errmsg("could not read from shared queue spool file: %m")));
+        }
+        BufFileTell(spool->file, &spool->rfileno, &spool->roffset);
+
+        spool->rlen       += nread;
+        spool->file_bytes -= nread;
+    }
+}
+
+/*
+ * Return the oldest row of the spool without removing it, false if the spool
+ * is empty.  The row stays valid until the spool is changed.
+ */
+static bool
+DataRowSpoolPeek(DataRowSpool *spool, char **msg, int *len)
+{
+    int32 n32;
+
+    if (0 == spool->nrows)
+    {
+        return false;
+    }
+
+    /* Rows in the file are older than those in the write chunk. */
+    if (spool->rpos < spool->rlen || spool->file_bytes > 0)
+    {
+        if (spool->rlen - spool->rpos < sizeof(int32))
+        {
+            DataRowSpoolFill(spool, sizeof(int32));
+        }
+        memcpy(&n32, spool->rbuf + spool->rpos, sizeof(n32));
+        if (spool->rlen - spool->rpos < sizeof(int32) + n32)
+        {
+            DataRowSpoolFill(spool, sizeof(int32) + n32);
+        }
+
+        *msg = spool->rbuf + spool->rpos + sizeof(int32);
+        *len = n32;
+        spool->from_file = true;
+    }
+    else
+    {
+        memcpy(&n32, spool->wbuf + spool->wpos, sizeof(n32));
+
+        *msg = spool->wbuf + spool->wpos + sizeof(int32);
+        *len = n32;
+        spool->from_file = false;
+    }
+    return true;
+}
+
+/* Remove the row returned by the last DataRowSpoolPeek(). */
+static void
+DataRowSpoolAdvance(DataRowSpool *spool)
+{
+    int32 n32;
+
+    if (spool->from_file)
+    {
+        memcpy(&n32, spool->rbuf + spool->rpos, sizeof(n32));
+        spool->rpos += sizeof(int32) + n32;
+    }
+    else
+    {
+        memcpy(&n32, spool->wbuf + spool->wpos, sizeof(n32));
+        spool->wpos += sizeof(int32) + n32;
+    }
+
+    /* Start over once drained, so the temp file does not keep growing. */
+    if (0 == --spool->nrows)
+    {
+        spool->wlen = spool->wpos = 0;
+        spool->rlen = spool->rpos = 0;
+        spool->rfileno = spool->wfileno = 0;
+        spool->roffset = spool->woffset = 0;
+        Assert(0 == spool->file_bytes);
+    }
+}
+
+/*
+ * Move spooled rows of the consumer into its send buffer.  Returns true if
+ * the spool is empty afterwards.
+ */
+bool
+DataPumpSpoolDump(void *sndctl, int32 nodeindex, int32 nodeId, DataRowSpool *spool)
+{
+    int32                   ret        = 0;    
+    int                   len       = 0;
+    char                  *msg      = NULL;
+    DataPumpNodeControl   *node     = NULL;
+    DataPumpSenderControl *sender   = (DataPumpSenderControl*)sndctl;
+
+    node = &sender->nodes[nodeindex];
+    ret = DataPumpNodeReadyForSend(sndctl, nodeindex, nodeId);
+    /* Can't send data now, keep the rows spooled. */
+    if (ret != DataPumpOK)
+    {
+        if (DataPumpSndError_unreachable_node == ret)
+        {
+            /* No need to send data, trade it as done. */
+            elog(LOG, "DataPumpSpoolDump::remote node:%d never read data.", nodeId);
+            
+            return true;
+        }
+        else if (DataPumpConvert_error == ret ||
+                 DataPumpSndError_node_error == ret ||
+                 DataPumpSndError_io_error == ret)
+        {
+            elog(ERROR, "DataPumpSpoolDump::DataPump status:%d abnormal!", ret);
+
+            return false;
+        }
+        return false;
+    }
+
+    /* Replay the rows in order, stop at the first one that does not fit. */
+    while (DataRowSpoolPeek(spool, &msg, &len))
+    {
+        ret = DataPumpSendToNode(sndctl, msg, len, nodeindex);
+        if (ret != DataPumpOK)
+        {
+            return false;
+        }
+
+        DataRowSpoolAdvance(spool);
+        node->ntuples_get++;
+
+        /* Big enough, send data. */
+        if (DataSize(node->buffer) > g_SndBatchSize * 1024)
+        {    
+            DataPumpWakeupSender(sndctl, nodeindex);
+        }
+    }
+    return true;
+}
+int32 DataPumpSendToNode(void *sndctl, char *data, size_t len, int32 nodeindex)
+{// #lizard forgives
+    bool                  long_tuple = false;
+    int                   cursor     = 0;
+    size_t                   tuple_len = 0;
+
+    DataPumpSenderControl *sender   = (DataPumpSenderControl*)sndctl;
+    DataPumpNodeControl *node = &sender->nodes[nodeindex];
+        
+    tuple_len = 1; /* msg type 'D' */
+    if (PG_PROTOCOL_MAJOR(FrontendProtocol) >= 3)
+    {
+        tuple_len += 4;
+    }
+    tuple_len += len;
+
+    if (tuple_len >= node->buffer->m_Length - 1)
+    {
+        long_tuple = true;
+    }
+    
+    if (FreeSpace(node->buffer) < (uint32)tuple_len)
+    {
+        if (!long_tuple)
+        {
+            DataPumpWakeupSender(sndctl, nodeindex);
+            return DataPumpSndError_no_space;
+        }
+    }
+
+    if (!long_tuple)
+    {
+        /* MsgType */
+        PutData(node->buffer, "D", 1);
+
+        /* Data length */
         if (PG_PROTOCOL_MAJOR(FrontendProtocol) >= 3)
         {
             uint32        n32;
@@ -4813,6 +5501,28 @@ bool DataPumpWaitSenderDone(void *sndctl, bool error)
     }
 
     pfree(send_quit);
+
+    if (sender->node_num > 0 && sender->nodes[0].compress_threshold >= 0)
+    {
+        uint64 raw_bytes  = 0;
+        uint64 sent_bytes = 0;
+        uint64 nframes    = 0;
+
+        for (nodeindex = 0; nodeindex < sender->node_num; nodeindex++)
+        {
+            raw_bytes  += sender->nodes[nodeindex].raw_bytes;
+            sent_bytes += sender->nodes[nodeindex].sent_bytes;
+            nframes    += sender->nodes[nodeindex].nframes;
+        }
+
+        pg_atomic_fetch_add_u64(&CompressStats->streams, 1);
+        pg_atomic_fetch_add_u64(&CompressStats->frames, nframes);
+        pg_atomic_fetch_add_u64(&CompressStats->raw_bytes, raw_bytes);
+        pg_atomic_fetch_add_u64(&CompressStats->sent_bytes, sent_bytes);
+
+        elog(DEBUG1, "Squeue:%s(Pid:%d), sent " UINT64_FORMAT " bytes as " UINT64_FORMAT " bytes, " UINT64_FORMAT " compressed frames.",
+                     sender->convert_control.sqname, MyProcPid, raw_bytes, sent_bytes, nframes);
+    }
     
     /* tell convert to exit */
     ret = ConvertDone(&sender->convert_control);
@@ -5403,6 +6113,11 @@ RETRY:
     return succeed;
 }
 
+/*
+ * Send the tuple to the consumer through the data pump.  Rows that can not be
+ * sent right now go to the spool of the consumer, the tuplestore of the caller
+ * is not used on this path.
+ */
 void
 SendDataRemote(SharedQueue squeue, int32 consumerIdx, TupleTableSlot *slot, Tuplestorestate **tuplestore, MemoryContext tmpcxt)
 {// #lizard forgives    
@@ -5465,8 +6180,8 @@ SendDataRemote(SharedQueue squeue, int32 consumerIdx, TupleTableSlot *slot, Tupl
     ret = DataPumpNodeReadyForSend(squeue->sender, consumerIdx, nodeid);
     if (DataPumpOK == ret)
     {
-        /* No tuplestore created, we send datarow directly. */
-        if (NULL == *tuplestore)
+        /* No spool created, we send datarow directly. */
+        if (NULL == node->spool)
         {
             /* Get datarow from the tuple slot */
             if (slot->tts_datarow)
@@ -5534,8 +6249,8 @@ SendDataRemote(SharedQueue squeue, int32 consumerIdx, TupleTableSlot *slot, Tupl
         }
         else
         {
-            /* Empty tuple store, send the data. */
-            if (tuplestore_ateof(*tuplestore))
+            /* Empty spool, send the data. */
+            if (DataRowSpoolIsEmpty(node->spool))
             {
                 /* Get datarow from the tuple slot */
                 if (slot->tts_datarow)
@@ -5603,24 +6318,9 @@ SendDataRemote(SharedQueue squeue, int32 consumerIdx, TupleTableSlot *slot, Tupl
             }
             else
             {
-                /*Build the temp slot. We will not DROP this slot when finish the cursor. We need upper level to reset the MCTX. */
-                if (NULL == squeue->sender->temp_slot)
-                {
-                    squeue->sender->temp_slot = MakeSingleTupleTableSlot(slot->tts_tupleDescriptor);
-                }
-                else
-                {
-                    ExecClearTuple(squeue->sender->temp_slot);
-                }
-                        
-                
-                /* We got a tuplestore, dump it first. */
-                send_all = DataPumpTupleStoreDump(squeue->sender, 
-                                                   consumerIdx, 
-                                                   nodeid,
-                                                      squeue->sender->temp_slot, 
-                                                   *tuplestore);
-                /* Send the tuple if the tuplestore is empty. */
+                /* We got spooled rows, dump them first. */
+                send_all = DataPumpSpoolDump(squeue->sender, consumerIdx, nodeid, node->spool);
+                /* Send the tuple if the spool is empty. */
                 if (send_all)
                 {                    
                     if (!TupIsNull(slot))
@@ -5662,7 +6362,7 @@ SendDataRemote(SharedQueue squeue, int32 consumerIdx, TupleTableSlot *slot, Tupl
                             pfree(datarow);
                             datarow = NULL;
                         }
-                        /* Failure!! Put tuple to tuplestore. */
+                        /* Failure!! Put tuple to the spool. */
                     }
                     else
                     {
@@ -5686,32 +6386,33 @@ SendDataRemote(SharedQueue squeue, int32 consumerIdx, TupleTableSlot *slot, Tupl
         goto ERR;
     }
 
-    /* Error ocurred or the node is not ready at present,  store the tuple into the tuplestore. */
-    /* Create tuplestore if does not exist.*/
-    if (NULL == *tuplestore)
+    /* Error ocurred or the node is not ready at present, spool the tuple. */
+    /*
+     * Create spool if does not exist.  It lives as long as the sender, so it
+     * goes into the context the node array was allocated in; tmpcxt is reset
+     * for every row and is only good for the scratch copy below.
+     */
+    if (NULL == node->spool)
     {
-        int            ptrno PG_USED_FOR_ASSERTS_ONLY;
-        char         storename[64];
-
-
-        *tuplestore = tuplestore_begin_datarow(false, work_mem / NumDataNodes, tmpcxt);
-        /* We need is to be able to remember/restore the read position */
-        snprintf(storename, 64, "%s node %d", squeue->sq_key, cstate->cs_node);
-        tuplestore_collect_stat(*tuplestore, storename);
-        /*
-         * Allocate a second read pointer to read from the store. We know
-         * it must have index 1, so needn't store that.
-         */
-        ptrno = tuplestore_alloc_read_pointer(*tuplestore, 0);
-        Assert(ptrno == 1);
+        node->spool = DataRowSpoolCreate(GetMemoryChunkContext(sender->nodes));
 
         if(g_DataPumpDebug)
-            elog(LOG, "create tuplestore with nodeid %d, cursor %s.", nodeid, squeue->sq_key);
+            elog(LOG, "create spool with nodeid %d, cursor %s.", nodeid, squeue->sq_key);
+    }
+
+    /* Append the row to the spool as it is going to be sent... */
+    if (slot->tts_datarow)
+    {
+        DataRowSpoolPut(node->spool, slot->tts_datarow->msg, slot->tts_datarow->msglen);
+    }
+    else
+    {
+        in_data_pump = true;
+        datarow = ExecCopySlotDatarow(slot, tmpcxt);
+        in_data_pump = false;
+        DataRowSpoolPut(node->spool, datarow->msg, datarow->msglen);
+        pfree(datarow);
     }
-    in_data_pump = true;
-    /* Append the slot to the store... */
-    tuplestore_puttupleslot(*tuplestore, slot);
-    in_data_pump = false;
 
     node->ntuples_put++;
     
@@ -5753,587 +6454,380 @@ bool socket_set_nonblocking(int fd, bool non_block)
     return true;
 }
 
-bool
-ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryContext tmpcxt)
-{// #lizard forgives
-#define DEFAULT_RESERVE_STEP 128
-#define MAX_SLEEP_TIMES 50
-    uint32          free_size       = 0;
-    uint16             n16             = 0;
-    uint32            tuple_len       = 0;
-    int             i                = 0;
-    DataPumpSenderControl *sender   = NULL;
-    DataPumpNodeControl   *node     = NULL;
-    TupleDesc         tdesc = slot->tts_tupleDescriptor;
-    StringInfoData      data;
-    uint32 head = 0;
+/*
+ * Set up the cached output functions of the sender for tdesc.  Done once per
+ * cursor, so that encoding a row needs no syscache lookup and no fmgr_info().
+ */
+static void
+DataPumpInitRowEncoder(DataPumpSenderControl *sender, TupleDesc tdesc)
+{
+    MemoryContext cxt = GetMemoryChunkContext(sender);
+    int           i;
 
-    sender   = (DataPumpSenderControl*)sndctl;
-    node     = &sender->nodes[nodeindex];
-    
-    
-    /* Get tuple length. */
-    tuple_len = 1; /* msg type 'D' */
-    if (PG_PROTOCOL_MAJOR(FrontendProtocol) >= 3)
+    if (sender->out_cols)
     {
-        tuple_len += 4;
-    }
-    if (0 == sender->tuple_len)
-    {
-        sender->tuple_len = DEFAULT_RESERVE_STEP;
+        pfree(sender->out_cols);
     }
-    tuple_len += sender->tuple_len;    
 
-    head = node->buffer->m_Head;
-    free_size = FreeSpace(node->buffer);
-    if (free_size > tuple_len)    
+    sender->out_cols = (DataRowColumnOut *)
+        MemoryContextAlloc(cxt, sizeof(DataRowColumnOut) * Max(tdesc->natts, 1));
+    sender->out_tdesc = tdesc;
+    sender->out_natts = tdesc->natts;
+    sender->out_binary = DataRowBinaryCapable(tdesc);
+
+    for (i = 0; i < tdesc->natts; i++)
     {
-        int32  ret         = 0;
-        uint32 tmp         = 0;
-        uint32 leng_ptr    = 0;
-        uint32 write_len   = 0;        
-        uint32 n32         = 0;
-        uint32 data_offset = 0;
-        uint32 remaining_length = 0;
-        MemoryContext    savecxt = NULL;
+        DataRowColumnOut *col = &sender->out_cols[i];
+        Oid               typOutput;
 
-        (void) ReserveSpace(node->buffer, tuple_len, &data_offset);
-        remaining_length = tuple_len;
-        /* MsgType */
-        FillReserveSpace(node->buffer, data_offset, "D", 1);
-        data_offset = BufferOffsetAdd(node->buffer, data_offset, 1);
-        remaining_length -= 1;
-        
-        /* Init length, exclude command tag. */
-        write_len = 1;
-        /* Data length */
-        if (PG_PROTOCOL_MAJOR(FrontendProtocol) >= 3)
+        col->typid = tdesc->attrs[i]->atttypid;
+        if (sender->out_binary)
         {
-            leng_ptr         = data_offset;        
-            data_offset = BufferOffsetAdd(node->buffer, data_offset, sizeof(n32));
-            remaining_length -= sizeof(n32);    
-
-            write_len += sizeof(n32);
+            if (DATAROW_RAW_BYVAL(tdesc->attrs[i]))
+            {
+                continue;
+            }
+            getTypeBinaryOutputInfo(col->typid, &typOutput, &col->typisvarlena);
         }
-        
-        /* Data */
-        
-        /* ensure we have all values */
-        slot_getallattrs(slot);
-        
-        /* if temporary memory context is specified reset it */
-        if (tmpcxt)
+        else
         {
-            MemoryContextReset(tmpcxt);
-            savecxt = MemoryContextSwitchTo(tmpcxt);
+            getTypeOutputInfo(col->typid, &typOutput, &col->typisvarlena);
         }
+        fmgr_info_cxt(typOutput, &col->finfo, cxt);
+    }
 
-        initStringInfo(&data);
-        
-        /* Number of parameter values */
-        n16 = htons(tdesc->natts);
-
-        /* No possiblity of memory short, we reserved DEFAULT_RESERVE_STEP bytes above. */
-        FillReserveSpace(node->buffer, data_offset, (char *) &n16, sizeof(n16));
-        data_offset = BufferOffsetAdd(node->buffer, data_offset, sizeof(n16));
-        remaining_length -= sizeof(n16);
-
-        /* Write length */
-        write_len += sizeof(n16);
-        
-        #if 0
-        appendBinaryStringInfo(&buf, (char *) &n16, 2);
-        #endif
-        
-        for (i = 0; i < tdesc->natts; i++)
-        {
-            if (slot->tts_isnull[i])
-            {
-                n32 = htonl(-1);
-                #if 0
-                appendBinaryStringInfo(&buf, (char *) &n32, 4);
-                #endif
-
-                if (write_len + sizeof(n32) >= node->buffer->m_Length - 1)
-                {
-                    appendBinaryStringInfo(&data, (char *) &n32, 4);
-                }
-                else
-                {
-                    if (remaining_length < sizeof(n32))
-                    {
-                        int sleep_times = 0;
-                        
-                        do
-                        {
-                            ret = ReserveSpace(node->buffer, DEFAULT_RESERVE_STEP, &tmp);
-                            if (!ret)
-                            {
-                                break;
-                            }
-                            pg_usleep(1000L);
-                            if (!DataPumpNodeCheck(sndctl, nodeindex))
-                            {
-                                ReturnSpace(node->buffer, head);
-                                pfree(data.data);
-                                if (savecxt)
-                                {
-                                    MemoryContextSwitchTo(savecxt);
-                                }
-                                elog(ERROR, "ExecFastSendDatarow:node %d status abnormal.", nodeindex);
-                            }
-
-                            sleep_times++;
+    if (NULL == sender->row_buf.data)
+    {
+        MemoryContext oldcxt = MemoryContextSwitchTo(cxt);
 
-                            if (sleep_times == MAX_SLEEP_TIMES)
-                            {
-                                ReturnSpace(node->buffer, head);
+        initStringInfo(&sender->row_buf);
+        MemoryContextSwitchTo(oldcxt);
+    }
+}
 
-                                pfree(data.data);
+/*
+ * Whether the cached output functions of the sender still fit tdesc.  The
+ * slot handed in may change between calls, so the column types are compared
+ * whenever the descriptor is not the one seen last.
+ */
+static bool
+DataPumpRowEncoderMatches(DataPumpSenderControl *sender, TupleDesc tdesc)
+{
+    int i;
 
-                                if (savecxt)
-                                {
-                                    MemoryContextSwitchTo(savecxt);
-                                }
-                                
-                                return false;
-                            }
-                        }while(ret == -1);
+    if (NULL == sender->out_cols || sender->out_natts != tdesc->natts)
+    {
+        return false;
+    }
 
-                        /* sanity check */
-                        if ((remaining_length + data_offset) % node->buffer->m_Length != tmp)
-                        {
-                            ReturnSpace(node->buffer, head);
-                            pfree(data.data);
-                            if (savecxt)
-                            {
-                                MemoryContextSwitchTo(savecxt);
-                            }
-                            elog(ERROR, "mismatch in Fast end.");
-                        }
-                        
-                        remaining_length += DEFAULT_RESERVE_STEP;
-                    }
-                    FillReserveSpace(node->buffer, data_offset, (char *) &n32, sizeof(n32));
-                    data_offset = BufferOffsetAdd(node->buffer, data_offset, sizeof(n32));
-                    remaining_length -= sizeof(n32);
-                }
-                
-                /* Write length */
-                write_len += sizeof(n32);
-            }
-            else
-            {
-                Form_pg_attribute attr = tdesc->attrs[i];
-                uint32  reserve_len  = 0;
-                Oid        typOutput;
-                bool    typIsVarlena;
-                Datum    pval;
-                char   *pstring;
-                int        len;
+    if (sender->out_tdesc == tdesc)
+    {
+        return true;
+    }
 
-                /* Get info needed to output the value */
-                getTypeOutputInfo(attr->atttypid, &typOutput, &typIsVarlena);
-                /*
-                 * If we have a toasted datum, forcibly detoast it here to avoid
-                 * memory leakage inside the type's output routine.
-                 */
-                if (typIsVarlena)
-                    pval = PointerGetDatum(PG_DETOAST_DATUM(slot->tts_values[i]));
-                else
-                    pval = slot->tts_values[i];
+    for (i = 0; i < tdesc->natts; i++)
+    {
+        if (sender->out_cols[i].typid != tdesc->attrs[i]->atttypid)
+        {
+            return false;
+        }
+    }
 
-                /*
-                  * column is composite type, need to send tupledesc to remote node
-                  */
-                if (attr->atttypid == RECORDOID)
-                {
-                    HeapTupleHeader rec;
-                    Oid            tupType;
-                    int32        tupTypmod;
-                    TupleDesc    tupdesc;
-                    StringInfoData  tupdesc_data;
-                    
-                    initStringInfo(&tupdesc_data);
-                    
-                    /* -2 to indicate this is composite type */
-                    n32 = htonl(-2);
+    sender->out_tdesc = tdesc;
+    return true;
+}
 
-                    if (write_len + sizeof(n32) >= node->buffer->m_Length - 1)
-                    {
-                        appendBinaryStringInfo(&data, (char *) &n32, 4);
-                    }
-                    else
-                    {
-                        if (remaining_length < sizeof(n32))
-                        {
-                            int sleep_times = 0;
-                            
-                            do
-                            {
-                                ret = ReserveSpace(node->buffer, DEFAULT_RESERVE_STEP, &tmp);
-                                if (!ret)
-                                {
-                                    break;
-                                }
-                                pg_usleep(1000L);
-                                if (!DataPumpNodeCheck(sndctl, nodeindex))
-                                {
-                                    ReturnSpace(node->buffer, head);
-                                    pfree(data.data);
-                                    if (savecxt)
-                                    {
-                                        MemoryContextSwitchTo(savecxt);
-                                    }
-                                    elog(ERROR, "ExecFastSendDatarow:node %d status abnormal.", nodeindex);
-                                }
-                                
-                                sleep_times++;
+/*
+ * Append one column value in text format.  The common fixed-width types are
+ * converted in place, everything else goes through the cached output
+ * function.
+ */
+static void
+DataPumpEncodeColumn(DataRowColumnOut *col, Datum value, StringInfo buf)
+{
+    char    numbuf[32];
+    char   *pstring;
+    uint32  n32;
+    int     len;
 
-                                if (sleep_times == MAX_SLEEP_TIMES)
-                                {
-                                    ReturnSpace(node->buffer, head);
+    switch (col->typid)
+    {
+        case INT2OID:
+            pg_itoa(DatumGetInt16(value), numbuf);
+            pstring = numbuf;
+            break;
+        case INT4OID:
+            pg_ltoa(DatumGetInt32(value), numbuf);
+            pstring = numbuf;
+            break;
+        case INT8OID:
+            pg_lltoa(DatumGetInt64(value), numbuf);
+            pstring = numbuf;
+            break;
+        case OIDOID:
+            snprintf(numbuf, sizeof(numbuf), "%u", DatumGetObjectId(value));
+            pstring = numbuf;
+            break;
+        case BOOLOID:
+            pstring = DatumGetBool(value) ? "t" : "f";
+            break;
+        default:
+            /*
+             * If we have a toasted datum, forcibly detoast it here to avoid
+             * memory leakage inside the type's output routine.
+             */
+            if (col->typisvarlena)
+                value = PointerGetDatum(PG_DETOAST_DATUM(value));
+            pstring = OutputFunctionCall(&col->finfo, value);
+            break;
+    }
 
-                                    pfree(data.data);
+    len = strlen(pstring);
+    n32 = htonl(len);
+    appendBinaryStringInfo(buf, (char *) &n32, sizeof(n32));
+    appendBinaryStringInfo(buf, pstring, len);
+}
 
-                                    if (savecxt)
-                                    {
-                                        MemoryContextSwitchTo(savecxt);
-                                    }
-                                    
-                                    return false;
-                                }
-                            }while(ret == -1);
+/*
+ * Encode the slot as a complete DataRow message into buf.
+ */
+static void
+DataPumpEncodeDataRow(DataPumpSenderControl *sender, TupleTableSlot *slot, StringInfo buf)
+{
+    TupleDesc tdesc = slot->tts_tupleDescriptor;
+    uint16    n16;
+    uint32    n32;
+    int       i;
 
-                            /* sanity check */
-                            if ((remaining_length + data_offset) % node->buffer->m_Length != tmp)
-                            {
-                                ReturnSpace(node->buffer, head);
-                                pfree(data.data);
-                                if (savecxt)
-                                {
-                                    MemoryContextSwitchTo(savecxt);
-                                }
-                                elog(ERROR, "mismatch in Fast end.");
-                            }
-                            
-                            remaining_length += DEFAULT_RESERVE_STEP;
-                        }
-                        FillReserveSpace(node->buffer, data_offset, (char *) &n32, sizeof(n32));
-                        data_offset = BufferOffsetAdd(node->buffer, data_offset, sizeof(n32));
-                        remaining_length -= sizeof(n32);
-                    }
-                    
-                    /* Write length */
-                    write_len += sizeof(n32);
+    resetStringInfo(buf);
 
+    /* MsgType, and room for the length word */
+    appendStringInfoCharMacro(buf, 'D');
+    if (PG_PROTOCOL_MAJOR(FrontendProtocol) >= 3)
+    {
+        n32 = 0;
+        appendBinaryStringInfo(buf, (char *) &n32, sizeof(n32));
+    }
 
-                    rec = DatumGetHeapTupleHeader(pval);
+    /* Number of parameter values */
+    n16 = htons(tdesc->natts | (sender->out_binary ? DATAROW_BINARY_FLAG : 0));
+    appendBinaryStringInfo(buf, (char *) &n16, sizeof(n16));
 
-                    /* Extract type info from the tuple itself */
-                    tupType = HeapTupleHeaderGetTypeId(rec);
-                    tupTypmod = HeapTupleHeaderGetTypMod(rec);
-                    tupdesc = lookup_rowtype_tupdesc(tupType, tupTypmod);
+    for (i = 0; i < tdesc->natts; i++)
+    {
+        DataRowColumnOut *col = &sender->out_cols[i];
 
-                    FormRowDescriptionMessage(tupdesc, NULL, NULL, &tupdesc_data);
+        if (slot->tts_isnull[i])
+        {
+            n32 = htonl(-1);
+            appendBinaryStringInfo(buf, (char *) &n32, sizeof(n32));
+            continue;
+        }
 
-                    ReleaseTupleDesc(tupdesc);
+        if (sender->out_binary)
+        {
+            DataRowAppendBinaryValue(buf, tdesc->attrs[i], &col->finfo,
+                                     slot->tts_values[i]);
+            continue;
+        }
 
-                    len = tupdesc_data.len;
-                    n32 = htonl(len);
+        /*
+         * column is composite type, need to send tupledesc to remote node
+         */
+        if (col->typid == RECORDOID)
+        {
+            HeapTupleHeader rec;
+            TupleDesc       tupdesc;
+            StringInfoData  tupdesc_data;
 
-                    /* write rowDesctiption */
-                    if (write_len + len +sizeof(n32) >= node->buffer->m_Length - 1)
-                    {
-                        appendBinaryStringInfo(&data, (char *) &n32, sizeof(n32));
-                        appendBinaryStringInfo(&data, tupdesc_data.data, len);
-                    }
-                    else
-                    {
-                        if (remaining_length < (sizeof(n32) + len))
-                        {
-                            int sleep_times = 0;
-                            reserve_len = (sizeof(n32) + len) + DEFAULT_RESERVE_STEP;
-                            do
-                            {
-                                ret = ReserveSpace(node->buffer, reserve_len, &tmp);
-                                if (!ret)
-                                {
-                                    break;
-                                }
-                                pg_usleep(1000L);
-                                if (!DataPumpNodeCheck(sndctl, nodeindex))
-                                {
-                                    ReturnSpace(node->buffer, head);
-                                    pfree(data.data);
-                                    if (savecxt)
-                                    {
-                                        MemoryContextSwitchTo(savecxt);
-                                    }
-                                    elog(ERROR, "ExecFastSendDatarow:node %d status abnormal.", nodeindex);
-                                }
+            /* -2 to indicate this is composite type */
+            n32 = htonl(-2);
+            appendBinaryStringInfo(buf, (char *) &n32, sizeof(n32));
 
-                                sleep_times++;
+            rec = DatumGetHeapTupleHeader(slot->tts_values[i]);
 
-                                if (sleep_times == MAX_SLEEP_TIMES)
-                                {
-                                    ReturnSpace(node->buffer, head);
+            /* Extract type info from the tuple itself */
+            tupdesc = lookup_rowtype_tupdesc(HeapTupleHeaderGetTypeId(rec),
+                                             HeapTupleHeaderGetTypMod(rec));
+            initStringInfo(&tupdesc_data);
+            FormRowDescriptionMessage(tupdesc, NULL, NULL, &tupdesc_data);
+            ReleaseTupleDesc(tupdesc);
 
-                                    pfree(data.data);
+            n32 = htonl(tupdesc_data.len);
+            appendBinaryStringInfo(buf, (char *) &n32, sizeof(n32));
+            appendBinaryStringInfo(buf, tupdesc_data.data, tupdesc_data.len);
+        }
 
-                                    if (savecxt)
-                                    {
-                                        MemoryContextSwitchTo(savecxt);
-                                    }
-                                    
-                                    return false;
-                                }
-                            }while(ret == -1);
+        DataPumpEncodeColumn(col, slot->tts_values[i], buf);
+    }
 
-                            /* sanity check */
-                            if ((remaining_length + data_offset) % node->buffer->m_Length != tmp)
-                            {
-                                ReturnSpace(node->buffer, head);
-                                pfree(data.data);
-                                if (savecxt)
-                                {
-                                    MemoryContextSwitchTo(savecxt);
-                                }
-                                elog(ERROR, "mismatch in Fast end.");
-                            }
-                            
-                            remaining_length += reserve_len;
-                        }
-                        FillReserveSpace(node->buffer, data_offset, (char *) &n32, sizeof(n32));
-                        data_offset = BufferOffsetAdd(node->buffer, data_offset, sizeof(n32));
-                        remaining_length -= sizeof(n32);
-                    
-                        FillReserveSpace(node->buffer, data_offset, tupdesc_data.data, len);
-                        data_offset = BufferOffsetAdd(node->buffer, data_offset, len);
-                        remaining_length -= len;
-                    }
-                    
-                    write_len += sizeof(n32);
-                    write_len += len;
+    /* Data length, exclude command tag. */
+    if (PG_PROTOCOL_MAJOR(FrontendProtocol) >= 3)
+    {
+        n32 = htonl(buf->len - 1);
+        memcpy(buf->data + 1, &n32, sizeof(n32));
+    }
+}
 
-                    /* MemoryContextReset will do it */
-                    //pfree(tupdesc_data.data);
-                }
-                
-                /* Convert Datum to string */
-                pstring = OidOutputFunctionCall(typOutput, pval);
+/*
+ * Copy a whole message into the buffer and make it visible to the sender
+ * thread.  The caller has made sure it fits.  Only the producer moves m_Head,
+ * so the copy needs no lock and head and border are published together under
+ * a single spinlock acquisition.  Returns the amount of data now buffered.
+ *
+ * This is done per row rather than per batch of rows: the lock is shared with
+ * the sender thread of the node only, and holding rows back would need a
+ * flush on every path that finishes or abandons the cursor.
+ */
+static uint32
+PutDataRow(DataPumpBuf *buf, char *data, uint32 len)
+{
+    uint32 head = buf->m_Head;
+    uint32 size;
 
-                /* copy data to the buffer */
-                len = strlen(pstring);
-                n32 = htonl(len);
-                #if 0
-                appendBinaryStringInfo(&buf, (char *) &n32, 4);
-                appendBinaryStringInfo(&buf, pstring, len);
-                #endif
+    FillReserveSpace(buf, head, data, len);
+    head = (head + len) % buf->m_Length;
 
-                if (write_len + sizeof(n32) + len >= node->buffer->m_Length - 1)
-                {
-                    appendBinaryStringInfo(&data, (char *) &n32, 4);
-                    appendBinaryStringInfo(&data, pstring, len);
-                }
-                else
-                {
-                    /* Reserve space. */
-                    if (remaining_length < (sizeof(n32) + len))
-                    {
-                        int sleep_times = 0;
-                        
-                        reserve_len = (sizeof(n32) + len) + DEFAULT_RESERVE_STEP;
-                        do
-                        {
-                            ret = ReserveSpace(node->buffer, reserve_len, &tmp);
-                            if (!ret)
-                            {
-                                break;
-                            }
-                            pg_usleep(1000L);
-                            if (!DataPumpNodeCheck(sndctl, nodeindex))
-                            {
-                                ReturnSpace(node->buffer, head);
-                                pfree(data.data);
-                                if (savecxt)
-                                {
-                                    MemoryContextSwitchTo(savecxt);
-                                }
-                                elog(ERROR, "ExecFastSendDatarow:node %d status abnormal.", nodeindex);
-                            }
+    spinlock_lock(&(buf->pointerlock));
+    buf->m_Head   = head;
+    buf->m_Border = head;
+    size = (buf->m_Tail <= head) ? head - buf->m_Tail : buf->m_Length - buf->m_Tail + head;
+    spinlock_unlock(&(buf->pointerlock));
 
-                            sleep_times++;
+    return size;
+}
 
-                            if (sleep_times == MAX_SLEEP_TIMES)
-                            {
-                                ReturnSpace(node->buffer, head);
+bool
+ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryContext tmpcxt)
+{// #lizard forgives
+#define DEFAULT_RESERVE_STEP 128
+#define MAX_SLEEP_TIMES 50
+    uint32          tuple_len       = 0;
+    uint32          buffered        = 0;
+    int             sleep_times     = 0;
+    DataPumpSenderControl *sender   = NULL;
+    DataPumpNodeControl   *node     = NULL;
+    StringInfo      data;
+    MemoryContext   savecxt = NULL;
 
-                                pfree(data.data);
+    sender   = (DataPumpSenderControl*)sndctl;
+    node     = &sender->nodes[nodeindex];
 
-                                pfree(pstring);
+    /* Estimate the length from the largest tuple sent so far. */
+    tuple_len = 1; /* msg type 'D' */
+    if (PG_PROTOCOL_MAJOR(FrontendProtocol) >= 3)
+    {
+        tuple_len += 4;
+    }
+    if (0 == sender->tuple_len)
+    {
+        sender->tuple_len = DEFAULT_RESERVE_STEP;
+    }
+    tuple_len += sender->tuple_len;
 
-                                if (savecxt)
-                                {
-                                    MemoryContextSwitchTo(savecxt);
-                                }
-                                
-                                return false;
-                            }
-                        }while(ret == -1);
-                        /* sanity check */
-                        if ((remaining_length + data_offset) % node->buffer->m_Length != tmp)
-                        {
-                            ReturnSpace(node->buffer, head);
-                            pfree(data.data);
-                            if (savecxt)
-                            {
-                                MemoryContextSwitchTo(savecxt);
-                            }
-                            elog(ERROR, "mismatch in Fast end.");
-                        }
-                        
-                        remaining_length += reserve_len;
-                    }
-                    
-                    /* Data length */
-                    FillReserveSpace(node->buffer, data_offset, (char *) &n32, sizeof(n32));
-                    data_offset = BufferOffsetAdd(node->buffer, data_offset, sizeof(n32));
-                    remaining_length -= sizeof(n32);
+    if (FreeSpace(node->buffer) <= tuple_len)
+    {
+        /* Not enough space, wakeup sender. */
+        DataPumpWakeupSender(sndctl, nodeindex);
+        if (!DataPumpNodeCheck(sndctl, nodeindex))
+        {
+            elog(ERROR, "ExecFastSendDatarow:node %d status abnormal.", nodeindex);
+        }
+        return false;
+    }
 
-                    /* Data self */
-                    FillReserveSpace(node->buffer, data_offset, pstring, len);
-                    data_offset = BufferOffsetAdd(node->buffer, data_offset, len);
-                    remaining_length -= len;
-                }
+    if (!DataPumpRowEncoderMatches(sender, slot->tts_tupleDescriptor))
+    {
+        DataPumpInitRowEncoder(sender, slot->tts_tupleDescriptor);
+    }
 
-                /* MemoryContextReset will do it */
-                //pfree(pstring);
-                //pstring = NULL;
-                
-                /* Write length */
-                write_len += sizeof(n32);
+    /* ensure we have all values */
+    slot_getallattrs(slot);
 
-                /* Write length */
-                write_len += len;
-            }
-        }
+    /* if temporary memory context is specified reset it */
+    if (tmpcxt)
+    {
+        MemoryContextReset(tmpcxt);
+        savecxt = MemoryContextSwitchTo(tmpcxt);
+    }
 
-        #if 0
-        /* restore memory context to allocate result */
-        if (savecxt)
-        {
-            MemoryContextSwitchTo(savecxt);
-        }
+    /* Encode the whole row first, then copy it into the buffer in one go. */
+    data = &sender->row_buf;
+    DataPumpEncodeDataRow(sender, slot, data);
 
-        /* copy data to the buffer */
-        datarow = (RemoteDataRow) palloc(sizeof(RemoteDataRowData) + buf.len);
-        datarow->msgnode = InvalidOid;
-        datarow->msglen = buf.len;
-        memcpy(datarow->msg, buf.data, buf.len);
-        pfree(buf.data);
-        #endif
+    if (savecxt)
+    {
+        MemoryContextSwitchTo(savecxt);
+    }
 
-        /* Write data length, we reserve data above. */
-        n32 = htonl(write_len - 1);
-        FillReserveSpace(node->buffer, leng_ptr, (char *)&n32, sizeof(n32));
-        
-        /* Return space if needed. */
-        if (remaining_length)
-        {
-            ReturnSpace(node->buffer, data_offset);
-        }        
+    if (data->len >= node->buffer->m_Length - 1)
+    {
+        /* Larger than the whole buffer, stream it through. */
+        int data_len = data->len;
 
-        if (data.len)
+        data->cursor = 0;
+        while (data_len)
         {
-            //int sleep_times = 0;
-            int data_len = data.len;
-            data.cursor = 0;
-            
-            while (data_len)
+            uint32 len = FreeSpace(node->buffer);
+
+            if (len)
             {
-                uint32 len = FreeSpace(node->buffer);
+                uint32 write_len = data_len > len ? len : data_len;
 
-                if (len)
-                {
-                    uint32 write_len = data_len > len ? len : data_len;
-                        
-                    PutData(node->buffer, data.data + data.cursor, write_len);
+                PutData(node->buffer, data->data + data->cursor, write_len);
 
-                    data.cursor = data.cursor + write_len;
+                data->cursor = data->cursor + write_len;
 
-                    data_len = data_len - write_len;
-                }
-                else
+                data_len = data_len - write_len;
+            }
+            else
+            {
+                DataPumpWakeupSender(sndctl, nodeindex);
+                pg_usleep(50L);
+                if (!DataPumpNodeCheck(sndctl, nodeindex))
                 {
-                    DataPumpWakeupSender(sndctl, nodeindex);
-                    pg_usleep(50L);
-                    if (!DataPumpNodeCheck(sndctl, nodeindex))
-                    {
-                        pfree(data.data);
-                        if (savecxt)
-                        {
-                            MemoryContextSwitchTo(savecxt);
-                        }
-                        elog(ERROR, "ExecFastSendDatarow:node %d status abnormal.", nodeindex);
-                    }
-
-#if 0
-                    sleep_times++;
-
-                    if (sleep_times == MAX_SLEEP_TIMES)
-                    {
-                        ReturnSpace(node->buffer, head);
-
-                        pfree(data.data);
-                        
-                        return false;
-                    }
-#endif
+                    elog(ERROR, "ExecFastSendDatarow:node %d status abnormal.", nodeindex);
                 }
             }
         }
-        else
+        SetBorder(node->buffer);
+    }
+    else
+    {
+        /* The row may be longer than estimated, wait a little for space. */
+        while (FreeSpace(node->buffer) < (uint32) data->len)
         {
-            /* Big enough, send data. */
-            if (DataSize(node->buffer) > g_SndBatchSize * 1024)
-            {    
-                DataPumpWakeupSender(sndctl, nodeindex);
-            }
-            else
+            DataPumpWakeupSender(sndctl, nodeindex);
+            pg_usleep(1000L);
+            if (!DataPumpNodeCheck(sndctl, nodeindex))
             {
-                SetBorder(node->buffer);
+                elog(ERROR, "ExecFastSendDatarow:node %d status abnormal.", nodeindex);
             }
-        }
 
-        if (!data.len)
-        {
-            /* Save max tuple_len */
-            sender->tuple_len = sender->tuple_len > (write_len - 5) ? sender->tuple_len : (write_len - 5);
+            if (++sleep_times == MAX_SLEEP_TIMES)
+            {
+                return false;
+            }
         }
 
-        /* MemoryContextReset will do it */
-        //pfree(data.data);
+        buffered = PutDataRow(node->buffer, data->data, data->len);
 
-        if (savecxt)
+        /* Big enough, send data. */
+        if (buffered > g_SndBatchSize * 1024)
         {
-            MemoryContextSwitchTo(savecxt);
+            DataPumpWakeupSender(sndctl, nodeindex);
         }
-        
-        node->ntuples++;
-        node->nfast_send++;
-        return true;
-    }
-    else
-    {
-        /* Not enough space, wakeup sender. */
-        DataPumpWakeupSender(sndctl, nodeindex);
-        if (!DataPumpNodeCheck(sndctl, nodeindex))
+
+        /* Save max tuple_len */
+        if (data->len - 5 > sender->tuple_len)
         {
-            elog(ERROR, "ExecFastSendDatarow:node %d status abnormal.", nodeindex);
+            sender->tuple_len = data->len - 5;
         }
-        return false;
     }
+
+    node->ntuples++;
+    node->nfast_send++;
+    return true;
 }
 
 void DataPumpWakeupSender(void *sndctl, int32 nodeindex)
@@ -9472,3 +9966,458 @@ SqueueName(SharedQueue sq)
 {
 	return sq->sq_key;
 }
+
+#ifdef __OPENTENBASE__
+/*
+ * Counters of compressed redistribution streams sent from this node.
+ */
+Datum
+pg_stat_get_squeue_compression(PG_FUNCTION_ARGS)
+{
+#define SQUEUE_COMPRESS_STAT_COLUMNS 5
+    TupleDesc   tupdesc;
+    Datum       values[SQUEUE_COMPRESS_STAT_COLUMNS];
+    bool        nulls[SQUEUE_COMPRESS_STAT_COLUMNS];
+    uint64      raw_bytes;
+    uint64      sent_bytes;
+
+    /* this had better match function's declaration in pg_proc.h */
+    tupdesc = CreateTemplateTupleDesc(SQUEUE_COMPRESS_STAT_COLUMNS, false);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 1, "streams",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 2, "frames",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 3, "raw_bytes",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 4, "sent_bytes",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 5, "ratio",
+                       FLOAT8OID, -1, 0);
+    BlessTupleDesc(tupdesc);
+    MemSet(nulls, false, sizeof(nulls));
+
+    raw_bytes  = pg_atomic_read_u64(&CompressStats->raw_bytes);
+    sent_bytes = pg_atomic_read_u64(&CompressStats->sent_bytes);
+
+    values[0] = Int64GetDatum(pg_atomic_read_u64(&CompressStats->streams));
+    values[1] = Int64GetDatum(pg_atomic_read_u64(&CompressStats->frames));
+    values[2] = Int64GetDatum(raw_bytes);
+    values[3] = Int64GetDatum(sent_bytes);
+    values[4] = Float8GetDatum(sent_bytes ? (double) raw_bytes / sent_bytes : 0);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+#endif
+
+#ifdef __OPENTENBASE__
+/*
+ * Runtime filters.
+ *
+ * A hash join consuming a redistribution builds its hash table first and may
+ * then send a Bloom filter of the inner hash values to the nodes producing
+ * its outer side.  The message arrives at the backend serving the consumer's
+ * connection, which is the producer itself for the SELF consumer and a
+ * consumer proxy otherwise.  That backend copies the filter into a DSM
+ * segment and publishes the handle in the shared queue; the producer maps
+ * the segment when it notices the handle and from then on drops the rows
+ * the filter says cannot match.  Filters are an optimization only: one that
+ * comes late, or not at all, costs nothing but the rows already sent.
+ */
+#define RUNTIME_FILTER_MAGIC            0x52544631
+/* how many rows the producer sends between looks for a new filter */
+#define RUNTIME_FILTER_CHECK_INTERVAL   1024
+
+typedef struct RuntimeFilterHeader
+{
+    uint32      magic;
+    char        sq_key[SQUEUE_KEYSIZE]; /* queue the filter was pushed to */
+    int         nkeys;
+    AttrNumber  attnos[SQUEUE_RUNTIME_FILTER_MAX_KEYS];
+    Oid         keytypes[SQUEUE_RUNTIME_FILTER_MAX_KEYS];
+    Size        filter_size;
+    /* Bloom filter follows, MAXALIGN'ed */
+} RuntimeFilterHeader;
+
+#define RuntimeFilterGetBloom(hdr) \
+    ((bloom_filter *) ((char *) (hdr) + MAXALIGN(sizeof(RuntimeFilterHeader))))
+
+/* Producer side state of the filter of one consumer */
+typedef struct RuntimeFilterState
+{
+    bloom_filter *filter;       /* NULL until the consumer pushed one */
+    bool        disabled;       /* the pushed filter can not be used */
+    uint32      nchecks;        /* rows sent since the last look */
+    uint32      generation;     /* runtime_filter_generation when mapped */
+    int         nkeys;
+    AttrNumber  attnos[SQUEUE_RUNTIME_FILTER_MAX_KEYS];
+    FmgrInfo    hashfuncs[SQUEUE_RUNTIME_FILTER_MAX_KEYS];
+} RuntimeFilterState;
+
+typedef struct RuntimeFilterCacheData
+{
+    SharedQueue squeue;
+    MemoryContext mcxt;         /* where the hash functions' data live */
+    int         nstates;        /* consumers of the queue plus SELF */
+    RuntimeFilterState states[FLEXIBLE_ARRAY_MEMBER];
+} RuntimeFilterCacheData;
+
+/* segments mapped by this backend, detached at the end of transaction */
+static List *runtime_filter_segments = NIL;
+/* bumped when they are detached, so producers stop using them */
+static uint32 runtime_filter_generation = 0;
+/* the connection is gone, do not poll it any more */
+static bool runtime_filter_peer_gone = false;
+/* a Flush message was consumed while polling and must be honoured */
+static bool runtime_filter_flush_pending = false;
+/* the last poll drained the connection, so it is worth waiting on it */
+static bool runtime_filter_drained = false;
+
+static void
+RememberRuntimeFilterSegment(dsm_segment *seg)
+{
+    MemoryContext oldcxt;
+
+    dsm_pin_mapping(seg);
+    oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+    runtime_filter_segments = lappend(runtime_filter_segments, seg);
+    MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * Handle a runtime filter message received from the consumer node.
+ */
+void
+SharedQueueSetRuntimeFilter(StringInfo msg)
+{
+    const char *portal_name;
+    RuntimeFilterHeader hdr;
+    bloom_filter bloom;
+    const char *data;
+    int         len;
+    int         i;
+    Portal      portal;
+    SharedQueue squeue;
+    int         myindex;
+    dsm_segment *seg;
+    RuntimeFilterHeader *shared;
+
+    portal_name = pq_getmsgstring(msg);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = RUNTIME_FILTER_MAGIC;
+    hdr.nkeys = pq_getmsgint(msg, 2);
+    if (hdr.nkeys < 1 || hdr.nkeys > SQUEUE_RUNTIME_FILTER_MAX_KEYS)
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("invalid number of runtime filter keys: %d",
+                        hdr.nkeys)));
+    for (i = 0; i < hdr.nkeys; i++)
+    {
+        hdr.attnos[i] = pq_getmsgint(msg, 2);
+        hdr.keytypes[i] = pq_getmsgint(msg, 4);
+    }
+    len = pq_getmsgint(msg, 4);
+    if (len < (int) offsetof(bloom_filter, bitset) ||
+        len > (int) offsetof(bloom_filter, bitset) + SQUEUE_RUNTIME_FILTER_MAX_BYTES)
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("invalid runtime filter length: %d", len)));
+    data = pq_getmsgbytes(msg, len);
+    pq_getmsgend(msg);
+
+    memcpy(&bloom, data, offsetof(bloom_filter, bitset));
+    if (!bloom_check_size(&bloom, len))
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("invalid runtime filter for portal \"%s\"",
+                        portal_name)));
+
+    /* The query may be over already, then there is nothing to filter */
+    portal = GetPortalByName(portal_name);
+    if (!PortalIsValid(portal) || portal->queryDesc == NULL ||
+        portal->queryDesc->squeue == NULL)
+        return;
+    squeue = portal->queryDesc->squeue;
+    myindex = portal->queryDesc->myindex;
+
+    if (dynamic_shared_memory_type == DSM_IMPL_NONE)
+        return;
+
+    seg = dsm_create(MAXALIGN(sizeof(RuntimeFilterHeader)) + len,
+                     DSM_CREATE_NULL_IF_MAXSEGMENTS);
+    if (seg == NULL)
+        return;
+    RememberRuntimeFilterSegment(seg);
+
+    shared = (RuntimeFilterHeader *) dsm_segment_address(seg);
+    StrNCpy(hdr.sq_key, squeue->sq_key, SQUEUE_KEYSIZE);
+    hdr.filter_size = len;
+    memcpy(shared, &hdr, sizeof(hdr));
+    memcpy(RuntimeFilterGetBloom(shared), data, len);
+
+    if (myindex == -1)
+    {
+        LWLockAcquire(squeue->sq_sync->sqs_producer_lwlock, LW_EXCLUSIVE);
+        squeue->sq_self_filter = dsm_segment_handle(seg);
+        LWLockRelease(squeue->sq_sync->sqs_producer_lwlock);
+    }
+    else
+    {
+        LWLock     *clwlock = squeue->sq_sync->sqs_consumer_sync[myindex].cs_lwlock;
+
+        LWLockAcquire(clwlock, LW_EXCLUSIVE);
+        squeue->sq_consumers[myindex].cs_filter = dsm_segment_handle(seg);
+        LWLockRelease(clwlock);
+    }
+
+    elog(DEBUG1, "SQueue %s, consumer %d got runtime filter of %d bytes, "
+         "%d keys", squeue->sq_key, myindex, len, hdr.nkeys);
+}
+
+/*
+ * Can the connection to the consumer node be polled for runtime filters now?
+ * Never with runtime filters turned off, the connection is then left alone
+ * entirely.
+ */
+static bool
+RuntimeFilterCanPoll(void)
+{
+    return enable_runtime_bloom_filter &&
+        IsConnFromDatanode() && whereToSendOutput == DestRemote &&
+        MyProcPort != NULL && !runtime_filter_peer_gone &&
+        !pq_is_reading_msg();
+}
+
+/*
+ * Should a consumer waiting for tuples wake up on data from its connection?
+ * Not if a message for the main loop is waiting to be read.
+ */
+static bool
+RuntimeFilterCanWait(void)
+{
+    return RuntimeFilterCanPoll() && runtime_filter_drained;
+}
+
+/*
+ * Process the runtime filter messages the consumer node sent while we are
+ * busy executing the query.  Any other message is left for PostgresMain,
+ * except Flush, which only asks for the output to be sent and is remembered.
+ */
+void
+SharedQueuePollRuntimeFilter(void)
+{
+    unsigned char c;
+    int         r;
+
+    if (!RuntimeFilterCanPoll())
+        return;
+
+    for (;;)
+    {
+        StringInfoData msg;
+
+        r = pq_peekbyte_if_available(&c);
+        runtime_filter_drained = (r == 0);
+        if (r == EOF)
+        {
+            /* let the main loop find out the peer is gone */
+            runtime_filter_peer_gone = true;
+            return;
+        }
+        if (r == 0 ||
+            (c != SQUEUE_RUNTIME_FILTER_MSG && c != 'H'))
+            return;
+
+        initStringInfo(&msg);
+        pq_startmsgread();
+        (void) pq_getbyte();
+        if (pq_getmessage(&msg, SQUEUE_RUNTIME_FILTER_MAX_BYTES + 1024))
+            ereport(FATAL,
+                    (errcode(ERRCODE_CONNECTION_FAILURE),
+                     errmsg("unexpected EOF on datanode connection")));
+        if (c == 'H')
+            runtime_filter_flush_pending = true;
+        else
+            SharedQueueSetRuntimeFilter(&msg);
+        pfree(msg.data);
+    }
+}
+
+/*
+ * Returns true once if a Flush message was consumed by
+ * SharedQueuePollRuntimeFilter since the last call.
+ */
+bool
+SharedQueueRuntimeFilterFlushPending(void)
+{
+    bool        result = runtime_filter_flush_pending;
+
+    runtime_filter_flush_pending = false;
+    return result;
+}
+
+/*
+ * Set up the producer's cache of the runtime filters of the queue consumers.
+ */
+RuntimeFilterCache
+SharedQueueRuntimeFilterCacheCreate(SharedQueue squeue)
+{
+    RuntimeFilterCache cache;
+    int         nstates = squeue->sq_nconsumers + 1;
+
+    cache = (RuntimeFilterCache)
+        palloc0(offsetof(RuntimeFilterCacheData, states) +
+                nstates * sizeof(RuntimeFilterState));
+    cache->squeue = squeue;
+    cache->mcxt = CurrentMemoryContext;
+    cache->nstates = nstates;
+
+    return cache;
+}
+
+/*
+ * Map the filter the consumer pushed, if any.  Returns true if the filter can
+ * be used from now on.
+ */
+static bool
+RuntimeFilterAttach(RuntimeFilterCache cache, int consumerIdx,
+                    RuntimeFilterState *state, TupleDesc tupdesc)
+{
+    SharedQueue squeue = cache->squeue;
+    dsm_handle  handle;
+    dsm_segment *seg;
+    RuntimeFilterHeader *hdr;
+    int         i;
+
+    if (consumerIdx == SQ_CONS_SELF)
+        handle = squeue->sq_self_filter;
+    else
+        handle = squeue->sq_consumers[consumerIdx].cs_filter;
+    if (handle == DSM_HANDLE_INVALID)
+        return false;
+
+    /* the segment was completely written before the handle was published */
+    pg_read_barrier();
+
+    /* we may have created the segment ourselves for the SELF consumer */
+    seg = dsm_find_mapping(handle);
+    if (seg == NULL)
+    {
+        seg = dsm_attach(handle);
+        if (seg == NULL)
+        {
+            /* the consumer is done with the query already */
+            state->disabled = true;
+            return false;
+        }
+        RememberRuntimeFilterSegment(seg);
+    }
+
+    hdr = (RuntimeFilterHeader *) dsm_segment_address(seg);
+    if (hdr->magic != RUNTIME_FILTER_MAGIC ||
+        strncmp(hdr->sq_key, squeue->sq_key, SQUEUE_KEYSIZE) != 0)
+    {
+        state->disabled = true;
+        return false;
+    }
+
+    for (i = 0; i < hdr->nkeys; i++)
+    {
+        AttrNumber  attno = hdr->attnos[i];
+        TypeCacheEntry *typentry;
+
+        if (attno < 1 || attno > tupdesc->natts ||
+            TupleDescAttr(tupdesc, attno - 1)->atttypid != hdr->keytypes[i])
+        {
+            state->disabled = true;
+            return false;
+        }
+
+        typentry = lookup_type_cache(hdr->keytypes[i], TYPECACHE_HASH_PROC);
+        if (!OidIsValid(typentry->hash_proc))
+        {
+            state->disabled = true;
+            return false;
+        }
+        fmgr_info_cxt(typentry->hash_proc, &state->hashfuncs[i], cache->mcxt);
+        state->attnos[i] = attno;
+    }
+    state->nkeys = hdr->nkeys;
+    state->filter = RuntimeFilterGetBloom(hdr);
+    state->generation = runtime_filter_generation;
+
+    elog(DEBUG1, "SQueue %s, producer filters rows of consumer %d",
+         squeue->sq_key, consumerIdx);
+    return true;
+}
+
+/*
+ * Should the producer send the tuple to the consumer?  Returns false if the
+ * runtime filter of the consumer says the tuple can not be joined there.
+ * Hash functions are called in the current memory context.
+ */
+bool
+SharedQueueRuntimeFilterPass(RuntimeFilterCache cache, int consumerIdx,
+                             TupleTableSlot *slot)
+{
+    RuntimeFilterState *state;
+    uint32      hashkey = 0;
+    int         i;
+
+    if (consumerIdx == SQ_CONS_SELF)
+        state = &cache->states[cache->nstates - 1];
+    else if (consumerIdx >= 0 && consumerIdx < cache->nstates - 1)
+        state = &cache->states[consumerIdx];
+    else
+        return true;
+
+    if (state->filter == NULL)
+    {
+        if (state->disabled ||
+            (state->nchecks++ % RUNTIME_FILTER_CHECK_INTERVAL) != 0)
+            return true;
+        if (!RuntimeFilterAttach(cache, consumerIdx, state,
+                                 slot->tts_tupleDescriptor))
+            return true;
+    }
+    else if (state->generation != runtime_filter_generation)
+    {
+        /* the transaction ended and the filter is unmapped */
+        state->filter = NULL;
+        state->disabled = true;
+        return true;
+    }
+
+    /* keep in sync with ExecHashGetHashValue */
+    for (i = 0; i < state->nkeys; i++)
+    {
+        Datum       keyval;
+        bool        isnull;
+
+        hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+        keyval = slot_getattr(slot, state->attnos[i], &isnull);
+        /* only strict join operators are filtered, NULL never matches */
+        if (isnull)
+            return false;
+        hashkey ^= DatumGetUInt32(FunctionCall1(&state->hashfuncs[i], keyval));
+    }
+
+    return !bloom_lacks_hash(state->filter, hashkey);
+}
+
+/*
+ * Unmap the runtime filters at the end of transaction.
+ */
+void
+AtEOXact_SharedQueueFilters(void)
+{
+    ListCell   *lc;
+
+    foreach(lc, runtime_filter_segments)
+        dsm_detach((dsm_segment *) lfirst(lc));
+    list_free(runtime_filter_segments);
+    runtime_filter_segments = NIL;
+    runtime_filter_generation++;
+}
+#endif
@@ -1465,6 +1465,39 @@ ema_get_eme_extract(Relation rel, ExtentID eid,
     UnlockReleaseBuffer(buf);
 }
 
+/*
+ * Look up the shard an extent belongs to without complaining about missing
+ * EMA pages. Returns false if the extent is beyond the EMA fork or is not
+ * occupied, in which case the caller should fall back to reading the heap.
+ */
+bool
+ema_get_eme_shardid(Relation rel, ExtentID eid, ShardID *sid)
+{
+    EMAAddress    addr;
+    Buffer         buf;
+    EMAPage        ema_page;
+    bool        found = false;
+
+    if (eid >= MAX_EXTENTS)
+        return false;
+
+    addr = ema_eid_to_address(eid);
+    buf = extent_readbuffer(rel, addr.physical_page_number, false);
+    if (BufferIsInvalid(buf))
+        return false;
+
+    LockBuffer(buf, BUFFER_LOCK_SHARE);
+    ema_page = BufferGetEMAPage(buf);
+    if (addr.local_idx < ema_page->n_emes
+        && ema_page->ema[addr.local_idx].is_occupied)
+    {
+        *sid = (ShardID)ema_page->ema[addr.local_idx].shardid;
+        found = true;
+    }
+    UnlockReleaseBuffer(buf);
+
+    return found;
+}
 
 void 
 ema_page_get_eme_extract(Page pg, int32 local_index, 
@@ -19,15 +19,18 @@
 
 #include "access/clog.h"
 #include "access/commit_ts.h"
+#include "access/gtm.h"
 #include "access/heapam.h"
 #include "access/multixact.h"
 #include "access/nbtree.h"
 #include "access/subtrans.h"
 #include "access/twophase.h"
 #include "commands/async.h"
+#include "commands/sequence.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #ifdef PGXC
+#include "pgxc/execRemote.h"
 #include "pgxc/nodemgr.h"
 #include "postmaster/clustermon.h"
 #endif
@@ -168,6 +171,9 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 #ifdef __OPENTENBASE__        
         size = add_size(size, GTSTrackSize());
         size = add_size(size, RecoveryGTMHostSize());
+        size = add_size(size, GTSBatchShmemSize());
+        size = add_size(size, RemoteCommitStatsShmemSize());
+        size = add_size(size, SeqCacheShmemSize());
 #endif
 #ifdef __OPENTENBASE_DEBUG__
         size = add_size(size, SnapTableShmemSize());
@@ -318,6 +324,9 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 #ifdef __OPENTENBASE__
     GTSTrackInit();
     RecoveryGTMHostInit();
+    GTSBatchShmemInit();
+    RemoteCommitStatsShmemInit();
+    SeqCacheShmemInit();
 #endif
 
 #ifdef __OPENTENBASE_DEBUG__
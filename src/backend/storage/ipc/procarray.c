@@ -4139,7 +4139,7 @@ GetGlobalTimestampFromGTM(Snapshot snapshot)
 {
     GlobalTimestamp start_ts;
 
-    start_ts = (GlobalTimestamp) GetGlobalTimestampGTM();
+    start_ts = (GlobalTimestamp) GetSnapshotGlobalTimestampGTM();
     snapshot->start_ts = start_ts;
     
     if (!GlobalTimestampIsValid(start_ts))
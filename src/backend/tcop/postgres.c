@@ -662,6 +662,7 @@ SocketBackend(StringInfo inBuf)
         case 'N':
 		case 'U':				/* coord info: coord_pid and top_xid */
 		case 'o':               /* global session id */
+        case 'y':               /* runtime filter */
 #endif
         case 'M':                /* Command ID */
         case 'g':                /* GXID */
@@ -5440,6 +5441,11 @@ PostgresMain(int argc, char *argv[],
          * conditional since we don't want, say, reads on behalf of COPY FROM
          * STDIN doing the same thing.)
          */
+#ifdef __OPENTENBASE__
+        /* Honour a Flush consumed while polling for runtime filters */
+        if (SharedQueueRuntimeFilterFlushPending())
+            pq_flush();
+#endif
         DoingCommandRead = true;
 #ifdef __OPENTENBASE__
         RESUME_POOLER_RELOAD();
@@ -5853,6 +5859,11 @@ PostgresMain(int argc, char *argv[],
                  */
                 break;
 #ifdef PGXC
+#ifdef __OPENTENBASE__
+            case 'y':            /* runtime filter */
+                SharedQueueSetRuntimeFilter(&input_message);
+                break;
+#endif
             case 'M':            /* Command ID */
                 {
                     CommandId cid = (CommandId) pq_getmsgint(&input_message, 4);
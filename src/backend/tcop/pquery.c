@@ -1412,6 +1412,10 @@ PortalRun(Portal portal, long count, bool isTopLevel, bool run_once,
                         {
                             if (!portal->queryDesc->estate->es_finished)
                                 AdvanceProducingPortal(portal, false);
+#ifdef __OPENTENBASE__
+                            /* the consumer may have pushed a runtime filter */
+                            SharedQueuePollRuntimeFilter();
+#endif
                             /* make read pointer active */
                             tuplestore_select_read_pointer(portal->holdStore, 1);
                             /* perform reads */
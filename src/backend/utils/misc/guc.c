@@ -151,6 +151,7 @@
 #ifdef __COLD_HOT__
 #include "utils/ruleutils.h"
 #include "executor/nodeAgg.h"
+#include "executor/nodeHashjoin.h"
 #include "catalog/pg_partition_interval.h"
 #endif
 
@@ -739,6 +740,7 @@ static bool assert_enabled;
 
 #ifdef __OPENTENBASE__
 bool g_enable_copy_silence = false;
+bool g_enable_copy_partial_parse = false;
 bool g_enable_user_authority_force_check = false;
 #endif
 
@@ -2482,6 +2484,63 @@ static struct config_bool ConfigureNamesBool[] =
         false,
         NULL, NULL, NULL
     },
+    {
+        {"enable_gts_batch", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Coalesce concurrent snapshot global timestamp requests into one GTM request."),
+            NULL
+        },
+        &enable_gts_batch,
+        false,
+        NULL, NULL, NULL
+    },
+    {
+        {"enable_binary_datarow", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Send redistributed tuples between nodes in binary format."),
+            gettext_noop("Saves the output and input function calls of every column, "
+                         "for rows whose columns all have a binary format.")
+        },
+        &enable_binary_datarow,
+        false,
+        NULL, NULL, NULL
+    },
+    {
+        {"enable_runtime_bloom_filter", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Pushes Bloom filters of hash join inner keys to the nodes sending the outer rows."),
+            gettext_noop("The nodes redistributing the outer side then skip "
+                         "the rows which can not find a join partner.")
+        },
+        &enable_runtime_bloom_filter,
+        false,
+        NULL, NULL, NULL
+    },
+    {
+        {"enable_session_multiplexing", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Returns datanode connections to the pool at transaction end even with prepared statements."),
+            gettext_noop("The statements are dropped on the nodes and prepared "
+                         "again on the connections the session gets next.")
+        },
+        &enable_session_multiplexing,
+        false,
+        NULL, NULL, NULL
+    },
+    {
+        {"enable_shard_route_cache", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Remember the target datanode of point statements on shard tables by distribution key hash."),
+            NULL
+        },
+        &enable_shard_route_cache,
+        true,
+        NULL, NULL, NULL
+    },
+    {
+        {"enable_shard_scan_pruning", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Restrict scans of shard tables to the shards their distribution key quals match."),
+            NULL
+        },
+        &enable_shard_scan_pruning,
+        true,
+        NULL, NULL, NULL
+    },
     {
         {"skip_gtm_catalog", PGC_POSTMASTER, CUSTOM_OPTIONS,
             gettext_noop("used to skip gtm catalog, WARNING:only for emergency purpose and only avaliable on coordinators."),
@@ -2570,6 +2629,15 @@ static struct config_bool ConfigureNamesBool[] =
         false,
         NULL, NULL, NULL
     },
+    {
+        {"enable_copy_partial_parse", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Parse only the distribution columns of COPY FROM input on coordinators."),
+            gettext_noop("The other columns are checked by the datanodes, so their errors are reported by the datanodes.")
+        },
+        &g_enable_copy_partial_parse,
+        false,
+        NULL, NULL, NULL
+    },
     {
         {"enable_user_authority_force_check", PGC_POSTMASTER, CUSTOM_OPTIONS,
             gettext_noop("control users to get the list of tables and functions which can be accessed and executed by these user."),
@@ -4420,6 +4488,18 @@ static struct config_int ConfigureNamesInt[] =
         1000, 1, INT_MAX,
         NULL, NULL, NULL
     },
+#ifdef __OPENTENBASE__
+    {
+        {"shared_sequence_cache_range", PGC_USERSET, COORDINATORS,
+            gettext_noop("The range of sequence values to ask from GTM for all sessions of the node."),
+            gettext_noop("0 keeps the sequence values cached per session. "
+                         "If CACHE parameter is larger then that is used.")
+        },
+        &shared_sequence_cache_range,
+        0, 0, INT_MAX,
+        NULL, NULL, NULL
+    },
+#endif
 
 #ifdef __OPENTENBASE__
     {
@@ -4712,6 +4792,16 @@ static struct config_int ConfigureNamesInt[] =
         8, 1, 524288,
         NULL, NULL, NULL
     },
+    {
+        {"sender_thread_compress_threshold", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Minimum size in bytes of a run of rows that datapump senders compress before sending."),
+            gettext_noop("-1 disables compression of redistribution streams."),
+            0
+        },
+        &g_SndCompressThreshold,
+        -1, -1, INT_MAX,
+        NULL, NULL, NULL
+    },
     {
         {"archive_autowake_interval", PGC_USERSET, WAL_ARCHIVING,
             gettext_noop("how often to force a poll of the archive status directory in seconds."),
@@ -4729,6 +4819,17 @@ static struct config_int ConfigureNamesInt[] =
         NULL, NULL, NULL
     },
 
+    {
+        {"remote_dml_batch_size", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Maximum number of rows of an INSERT executed on the coordinator "
+                         "sent to the datanodes before waiting for their results."),
+            gettext_noop("1 waits for every row.")
+        },
+        &remote_dml_batch_size,
+        64, 1, 1024,
+        NULL, NULL, NULL
+    },
+
     {
         {"replication_level", PGC_USERSET, CUSTOM_OPTIONS,
             gettext_noop("replication level on join to make Query more efficient."),
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/barrierdesc.c
\ No newline at end of file
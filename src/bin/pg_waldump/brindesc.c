@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/brindesc.c
\ No newline at end of file
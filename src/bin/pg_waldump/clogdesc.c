@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/clogdesc.c
\ No newline at end of file
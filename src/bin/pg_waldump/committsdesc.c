@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/committsdesc.c
\ No newline at end of file
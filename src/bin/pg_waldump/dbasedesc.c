@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/dbasedesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/extentdesc.c
\ No newline at end of file
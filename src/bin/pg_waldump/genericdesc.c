@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/genericdesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/gindesc.c
\ No newline at end of file
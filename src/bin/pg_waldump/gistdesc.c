@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/gistdesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/hashdesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/heapdesc.c
\ No newline at end of file
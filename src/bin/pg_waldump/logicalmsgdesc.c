@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/logicalmsgdesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/mxactdesc.c
\ No newline at end of file
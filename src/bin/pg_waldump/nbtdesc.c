@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/nbtdesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/relcryptdesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/relmapdesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/replorigindesc.c
\ No newline at end of file
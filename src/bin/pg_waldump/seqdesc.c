@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/seqdesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/smgrdesc.c
\ No newline at end of file
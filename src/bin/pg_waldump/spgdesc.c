@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/spgdesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/standbydesc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/tblspcdesc.c
\ No newline at end of file
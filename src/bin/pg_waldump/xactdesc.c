@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/xactdesc.c
\ No newline at end of file
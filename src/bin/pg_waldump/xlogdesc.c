@@ -0,0 +1 @@
+../../../src/backend/access/rmgrdesc/xlogdesc.c
\ No newline at end of file
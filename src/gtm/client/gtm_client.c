@@ -514,8 +514,8 @@ send_failed:
 }
 
 
-Get_GTS_Result
-get_global_timestamp(GTM_Conn *conn)
+static Get_GTS_Result
+get_global_timestamp_internal(GTM_Conn *conn, GTM_MessageType mtype)
 {// #lizard forgives
     GTM_Result    *res = NULL;
     Get_GTS_Result ret = {InvalidGlobalTimestamp,false};
@@ -523,7 +523,7 @@ get_global_timestamp(GTM_Conn *conn)
     
      /* Start the message. */
     if (gtmpqPutMsgStart('C', true, conn) ||
-        gtmpqPutInt(MSG_GETGTS, sizeof (GTM_MessageType), conn))
+        gtmpqPutInt(mtype, sizeof (GTM_MessageType), conn))
         goto send_failed;
 
     /* Finish the message. */
@@ -559,6 +559,23 @@ send_failed:
     return ret;
 }
 
+Get_GTS_Result
+get_global_timestamp(GTM_Conn *conn)
+{
+    return get_global_timestamp_internal(conn, MSG_GETGTS);
+}
+
+/*
+ * Same as get_global_timestamp(), for a timestamp that is only used as a
+ * snapshot. A GTM proxy may answer all such requests it has queued with a
+ * single timestamp, which it must not do for commit or prepare timestamps.
+ */
+Get_GTS_Result
+get_snapshot_global_timestamp(GTM_Conn *conn)
+{
+    return get_global_timestamp_internal(conn, MSG_GETGTS_SNAPSHOT);
+}
+
 
 int
 check_gtm_status(GTM_Conn *conn, int *status, GTM_Timestamp *master,XLogRecPtr *master_ptr,int *standby_count,int **slave_is_sync, GTM_Timestamp **standby
@@ -115,6 +115,7 @@ static struct enum_name message_name_tab[] =
 
     {MSG_GETGTS,    "MSG_GETGTS"},                
     {MSG_GETGTS_MULTI, "MSG_GETGTS_MULTI"},
+    {MSG_GETGTS_SNAPSHOT, "MSG_GETGTS_SNAPSHOT"},
 
     {MSG_CHECK_GTM_STATUS, "MSG_CHECK_GTM_STATUS"},
 #endif
@@ -63,6 +63,7 @@ extern int			worker_thread_number;
 #ifdef __OPENTENBASE__
 extern bool	enable_gtm_sequence_debug;
 extern int      wal_writer_delay;
+extern int      wal_commit_delay;
 extern int      checkpoint_interval;
 extern char     *archive_command;
 extern bool     archive_mode;
@@ -184,6 +185,15 @@ struct config_bool ConfigureNamesBool[] =
 		&enable_gtm_debug,
 		false, NULL, NULL, false, NULL
 	},
+	{
+		{GTM_OPTNAME_ENABLE_LOAD_BALANCE, GTMC_SIGHUP,
+		   gettext_noop("Place new connections on the least loaded service thread."),
+		   gettext_noop("Default value is on. When off, connections are assigned round-robin."),
+		   0
+		},
+		&enable_gtm_load_balance,
+		true, NULL, NULL, false, NULL
+	},
 #ifdef __XLOG__
     {
 		{GTM_OPTNAME_ARCHIVE_MODE, GTMC_STARTUP,
@@ -332,6 +342,17 @@ struct config_int ConfigureNamesInt[] =
 		100, 10, INT_MAX, NULL, NULL,
 		0, NULL
 	},
+	{
+		{
+			GTM_OPTNAME_WAL_COMMIT_DELAY, GTMC_SIGHUP,
+			gettext_noop("Microseconds a WAL flush waits for more requests to join it."),
+			NULL,
+			0
+		},
+		&wal_commit_delay,
+		0, 0, 100000, NULL, NULL,
+		0, NULL
+	},
 	{
 		{
 			GTM_OPTNAME_CHECKPOINT_INTERVAL, GTMC_STARTUP,
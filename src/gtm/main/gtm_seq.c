@@ -61,6 +61,7 @@ static bool seq_keys_equal(GTM_SequenceKey key1, GTM_SequenceKey key2);
 static bool seq_key_dbname_equal(GTM_SequenceKey nsp, GTM_SequenceKey seq);
 static GTM_SeqInfo *seq_find_seqinfo(GTM_SequenceKey seqkey);
 static int seq_release_seqinfo(GTM_SeqInfo *seqinfo);
+static int32 seq_get_state(GTM_SeqInfo *seqinfo);
 static int seq_add_seqinfo(GTM_SeqInfo *seqinfo);
 static int seq_remove_seqinfo(GTM_SeqInfo *seqinfo);
 static int seq_rename_seqinfo(GTM_SeqInfo *seqinfo, GTM_SequenceKey newkey);
@@ -85,16 +86,21 @@ static GTM_SeqInfo* GTM_FormSeqOfStore(GTM_SequenceKey seqkey);
 /*
  * Get the hash value given the sequence key
  *
- * XXX This should probably be replaced by a better hash function.
+ * FNV-1a over the key.  Sequence keys are "db.schema.name" strings that share
+ * long prefixes and differ in a few characters, a plain sum of the bytes put
+ * most of them in a handful of buckets and made those bucket locks hot.
  */
 static uint32
 seq_gethash(GTM_SequenceKey key)
 {
-    uint32 total = 0;
+    uint32 total = 2166136261u;
     int ii;
 
     for (ii = 0; ii < key->gsk_keylen; ii++)
-        total += key->gsk_key[ii];
+    {
+        total ^= (unsigned char) key->gsk_key[ii];
+        total *= 16777619u;
+    }
     return (total % SEQ_HASH_TABLE_SIZE);
 }
 
@@ -138,19 +144,24 @@ seq_find_seqinfo(GTM_SequenceKey seqkey)
         curr_seqinfo = NULL;
     }
 
+    /*
+     * Only the reference count is touched here, so take the spinlock rather
+     * than gs_lock: lookups of a hot sequence must not queue behind its
+     * nextval callers.
+     */
     if (curr_seqinfo != NULL)
     {
-        GTM_RWLockAcquire(&curr_seqinfo->gs_lock, GTM_LOCKMODE_WRITE);
+        SpinLockAcquire(&curr_seqinfo->gs_ref_lck);
         if (curr_seqinfo->gs_state != SEQ_STATE_ACTIVE)
         {
-            elog(LOG, "Sequence not active");
-            GTM_RWLockRelease(&curr_seqinfo->gs_lock);
+            SpinLockRelease(&curr_seqinfo->gs_ref_lck);
             GTM_RWLockRelease(&bucket->shb_lock);
+            elog(LOG, "Sequence not active");
             return NULL;
         }
         Assert(curr_seqinfo->gs_ref_count != SEQ_MAX_REFCOUNT);
         curr_seqinfo->gs_ref_count++;
-        GTM_RWLockRelease(&curr_seqinfo->gs_lock);
+        SpinLockRelease(&curr_seqinfo->gs_ref_lck);
     }
     GTM_RWLockRelease(&bucket->shb_lock);
 
@@ -164,6 +175,22 @@ seq_find_seqinfo(GTM_SequenceKey seqkey)
     return curr_seqinfo;
 }
 
+/*
+ * Read the state of the sequence under gs_ref_lck, which is what guards it
+ * against a concurrent drop.
+ */
+static int32
+seq_get_state(GTM_SeqInfo *seqinfo)
+{
+    int32 state;
+
+    SpinLockAcquire(&seqinfo->gs_ref_lck);
+    state = seqinfo->gs_state;
+    SpinLockRelease(&seqinfo->gs_ref_lck);
+
+    return state;
+}
+
 /*
  * Release previously grabbed reference to the structure. If the structure is
  * marked for deletion, it will be removed from the global array and released
@@ -178,7 +205,7 @@ seq_release_seqinfo(GTM_SeqInfo *seqinfo)
         elog(LOG, "seq_release_seqinfo seq: %s seq:%d, value:%zu gs_ref_count:%d begin", seqinfo->gs_key->gsk_key, seqinfo->gs_store_handle, seqinfo->gs_value, seqinfo->gs_ref_count);
     }
     
-    GTM_RWLockAcquire(&seqinfo->gs_lock, GTM_LOCKMODE_WRITE);
+    SpinLockAcquire(&seqinfo->gs_ref_lck);
     Assert(seqinfo->gs_ref_count > 0);
     seqinfo->gs_ref_count--;
 
@@ -188,7 +215,7 @@ seq_release_seqinfo(GTM_SeqInfo *seqinfo)
         remove = true;
     }
 
-    GTM_RWLockRelease(&seqinfo->gs_lock);
+    SpinLockRelease(&seqinfo->gs_ref_lck);
 
     if (enable_gtm_sequence_debug)
     {
@@ -270,13 +297,16 @@ seq_remove_seqinfo(GTM_SeqInfo *seqinfo)
     GTM_RWLockAcquire(&bucket->shb_lock, GTM_LOCKMODE_WRITE);
     GTM_RWLockAcquire(&seqinfo->gs_lock, GTM_LOCKMODE_WRITE);
 
+    SpinLockAcquire(&seqinfo->gs_ref_lck);
     if (seqinfo->gs_ref_count > 1)
     {
         seqinfo->gs_state = SEQ_STATE_DELETED;
+        SpinLockRelease(&seqinfo->gs_ref_lck);
         GTM_RWLockRelease(&seqinfo->gs_lock);
         GTM_RWLockRelease(&bucket->shb_lock);
         return EBUSY;
     }
+    SpinLockRelease(&seqinfo->gs_ref_lck);
 
     bucket->shb_list = gtm_list_delete(bucket->shb_list, seqinfo);
     GTM_RWLockRelease(&seqinfo->gs_lock);
@@ -487,6 +517,7 @@ GTM_SeqOpen(GTM_SequenceKey seqkey,
         ereport(ERROR, (ENOMEM, errmsg("Out of memory")));
 
     GTM_RWLockInit(&seqinfo->gs_lock);
+    SpinLockInit(&seqinfo->gs_ref_lck);
 
     seqinfo->gs_ref_count = 0;
     seqinfo->gs_key = seq_copy_key(seqkey);
@@ -761,6 +792,7 @@ GTM_SeqRestore(GTM_SequenceKey seqkey,
         ereport(ERROR, (ENOMEM, errmsg("Out of memory")));
 
     GTM_RWLockInit(&seqinfo->gs_lock);
+    SpinLockInit(&seqinfo->gs_ref_lck);
 
     seqinfo->gs_ref_count = 0;
     seqinfo->gs_key = seq_copy_key(seqkey);
@@ -922,7 +954,8 @@ seq_drop_with_dbkey(GTM_SequenceKey nsp)
     {
         bucket = &GTMSequences[ii];
 
-        GTM_RWLockAcquire(&bucket->shb_lock, GTM_LOCKMODE_READ);
+        /* cells are deleted below, lookups must not walk the list meanwhile */
+        GTM_RWLockAcquire(&bucket->shb_lock, GTM_LOCKMODE_WRITE);
 
         prev = NULL;
         cell = gtm_list_head(bucket->shb_list);
@@ -935,9 +968,11 @@ seq_drop_with_dbkey(GTM_SequenceKey nsp)
             {
                 GTM_RWLockAcquire(&curr_seqinfo->gs_lock, GTM_LOCKMODE_WRITE);
 
+                SpinLockAcquire(&curr_seqinfo->gs_ref_lck);
                 if (curr_seqinfo->gs_ref_count > 1)
                 {
                     curr_seqinfo->gs_state = SEQ_STATE_DELETED;
+                    SpinLockRelease(&curr_seqinfo->gs_ref_lck);
 
                     /* can not happen, be checked before called */
                     elog(LOG,"Sequence %s is in use, mark for deletion only",
@@ -951,6 +986,8 @@ seq_drop_with_dbkey(GTM_SequenceKey nsp)
                 }
                 else
                 {
+                    SpinLockRelease(&curr_seqinfo->gs_ref_lck);
+
                     /* Sequence is not is busy state, it can be deleted safely */
 
                     bucket->shb_list = gtm_list_delete_cell(bucket->shb_list, cell, prev);
@@ -2986,6 +3023,7 @@ GTM_SaveSeqInfo2(FILE *ctlf, bool isBackup)
     gtm_ListCell *elem;
     GTM_SeqInfo *seqinfo = NULL;
     int hash;
+    int32 state;
     char buffer[1024];
 
     for (hash = 0; hash < SEQ_HASH_TABLE_SIZE; hash++)
@@ -3000,7 +3038,8 @@ GTM_SaveSeqInfo2(FILE *ctlf, bool isBackup)
             if (seqinfo == NULL)
                 break;
 
-            if (seqinfo->gs_state == SEQ_STATE_DELETED)
+            state = seq_get_state(seqinfo);
+            if (state == SEQ_STATE_DELETED)
                 continue;
 
             GTM_RWLockAcquire(&seqinfo->gs_lock, GTM_LOCKMODE_READ);
@@ -3012,7 +3051,7 @@ GTM_SaveSeqInfo2(FILE *ctlf, bool isBackup)
                     seqinfo->gs_min_value, seqinfo->gs_max_value,
                     (seqinfo->gs_cycle ? 't' : 'f'),
                     (seqinfo->gs_called ? 't' : 'f'),
-                    seqinfo->gs_state);
+                    state);
 
                 GTM_RWLockRelease(&seqinfo->gs_lock);
         }
@@ -3091,7 +3130,7 @@ GTM_UpdateRestorePointSeq(void)
             if (seqinfo == NULL)
                 break;
 
-            if (seqinfo->gs_state == SEQ_STATE_DELETED)
+            if (seq_get_state(seqinfo) == SEQ_STATE_DELETED)
                 continue;
 
             GTM_RWLockAcquire(&seqinfo->gs_lock, GTM_LOCKMODE_READ);
@@ -3142,7 +3181,7 @@ GTM_CleanupSeqSession(char *coord_name, int coord_procid)
             int j;
             curr_seqinfo = (GTM_SeqInfo *) gtm_lfirst(elem);
             GTM_RWLockAcquire(&curr_seqinfo->gs_lock, GTM_LOCKMODE_WRITE);
-            if (curr_seqinfo->gs_state != SEQ_STATE_ACTIVE)
+            if (seq_get_state(curr_seqinfo) != SEQ_STATE_ACTIVE)
             {
                 GTM_RWLockRelease(&curr_seqinfo->gs_lock);
                 continue;
@@ -3376,6 +3415,7 @@ GTM_FormSeqOfStore(GTM_SequenceKey seqkey)
     }
 
     GTM_RWLockInit(&seqinfo->gs_lock);
+    SpinLockInit(&seqinfo->gs_ref_lck);
 
     seqinfo->gs_ref_count = 0;
     seqinfo->gs_key = seq_copy_key(seqkey);
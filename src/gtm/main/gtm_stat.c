@@ -118,7 +118,7 @@ GTM_UpdateStatistics(GTM_WorkerStatistics* stat_handle, GTM_MessageType mtype, u
     GTM_StatisticsCmd mCmd;
     GTM_StatisticsInfo* stat_info = NULL;
 
-    if (mtype == MSG_GETGTS)
+    if (mtype == MSG_GETGTS || mtype == MSG_GETGTS_SNAPSHOT)
     {
         mCmd = CMD_GETGTS;
     }
@@ -281,6 +281,8 @@ GTM_ThreadCreate(void *(* startroutine)(void *), int32 max_lock)
     thrinfo->register_buff = NULL;
     thrinfo->last_sync_gts = 0;
     thrinfo->stat_handle = NULL;
+    pg_atomic_init_u32(&thrinfo->thr_conn_count, 0);
+    pg_atomic_init_u64(&thrinfo->thr_request_count, 0);
     thrinfo->datapump_buff = GTM_BuildDataPumpBuf(GTM_THREAD_ERRLOG_DATAPUMP_SIZE);
 #endif
 
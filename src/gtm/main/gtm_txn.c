@@ -92,6 +92,7 @@ GTM_InitTxnManager(void)
     pg_atomic_init_u32(&GTMTransactions.gt_global_xid, FirstNormalGlobalTransactionId);
     pg_atomic_init_u64(&GTMTransactions.gt_access_ts_seq, 0);
     pg_atomic_init_u64(&GTMTransactions.gt_last_access_ts_seq, 0);
+    pg_atomic_init_u64(&GTMTransactions.gt_ts_seqlock, 0);
     /*
      * XXX The gt_oldestXid is the cluster level oldest Xid
      */
@@ -1165,19 +1166,67 @@ GetNextGlobalTransactionId(void)
 }
 
 #ifdef __OPENTENBASE__
+/*
+ * The (gt_global_timestamp, gt_last_cycle) pair is published through a
+ * sequence lock so that issuing a timestamp never blocks the service
+ * threads.  Writers are serialized by the write lock and make gt_ts_seqlock
+ * odd while they update the pair; readers retry if it was odd or changed
+ * while they were reading.  The atomic increments are full barriers.
+ */
+static inline void
+GTSClockBeginUpdate(void)
+{
+    pg_atomic_fetch_add_u64(&GTMTransactions.gt_ts_seqlock, 1);
+}
+
+static inline void
+GTSClockEndUpdate(void)
+{
+    pg_atomic_fetch_add_u64(&GTMTransactions.gt_ts_seqlock, 1);
+}
+
+static inline void
+GTSClockRead(GlobalTimestamp *base, GlobalTimestamp *cycle)
+{
+    uint64 before;
+    uint64 after;
+
+    for (;;)
+    {
+        before = pg_atomic_read_u64(&GTMTransactions.gt_ts_seqlock);
+        if (before & 1)
+            continue;
+
+        pg_read_barrier();
+        *base  = GTMTransactions.gt_global_timestamp;
+        *cycle = GTMTransactions.gt_last_cycle;
+        pg_read_barrier();
+
+        after = pg_atomic_read_u64(&GTMTransactions.gt_ts_seqlock);
+        if (before == after)
+            break;
+    }
+}
+
 GlobalTimestamp
 GetNextGlobalTimestamp(void)
 {
     GlobalTimestamp gts, now, delta, tv_sec, tv_nsec;
+    GlobalTimestamp base, cycle;
 
-    if(enable_gtm_debug)
-    {
-        AcquireWriteLock();
-    }
-    else
+    if(!enable_gtm_debug)
     {
-        AcquireReadLock();
+        /*
+         * Fast path: re-basing in SyncGlobalTimestamp() does not change
+         * base + (now - cycle), so any consistent pair gives the right
+         * answer no matter when the clock is read.
+         */
+        GTSClockRead(&base, &cycle);
+        now = GTM_TimestampGetMonotonicRaw();
+        return base + (now - cycle);
     }
+
+    AcquireWriteLock();
     
     now = GTM_TimestampGetMonotonicRawPrecise(&tv_sec, &tv_nsec);
 
@@ -1241,14 +1290,7 @@ GetNextGlobalTimestamp(void)
         
     }
     
-    if(enable_gtm_debug)
-    {
-        ReleaseWriteLock();
-    }
-    else
-    {
-        ReleaseReadLock();
-    }
+    ReleaseWriteLock();
 
     if(enable_gtm_debug)
     {
@@ -1336,8 +1378,10 @@ SyncGlobalTimestamp(void)
     }
 
     delta = now - GTMTransactions.gt_last_cycle;
+    GTSClockBeginUpdate();
     GTMTransactions.gt_global_timestamp += delta;
     GTMTransactions.gt_last_cycle = now;
+    GTSClockEndUpdate();
     gts = GTMTransactions.gt_global_timestamp;
 
     if(enable_gtm_debug)
@@ -1356,8 +1400,10 @@ void
 SetNextGlobalTimestamp(GlobalTimestamp gts)
 {
     AcquireWriteLock();
+    GTSClockBeginUpdate();
     GTMTransactions.gt_global_timestamp = gts;
     GTMTransactions.gt_last_cycle = GTM_TimestampGetMonotonicRaw();
+    GTSClockEndUpdate();
     GTMTransactions.gt_last_issue_timestamp = gts - 1;
     ReleaseWriteLock();
     
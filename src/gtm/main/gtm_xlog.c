@@ -41,6 +41,7 @@
 #include "gtm/pqformat.h"
 #include "gtm/libpq.h"
 #include "utils/pg_crc.h"
+#include "port/atomics.h"
 
 #undef MIN
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
@@ -52,6 +53,7 @@ extern GTM_ThreadInfo    *g_basebackup_thread;
 extern bool                 enable_sync_commit;
 extern bool              first_init;
 extern int               max_wal_sender;
+extern int               wal_commit_delay;
 extern int32             g_GTMStoreMapFile;
 extern size_t            g_GTMStoreSize;
 extern GTMControlHeader  *g_GTM_Store_Header;
@@ -71,7 +73,18 @@ extern bool             recovery_pitr_mode;
 extern int  GTMStartupGTSDelta;
 
 static bool      g_recovery_finish;
-static bool     *g_GTMStoreDirtyMap;
+
+/*
+ * Map file blocks changed since the last checkpoint, one bit per
+ * GTM_STORE_DIRTY_BLOCK bytes.  Changes only reach the map file through the
+ * checkpointer, their durability until then comes from the WAL.
+ */
+#define GTM_STORE_DIRTY_BLOCK   64
+#define GTMStoreDirtyBlocks()   ((g_GTMStoreSize + GTM_STORE_DIRTY_BLOCK - 1) / GTM_STORE_DIRTY_BLOCK)
+#define GTMStoreDirtyBit(blk)   ((uint64) 1 << ((blk) % 64))
+#define GTMStoreDirtyWord(blk)  pg_atomic_read_u64(&g_GTMStoreDirtyMap[(blk) / 64])
+static pg_atomic_uint64 *g_GTMStoreDirtyMap;
+
 static GTM_MutexLock g_CheckPointLock;
 extern enum GTM_PromoteStatus promote_status;
 
@@ -113,6 +126,8 @@ static uint32 RedoTimestamp(XLogRecGts *cmd);
 static int64 ReadXLogToBuff(uint64 segment_no);
 static char* XLogDataAddPageHeader(XLogRecPtr start,char *data,size_t* len);
 static void  XLogWrite(XLogRecPtr req);
+static void  XLogLogFlushBatches(void);
+static void  MarkStoreDirty(size_t offset, size_t len);
 static void  InitXLogCmdHeader(XLogCmdHeader *header,uint32 type);
 
 static XLogRecPtr WaitXLogInsertionsToFinish(XLogRecPtr upto);
@@ -1091,13 +1106,17 @@ GTM_XLogFileInit(char *data_dir)
 {
     XLogRecPtr flush;
     uint64     segment_no;
+    size_t     nwords;
+    size_t     i;
     int        fd;
 
     flush      = XLogCtl->LogwrtResult.Flush;
     segment_no = flush / GTM_XLOG_SEG_SIZE;
 
-    g_GTMStoreDirtyMap = (bool *)palloc0(g_GTMStoreSize * sizeof(bool));
-    memset(g_GTMStoreDirtyMap,0,g_GTMStoreSize * sizeof(bool));
+    nwords = (GTMStoreDirtyBlocks() + 63) / 64;
+    g_GTMStoreDirtyMap = (pg_atomic_uint64 *)palloc0(nwords * sizeof(pg_atomic_uint64));
+    for(i = 0; i < nwords; i++)
+        pg_atomic_init_u64(&g_GTMStoreDirtyMap[i], 0);
 
     if(Recovery_IsStandby())
         return ;
@@ -1160,6 +1179,13 @@ GTM_XLogCtlDataInit(void)
     SpinLockInit(&XLogCtl->walwirte_info_lck);
     SpinLockInit(&XLogCtl->timeline_lck);
 
+    GTM_MutexLockInit(&XLogCtl->flush_lck);
+    GTM_CVInit(&XLogCtl->flush_cv);
+    XLogCtl->flush_in_progress = false;
+    XLogCtl->flush_request     = flush;
+    XLogCtl->flush_waiters     = 0;
+    memset(XLogCtl->flush_batch_hist, 0, sizeof(XLogCtl->flush_batch_hist));
+
     SpinLockInit(&XLogCtl->segment_gts_lck);
     XLogCtl->segment_max_gts       = 0;
     XLogCtl->segment_max_timestamp = 0;
@@ -1469,7 +1495,6 @@ GTM_ThreadWalRedoer_Internal()
     pg_crc32    crc;
     int         rec_offset = 0;
     XLogPageHeaderData header;
-    int         i = 0;
     int         current_buff_size = 2 * UsableBytesInSegment;
 
     xlog_buff = XLogCtl->writerBuff;
@@ -1701,8 +1726,7 @@ GTM_ThreadWalRedoer_Internal()
     if(xlog_rec != NULL)
         pfree(xlog_rec);
 
-    for(i = 0; i < g_GTMStoreSize;i++)
-        g_GTMStoreDirtyMap[i] = true;
+    MarkStoreDirty(0, g_GTMStoreSize);
 
     if(Recovery_IsStandby())
         DoSlaveCheckPoint(false);
@@ -2480,6 +2504,8 @@ DoMasterCheckPoint(bool shutdown)
     int ret;
     XLogRecPtr flush_ptr;
     int idx;
+    size_t nblocks;
+    size_t blk;
 
     Assert(g_GTMStoreMapFile != -1);
 
@@ -2496,25 +2522,33 @@ DoMasterCheckPoint(bool shutdown)
 
     /* we lock header lock here ,because we want to shorten the interval of header lock holding */
     GTM_RWLockAcquire(g_GTM_Store_Head_Lock,GTM_LOCKMODE_READ);
-    memcpy(g_checkpointMapperBuff,g_GTMStoreMapAddr,g_GTMStoreSize);
 
-    for(i = 0 ; i < g_GTMStoreSize ; i++)
+    /* copy out the dirty ranges only, they are written after the locks are released */
+    nblocks = GTMStoreDirtyBlocks();
+    blk     = 0;
+    while(blk < nblocks)
     {
-        while(i < g_GTMStoreSize && !g_GTMStoreDirtyMap[i]) i++;
-
-        write_start = i;
+        if(blk % 64 == 0 && GTMStoreDirtyWord(blk) == 0)
+        {
+            blk += 64;
+            continue;
+        }
 
-        if( i == g_GTMStoreSize )
-            break;
+        if(!(GTMStoreDirtyWord(blk) & GTMStoreDirtyBit(blk)))
+        {
+            blk++;
+            continue;
+        }
 
-        size = 0;
-        while(i < g_GTMStoreSize && g_GTMStoreDirtyMap[i])
+        write_start = blk * GTM_STORE_DIRTY_BLOCK;
+        while(blk < nblocks && (GTMStoreDirtyWord(blk) & GTMStoreDirtyBit(blk)))
         {
-            g_GTMStoreDirtyMap[i] = false;
-            size++;
-            i++;
+            pg_atomic_fetch_and_u64(&g_GTMStoreDirtyMap[blk / 64], ~GTMStoreDirtyBit(blk));
+            blk++;
         }
+        size = MIN(blk * GTM_STORE_DIRTY_BLOCK, g_GTMStoreSize) - write_start;
 
+        memcpy(g_checkpointMapperBuff + write_start, g_GTMStoreMapAddr + write_start, size);
         g_checkpointDirtySize[idx]    = size;
         g_checkpointDirtyStart[idx++] = write_start;
     }
@@ -2576,6 +2610,7 @@ DoMasterCheckPoint(bool shutdown)
 
     ControlDataSync(true);
 
+    XLogLogFlushBatches();
     elog(LOG, "Checkpoint done");
     GTM_RWLockRelease(&ControlDataLock);
 }
@@ -2754,6 +2789,24 @@ AppendXLogRegisterBuff(XLogRegisterBuff *buff,XLogRecData *data)
     data->next = NULL;
 }
 
+/*
+ * Remember that [offset, offset + len) of the map file needs writing back.
+ * Worker threads get here concurrently, so the bits are set atomically.
+ */
+static void
+MarkStoreDirty(size_t offset, size_t len)
+{
+    size_t blk;
+    size_t last;
+
+    if(len == 0)
+        return;
+
+    last = (offset + len - 1) / GTM_STORE_DIRTY_BLOCK;
+    for(blk = offset / GTM_STORE_DIRTY_BLOCK; blk <= last; blk++)
+        pg_atomic_fetch_or_u64(&g_GTMStoreDirtyMap[blk / 64], GTMStoreDirtyBit(blk));
+}
+
 /*
  * Register a overwrite action with specific range in map file with the WAL record being constructed.
  * This must be called for any map file modification.
@@ -2766,7 +2819,6 @@ XLogRegisterRangeOverwrite(offset_t offset,
     XLogRecData *rec_data = NULL;
     XLogCmdRangerOverWrite *cmd = NULL;
     XLogRegisterBuff *reg_buff = GetMyThreadInfo->register_buff;
-    int i;
 
     rec_data = (XLogRecData *)palloc(sizeof(XLogRecData));
 
@@ -2797,13 +2849,7 @@ XLogRegisterRangeOverwrite(offset_t offset,
     if(enalbe_gtm_xlog_debug)
         elog(LOG,"%lu %d",offset,len);
 
-    i = offset;
-    while(len)
-    {
-        g_GTMStoreDirtyMap[i++] = true;
-        len--;
-    }
-
+    MarkStoreDirty(offset, len);
 }
 
 /*
@@ -3441,6 +3487,20 @@ XLogBackgroundFlush(void)
     return true;
 }
 
+/* Histogram bucket of an fsync that served batch flush requests */
+static int
+XLogFlushBatchBucket(uint32 batch)
+{
+    int bucket = 0;
+
+    while (batch > 1 && bucket < XLOG_FLUSH_BATCH_BUCKETS - 1)
+    {
+        batch = (batch + 1) / 2;
+        bucket++;
+    }
+    return bucket;
+}
+
 /* To make sure xlog ptr lower than ptr -1 have successfully been flush to disk */
 void
 XLogFlush(XLogRecPtr ptr)
@@ -3469,7 +3529,82 @@ XLogFlush(XLogRecPtr ptr)
     /* Only now we can notify flush because we can guarantee all the xlog data are in buff */
     NotifyReplication(write_pos);
 
-    XLogWrite(write_pos);
+    /*
+     * Group flush.  The first thread to find no flush running becomes the
+     * leader and writes up to the highest position requested so far, the
+     * others sleep on flush_cv and are done once the leader's fsync covers
+     * their position.  A request left behind (it arrived after the leader
+     * took its target) simply leads the next round.
+     */
+    GTM_MutexLockAcquire(&XLogCtl->flush_lck);
+    if (XLogCtl->flush_request < write_pos)
+        XLogCtl->flush_request = write_pos;
+    XLogCtl->flush_waiters++;
+
+    for (;;)
+    {
+        XLogRecPtr target;
+        uint32     batch;
+
+        SpinLockAcquire(&XLogCtl->walwirte_info_lck);
+        flush_pos = XLogCtl->LogwrtResult.Flush;
+        SpinLockRelease(&XLogCtl->walwirte_info_lck);
+
+        if (flush_pos >= write_pos)
+            break;
+
+        if (XLogCtl->flush_in_progress)
+        {
+            GTM_CVWait(&XLogCtl->flush_cv, &XLogCtl->flush_lck);
+            continue;
+        }
+
+        XLogCtl->flush_in_progress = true;
+
+        if (wal_commit_delay > 0)
+        {
+            GTM_MutexLockRelease(&XLogCtl->flush_lck);
+            pg_usleep(wal_commit_delay);
+            GTM_MutexLockAcquire(&XLogCtl->flush_lck);
+        }
+
+        target = XLogCtl->flush_request;
+        batch  = XLogCtl->flush_waiters;
+        XLogCtl->flush_waiters = 0;
+        GTM_MutexLockRelease(&XLogCtl->flush_lck);
+
+        /*
+         * XLogWrite() only writes within the current segment, requests past
+         * its end are flushed by SwitchXLogFile() before the switch.
+         */
+        if (GetSegmentNo(target - 1) != GetSegmentNo(write_pos - 1))
+            target = write_pos;
+
+        XLogWrite(target);
+
+        GTM_MutexLockAcquire(&XLogCtl->flush_lck);
+        XLogCtl->flush_batch_hist[XLogFlushBatchBucket(batch)]++;
+        XLogCtl->flush_in_progress = false;
+        GTM_CVBcast(&XLogCtl->flush_cv);
+    }
+
+    GTM_MutexLockRelease(&XLogCtl->flush_lck);
+}
+
+/* Log how many flush requests each fsync has served since startup */
+static void
+XLogLogFlushBatches(void)
+{
+    uint64 hist[XLOG_FLUSH_BATCH_BUCKETS];
+
+    GTM_MutexLockAcquire(&XLogCtl->flush_lck);
+    memcpy(hist, XLogCtl->flush_batch_hist, sizeof(hist));
+    GTM_MutexLockRelease(&XLogCtl->flush_lck);
+
+    elog(LOG, "xlog fsync batches: 1:%"PRIu64" 2:%"PRIu64" 3-4:%"PRIu64" 5-8:%"PRIu64
+         " 9-16:%"PRIu64" 17-32:%"PRIu64" 33-64:%"PRIu64" 65-128:%"PRIu64" >128:%"PRIu64,
+         hist[0], hist[1], hist[2], hist[3], hist[4],
+         hist[5], hist[6], hist[7], hist[8]);
 }
 
 /*
@@ -27,6 +27,7 @@
 #include <sys/resource.h>
 #include <sys/sysinfo.h>
 #include <sys/epoll.h>
+#include <poll.h>
 #include <getopt.h>
 #include <stdio.h>
 #include <dirent.h>
@@ -105,6 +106,7 @@ int            scale_factor_threads = 1;
 int            worker_thread_number = 2;
 #ifdef __OPENTENBASE__
 int         wal_writer_delay;
+int         wal_commit_delay;
 int         checkpoint_interval;
 char        *archive_command;
 bool        archive_mode;
@@ -132,6 +134,7 @@ bool        enable_gtm_sequence_debug = false;
 bool        enalbe_gtm_xlog_debug = false;
 bool        enable_gtm_debug   = false;
 bool        enable_sync_commit = false;
+bool        enable_gtm_load_balance = true;
 int         warnning_time_cost = 0;
 
 
@@ -195,6 +198,11 @@ s_lock_t promote_status_lck;
 
 /* The socket(s) we're listening to. */
 #define MAXLISTEN    64
+
+/* max connections accepted from one listen socket per select() wakeup */
+#define GTM_MAX_ACCEPTS_PER_WAKEUP    64
+/* seconds between resampling service thread request rates */
+#define GTM_LOAD_SAMPLE_INTERVAL      1
 static int    ListenSocket[MAXLISTEN];
 
 pthread_key_t    threadinfo_key;
@@ -204,6 +212,8 @@ static void GTM_SaveVersion(FILE *ctlf);
 
 static Port *ConnCreate(int serverFd);
 static int ServerLoop(void);
+static bool ListenSocketReady(int sock);
+static GTM_ThreadInfo *GTM_ChooseServiceThread(void);
 static int initMasks(fd_set *rmask);
 #ifdef __XLOG__
 void GTM_PortCleanup(Port *con_port);
@@ -1847,22 +1857,46 @@ ServerLoop(void)
                 if (FD_ISSET(ListenSocket[i], &rmask))
                 {
                     Port       *port;
+                    int         accepted = 0;
 
-                    port = ConnCreate(ListenSocket[i]);
-                    if (port)
+                    /*
+                     * Drain the accept queue so that a connection storm is
+                     * not accepted one select() round at a time.
+                     */
+                    do
                     {
-                        if (GTMAddConnection(port, NULL) != STATUS_OK)
+                        port = ConnCreate(ListenSocket[i]);
+                        if (port)
                         {
-                            StreamClose(port->sock);
-                            ConnFree(port);
+                            if (GTMAddConnection(port, NULL) != STATUS_OK)
+                            {
+                                StreamClose(port->sock);
+                                ConnFree(port);
+                            }
                         }
-                    }
+                    } while (++accepted < GTM_MAX_ACCEPTS_PER_WAKEUP &&
+                             ListenSocketReady(ListenSocket[i]));
                 }
             }
         }
     }
 }
 
+/*
+ * Is another connection already queued on the listen socket?
+ */
+static bool
+ListenSocketReady(int sock)
+{
+    struct pollfd pfd;
+
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN) != 0;
+}
+
 /*
  * add connection into g_standby_pre_server_thread
  */
@@ -2164,6 +2198,12 @@ GTM_RemoveConnection(GTM_ConnectionInfo *conn)
 {
     epoll_ctl(GetMyThreadInfo->thr_efd,EPOLL_CTL_DEL,conn->con_port->sock,NULL);
 
+    if (conn->con_counted)
+    {
+        pg_atomic_fetch_sub_u32(&conn->con_thrinfo->thr_conn_count, 1);
+        conn->con_counted = false;
+    }
+
     Recovery_PGXCNodeDisconnect(conn->con_port);
     GTM_ConnCleanup(conn);
 }
@@ -3509,6 +3549,7 @@ GTM_ThreadMain(void *argp)
         n = epoll_wait (efd, events, GTM_MAX_CONNECTIONS_PER_THREAD, -1);
 
         elog(DEBUG8, "epoll_wait wakeup %d", n);
+        thrinfo->thr_queue_depth = (n > 0) ? n : 0;
         
         for(i = 0; i < n; i++)
         {
@@ -3571,6 +3612,7 @@ GTM_ThreadMain(void *argp)
             switch(qtype)
             {
                 case 'C':
+                    pg_atomic_fetch_add_u64(&thrinfo->thr_request_count, 1);
                     ProcessCommand(conn->con_port, &input_message);
                     elog(DEBUG8, "complete command %c", qtype);
                     break;
@@ -3911,6 +3953,7 @@ ProcessCommand(Port *myport, StringInfo input_message)
      * Get Timestamp does not need to sync with standby
      */
     GetMyThreadInfo->handle_standby = (mtype != MSG_GETGTS &&
+                      mtype != MSG_GETGTS_SNAPSHOT &&
                       mtype != MSG_GETGTS_MULTI &&
                       mtype != MSG_BEGIN_BACKUP &&
 #ifndef __XLOG__
@@ -4003,6 +4046,7 @@ ProcessCommand(Port *myport, StringInfo input_message)
         case MSG_TXN_LOG_SCAN:
         case MSG_TXN_LOG_GLOBAL_SCAN:
         case MSG_GETGTS:
+        case MSG_GETGTS_SNAPSHOT:
         case MSG_GETGTS_MULTI:
         case MSG_CHECK_GTM_STATUS:
 #endif
@@ -4315,13 +4359,24 @@ GTMAddConnection(Port *port, GTM_Conn *standby)
         }
         GTM_RWLockRelease(&GTMThreads->gt_lock);
 
-        i = (GTMThreads->gt_next_thread++) % GTMThreads->gt_start_thread_count;
-
-        thrinfo = GTMThreads->gt_threads[i];
-        if(NULL == thrinfo)
+        if (enable_gtm_load_balance)
         {
-            elog(DEBUG1, "thread %d exits.", i);
-            continue;
+            thrinfo = GTM_ChooseServiceThread();
+            if (NULL == thrinfo)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            i = (GTMThreads->gt_next_thread++) % GTMThreads->gt_start_thread_count;
+
+            thrinfo = GTMThreads->gt_threads[i];
+            if(NULL == thrinfo)
+            {
+                elog(DEBUG1, "thread %d exits.", i);
+                continue;
+            }
         }
 
         if(false == thrinfo->thr_epoll_ok)
@@ -4337,11 +4392,18 @@ GTMAddConnection(Port *port, GTM_Conn *standby)
         }
 
         conninfo->con_thrinfo = thrinfo;
+
+        /* count it before the service thread can see and drop it */
+        conninfo->con_counted = true;
+        pg_atomic_fetch_add_u32(&thrinfo->thr_conn_count, 1);
+
         event.data.ptr = conninfo;
         event.events = EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP;
         if(-1 == epoll_ctl (thrinfo->thr_efd, EPOLL_CTL_ADD, conninfo->con_port->sock, &event))
         {
             elog(LOG, "failed to add socket to epoll");
+            conninfo->con_counted = false;
+            pg_atomic_fetch_sub_u32(&thrinfo->thr_conn_count, 1);
             return STATUS_ERROR;
         }
         break;
@@ -4349,6 +4411,87 @@ GTMAddConnection(Port *port, GTM_Conn *standby)
     return STATUS_OK;
 }
 
+/*
+ * Pick the service thread a new connection goes to.
+ *
+ * Only the main thread places connections, so the sampling state needs no
+ * lock.  Request rates are resampled at most every GTM_LOAD_SAMPLE_INTERVAL
+ * seconds.  A thread scores its recent request rate plus what its
+ * connections, the ready ones of its last epoll_wait and the new one would
+ * add at the average per-connection rate, so busy threads are avoided and
+ * idle threads fill up evenly.  Ties are broken round-robin.
+ */
+static GTM_ThreadInfo *
+GTM_ChooseServiceThread(void)
+{
+    static time_t   last_sample = 0;
+    GTM_ThreadInfo *thrinfo;
+    GTM_ThreadInfo *best = NULL;
+    uint64          best_score = PG_UINT64_MAX;
+    uint64          total_rate = 0;
+    uint64          total_conns = 0;
+    uint64          per_conn;
+    uint32          count = GTMThreads->gt_start_thread_count;
+    uint32          start = GTMThreads->gt_next_thread++;
+    uint32          n;
+    time_t          now = time(NULL);
+    bool            resample = (now - last_sample >= GTM_LOAD_SAMPLE_INTERVAL);
+
+    for (n = 0; n < count; n++)
+    {
+        thrinfo = GTMThreads->gt_threads[n];
+        if (NULL == thrinfo || false == thrinfo->thr_epoll_ok)
+        {
+            continue;
+        }
+
+        if (resample)
+        {
+            uint64 requests = pg_atomic_read_u64(&thrinfo->thr_request_count);
+
+            thrinfo->thr_request_rate = (requests - thrinfo->thr_sampled_requests) /
+                                        (now - last_sample);
+            thrinfo->thr_sampled_requests = requests;
+
+            elog(DEBUG1, "service thread %u: %u connections, %u requests/s, queue depth %u",
+                 n, pg_atomic_read_u32(&thrinfo->thr_conn_count),
+                 thrinfo->thr_request_rate, thrinfo->thr_queue_depth);
+        }
+
+        total_rate  += thrinfo->thr_request_rate;
+        total_conns += pg_atomic_read_u32(&thrinfo->thr_conn_count);
+    }
+
+    if (resample)
+    {
+        last_sample = now;
+    }
+
+    per_conn = (total_conns > 0 ? total_rate / total_conns : 0) + 1;
+
+    for (n = 0; n < count; n++)
+    {
+        uint64 score;
+
+        thrinfo = GTMThreads->gt_threads[(start + n) % count];
+        if (NULL == thrinfo || false == thrinfo->thr_epoll_ok)
+        {
+            continue;
+        }
+
+        score = thrinfo->thr_request_rate +
+                (pg_atomic_read_u32(&thrinfo->thr_conn_count) +
+                 thrinfo->thr_queue_depth + 1) * per_conn;
+        if (score < best_score)
+        {
+            best_score = score;
+            best = thrinfo;
+        }
+    }
+
+    return best;
+}
+
 /* ----------------
  *        ReadCommand reads a command from either the frontend or
  *        standard input, places it in inBuf, and returns the
@@ -4511,6 +4654,7 @@ ProcessTransactionCommand(Port *myport, GTM_MessageType mtype, StringInfo messag
 #endif
 
         case MSG_GETGTS:
+        case MSG_GETGTS_SNAPSHOT:
             ProcessGetGTSCommand(myport, message);
             break;
 
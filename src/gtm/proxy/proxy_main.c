@@ -157,6 +157,8 @@ static GTM_Conn *HandleGTMError(GTM_Conn *gtm_conn);
 static GTM_Conn *HandlePostCommand(GTMProxy_ConnectionInfo *conninfo, GTM_Conn *gtm_conn);
 static void ProcessTransactionCommand(GTMProxy_ConnectionInfo *conninfo,
         GTM_Conn *gtm_conn, GTM_MessageType mtype, StringInfo message);
+static void ProcessGTSCommand(GTMProxy_ConnectionInfo *conninfo,
+        GTM_Conn *gtm_conn, GTM_MessageType mtype, StringInfo message);
 static void ProcessSnapshotCommand(GTMProxy_ConnectionInfo *conninfo,
         GTM_Conn *gtm_conn, GTM_MessageType mtype, StringInfo message);
 
@@ -169,6 +171,7 @@ static void ProcessResponse(GTMProxy_ThreadInfo *thrinfo,
         GTMProxy_CommandInfo *cmdinfo, GTM_Result *res);
 
 static void GTMProxy_ProcessPendingCommands(GTMProxy_ThreadInfo *thrinfo);
+static void GTMProxy_LogCoalescingStats(void);
 static void GTMProxy_CommandPending(GTMProxy_ConnectionInfo *conninfo,
         GTM_MessageType mtype, GTMProxy_CommandData cmd_data);
 
@@ -1024,6 +1027,8 @@ ServerLoop(void)
             }
         }
 
+        GTMProxy_LogCoalescingStats();
+
         /*
          * New connection pending on any of our sockets? If so, accept the
          * connection and add it to one of the worker threads.
@@ -1055,6 +1060,52 @@ ServerLoop(void)
     }
 }
 
+/*
+ * Report, at most once a minute, how many backend GTS and snapshot requests
+ * the worker threads answered per request sent to GTM.
+ */
+static void
+GTMProxy_LogCoalescingStats(void)
+{
+    static time_t last_report = 0;
+    static uint64 last_requests = 0;
+    time_t      now = time(NULL);
+    uint64      gts_requests = 0;
+    uint64      gts_upstream = 0;
+    uint64      snap_requests = 0;
+    uint64      snap_upstream = 0;
+    uint32      ii;
+
+    if (now - last_report < 60)
+        return;
+    last_report = now;
+
+    GTM_RWLockAcquire(&GTMProxyThreads->gt_lock, GTM_LOCKMODE_READ);
+    for (ii = 0; ii < GTMProxyThreads->gt_array_size; ii++)
+    {
+        GTMProxy_ThreadInfo *thrinfo = GTMProxyThreads->gt_threads[ii];
+
+        if (thrinfo == NULL)
+            continue;
+        gts_requests += pg_atomic_read_u64(&thrinfo->thr_gts_requests);
+        gts_upstream += pg_atomic_read_u64(&thrinfo->thr_gts_upstream);
+        snap_requests += pg_atomic_read_u64(&thrinfo->thr_snap_requests);
+        snap_upstream += pg_atomic_read_u64(&thrinfo->thr_snap_upstream);
+    }
+    GTM_RWLockRelease(&GTMProxyThreads->gt_lock);
+
+    if (gts_requests + snap_requests == last_requests)
+        return;
+    last_requests = gts_requests + snap_requests;
+
+    elog(LOG, "coalescing: GTS %lu requests in %lu upstream (%.2f per request), "
+         "snapshot %lu requests in %lu upstream (%.2f per request)",
+         (unsigned long) gts_requests, (unsigned long) gts_upstream,
+         gts_upstream ? (double) gts_requests / gts_upstream : 0.0,
+         (unsigned long) snap_requests, (unsigned long) snap_upstream,
+         snap_upstream ? (double) snap_requests / snap_upstream : 0.0);
+}
+
 /*
  * Initialise the masks for select() for the ports we are listening on.
  * Return the number of sockets to listen on.
@@ -1625,6 +1676,20 @@ ProcessCommand(GTMProxy_ConnectionInfo *conninfo, GTM_Conn *gtm_conn,
             ProcessSnapshotCommand(conninfo, gtm_conn, mtype, input_message);
             break;
 
+        case MSG_GETGTS:
+            /*
+             * Commit and prepare timestamps must each come from GTM after
+             * the caller asked, never share them.
+             */
+            pg_atomic_fetch_add_u64(&GetMyThreadInfo->thr_gts_requests, 1);
+            pg_atomic_fetch_add_u64(&GetMyThreadInfo->thr_gts_upstream, 1);
+            GTMProxy_ProxyCommand(conninfo, gtm_conn, mtype, input_message);
+            break;
+
+        case MSG_GETGTS_SNAPSHOT:
+            ProcessGTSCommand(conninfo, gtm_conn, mtype, input_message);
+            break;
+
         default:
             ereport(FATAL,
                     (EPROTO,
@@ -1771,6 +1836,7 @@ IsProxiedMessage(GTM_MessageType mtype)
         case MSG_CHECK_GTM_STORE_SEQ:            /* Check gtm sequence usage info */            
         case MSG_CHECK_GTM_STORE_TXN:            /* Check gtm transaction usage info */
         case MSG_CLEAN_SESSION_SEQ:
+        case MSG_GETGTS:
 #endif
             return true;
 
@@ -1948,6 +2014,27 @@ ProcessResponse(GTMProxy_ThreadInfo *thrinfo, GTMProxy_CommandInfo *cmdinfo,
             ReleaseCmdBackup(cmdinfo);
             break;
 
+        case MSG_GETGTS_SNAPSHOT:
+            if ((res->gr_status == GTM_RESULT_OK) &&
+                (res->gr_type == TXN_BEGIN_GETGTS_RESULT))
+            {
+                pq_beginmessage(&buf, 'S');
+                pq_sendint(&buf, TXN_BEGIN_GETGTS_RESULT, 4);
+                pq_sendbytes(&buf, (char *)&res->gr_resdata.grd_gts.grd_gts, sizeof (GTM_Timestamp));
+                if (res->gr_resdata.grd_gts.gtm_readonly)
+                    pq_sendbyte(&buf, true);
+                pq_endmessage(cmdinfo->ci_conn->con_port, &buf);
+                pq_flush(cmdinfo->ci_conn->con_port);
+            }
+            else
+            {
+                ReleaseCmdBackup(cmdinfo);
+                ereport(ERROR2, (EINVAL, errmsg("global timestamp request failed")));
+            }
+            cmdinfo->ci_conn->con_pending_msg = MSG_TYPE_INVALID;
+            ReleaseCmdBackup(cmdinfo);
+            break;
+
         case MSG_TXN_BEGIN:
         case MSG_TXN_BEGIN_GETGXID_AUTOVACUUM:
         case MSG_TXN_PREPARE:
@@ -1980,6 +2067,7 @@ ProcessResponse(GTMProxy_ThreadInfo *thrinfo, GTMProxy_CommandInfo *cmdinfo,
         case MSG_CHECK_GTM_STORE_SEQ:            /* Check gtm sequence usage info */            
         case MSG_CHECK_GTM_STORE_TXN:            /* Check gtm transaction usage info */
         case MSG_CLEAN_SESSION_SEQ:
+        case MSG_GETGTS:
 #endif
             Assert(IsProxiedMessage(cmdinfo->ci_mtype));
             if ((res->gr_proxyhdr.ph_conid == InvalidGTMProxyConnID) ||
@@ -2195,6 +2283,22 @@ ProcessTransactionCommand(GTMProxy_ConnectionInfo *conninfo, GTM_Conn *gtm_conn,
     }
 }
 
+/*
+ * Snapshot global timestamp requests carry no data.  All of them received in
+ * one round are answered by a single upstream request, see
+ * GTMProxy_ProcessPendingCommands().
+ */
+static void
+ProcessGTSCommand(GTMProxy_ConnectionInfo *conninfo, GTM_Conn *gtm_conn,
+        GTM_MessageType mtype, StringInfo message)
+{
+    GTMProxy_CommandData cmd_data;
+
+    pq_getmsgend(message);
+    memset(&cmd_data, 0, sizeof (cmd_data));
+    GTMProxy_CommandPending(conninfo, mtype, cmd_data);
+}
+
 static void
 ProcessSnapshotCommand(GTMProxy_ConnectionInfo *conninfo, GTM_Conn *gtm_conn,
         GTM_MessageType mtype, StringInfo message)
@@ -2581,6 +2685,10 @@ GTMProxy_ProcessPendingCommands(GTMProxy_ThreadInfo *thrinfo)
                     gtmpqPutInt(gtm_list_length(thrinfo->thr_pending_commands[ii]), sizeof(int), gtm_conn))
                     elog(ERROR, "Error sending data");
 
+                pg_atomic_fetch_add_u64(&thrinfo->thr_snap_requests,
+                                        gtm_list_length(thrinfo->thr_pending_commands[ii]));
+                pg_atomic_fetch_add_u64(&thrinfo->thr_snap_upstream, 1);
+
                 gtm_foreach (elem, thrinfo->thr_pending_commands[ii])
                 {
                     cmdinfo = (GTMProxy_CommandInfo *)gtm_lfirst(elem);
@@ -2615,6 +2723,42 @@ GTMProxy_ProcessPendingCommands(GTMProxy_ThreadInfo *thrinfo)
                 thrinfo->thr_pending_commands[ii] = gtm_NIL;
                 break;
 
+            case MSG_GETGTS_SNAPSHOT:
+                /*
+                 * These are snapshot timestamps only.  Every request in the
+                 * list reached us before this one is sent, so the timestamp
+                 * GTM returns is at least as new as the one each of them
+                 * would have got alone, and a snapshot taken with it sees
+                 * every transaction committed before any of them asked.
+                 * Only the first command reads the response, the others
+                 * reuse it.
+                 */
+                if (gtmpqPutInt(MSG_GETGTS_SNAPSHOT, sizeof (GTM_MessageType), gtm_conn))
+                    elog(ERROR, "Error sending data");
+
+                gtm_foreach (elem, thrinfo->thr_pending_commands[ii])
+                {
+                    cmdinfo = (GTMProxy_CommandInfo *)gtm_lfirst(elem);
+                    Assert(cmdinfo->ci_mtype == ii);
+                    cmdinfo->ci_res_index = res_index++;
+                }
+
+                pg_atomic_fetch_add_u64(&thrinfo->thr_gts_requests, res_index);
+                pg_atomic_fetch_add_u64(&thrinfo->thr_gts_upstream, 1);
+
+                /* Finish the message. */
+                Enable_Longjmp();
+                if (gtmpqPutMsgEnd(gtm_conn))
+                    elog(ERROR, "Error finishing the message");
+                Disable_Longjmp();
+
+                thrinfo->thr_processed_commands = gtm_list_concat(thrinfo->thr_processed_commands,
+                        thrinfo->thr_pending_commands[ii]);
+                if ((thrinfo->thr_processed_commands != thrinfo->thr_pending_commands[ii]) &&
+                    (thrinfo->thr_pending_commands[ii] != gtm_NIL))
+                    pfree(thrinfo->thr_pending_commands[ii]);
+                thrinfo->thr_pending_commands[ii] = gtm_NIL;
+                break;
 
             default:
                 elog(ERROR, "This message type (%d) can not be grouped together", ii);
@@ -144,6 +144,11 @@ GTMProxy_ThreadCreate(void *(* startroutine)(void *), int idx)
     GTM_MutexLockInit(&thrinfo->thr_lock);
     GTM_CVInit(&thrinfo->thr_cv);
 
+    pg_atomic_init_u64(&thrinfo->thr_gts_requests, 0);
+    pg_atomic_init_u64(&thrinfo->thr_gts_upstream, 0);
+    pg_atomic_init_u64(&thrinfo->thr_snap_requests, 0);
+    pg_atomic_init_u64(&thrinfo->thr_snap_upstream, 0);
+
     /*
      * Initialize communication area with SIGUSR2 signal handler (reconnect)
      */
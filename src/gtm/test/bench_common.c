@@ -0,0 +1,176 @@
+/*
+ * bench_common.c
+ *
+ *	  Thread and step harness shared by the GTM micro-benchmarks.
+ *
+ * A step starts the given number of client threads, each with its own GTM
+ * connection, lets them send requests in a tight loop for bench_seconds and
+ * adds up what they did.  Every thread also checks that the values it gets
+ * keep increasing, strictly or not as the benchmark asks.
+ *
+ * src/gtm/test/bench_common.c
+ */
+
+#include <sys/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_common.h"
+
+char	   *bench_host = "localhost";
+int			bench_port = 6666;
+int			bench_seconds = 10;
+int			bench_max_threads = BENCH_MAX_THREADS;
+
+typedef struct BenchThread
+{
+	pthread_t	thread;
+	int			id;
+	const char *node_name;
+	BenchOp		op;
+	bool		strict;
+	uint64		count;
+	uint64		errors;
+	bool		backwards;
+} BenchThread;
+
+static volatile bool bench_stop = false;
+
+/*
+ * Parse the options common to all the benchmarks, exits on a bad one.
+ */
+void
+bench_parse_args(int argc, char **argv)
+{
+	int			c;
+
+	while ((c = getopt(argc, argv, "h:p:t:d:")) != -1)
+	{
+		switch (c)
+		{
+			case 'h':
+				bench_host = strdup(optarg);
+				break;
+			case 'p':
+				bench_port = atoi(optarg);
+				break;
+			case 't':
+				bench_max_threads = atoi(optarg);
+				break;
+			case 'd':
+				bench_seconds = atoi(optarg);
+				break;
+			default:
+				fprintf(stderr,
+						"usage: %s [-h host] [-p port] [-t max_threads] [-d seconds]\n",
+						argv[0]);
+				exit(1);
+		}
+	}
+
+	if (bench_max_threads < 1 || bench_max_threads > BENCH_MAX_THREADS)
+	{
+		fprintf(stderr, "max_threads must be between 1 and %d\n",
+				BENCH_MAX_THREADS);
+		exit(1);
+	}
+}
+
+GTM_Conn *
+bench_connect(const char *node_name)
+{
+	GTM_Conn   *conn;
+	char		connect_string[256];
+
+	snprintf(connect_string, sizeof(connect_string),
+			 "host=%s port=%d node_name=%s remote_type=%d",
+			 bench_host, bench_port, node_name, GTM_NODE_DEFAULT);
+
+	conn = PQconnectGTM(connect_string);
+	if (conn == NULL || GTMPQstatus(conn) != CONNECTION_OK)
+	{
+		fprintf(stderr, "could not connect to GTM at %s:%d\n",
+				bench_host, bench_port);
+		exit(1);
+	}
+	return conn;
+}
+
+static void *
+bench_thread_main(void *arg)
+{
+	BenchThread *me = (BenchThread *) arg;
+	GTM_Conn   *conn = bench_connect(me->node_name);
+	int64		last = 0;
+	bool		first = true;
+
+	while (!bench_stop)
+	{
+		int64		value;
+
+		if (!me->op(conn, me->id, &value))
+		{
+			me->errors++;
+			continue;
+		}
+		if (!first && (me->strict ? value <= last : value < last))
+			me->backwards = true;
+		first = false;
+		last = value;
+		me->count++;
+	}
+
+	GTMPQfinish(conn);
+	return NULL;
+}
+
+/*
+ * Run op on nthreads client threads for bench_seconds.
+ */
+void
+bench_run_step(int nthreads, const char *node_name, BenchOp op, bool strict,
+			   BenchResult *result)
+{
+	BenchThread threads[BENCH_MAX_THREADS];
+	struct timeval start;
+	struct timeval stop;
+	uint64		total = 0;
+	double		elapsed;
+	int			i;
+
+	memset(threads, 0, sizeof(threads));
+	memset(result, 0, sizeof(BenchResult));
+	bench_stop = false;
+
+	gettimeofday(&start, NULL);
+	for (i = 0; i < nthreads; i++)
+	{
+		threads[i].id = i;
+		threads[i].node_name = node_name;
+		threads[i].op = op;
+		threads[i].strict = strict;
+		if (pthread_create(&threads[i].thread, NULL, bench_thread_main, &threads[i]) != 0)
+		{
+			fprintf(stderr, "could not create thread %d\n", i);
+			exit(1);
+		}
+	}
+
+	sleep(bench_seconds);
+	bench_stop = true;
+
+	for (i = 0; i < nthreads; i++)
+	{
+		pthread_join(threads[i].thread, NULL);
+		total += threads[i].count;
+		result->errors += threads[i].errors;
+		result->backwards |= threads[i].backwards;
+	}
+	gettimeofday(&stop, NULL);
+
+	elapsed = (stop.tv_sec - start.tv_sec) +
+		(stop.tv_usec - start.tv_usec) / 1000000.0;
+	result->rate = total / elapsed;
+}
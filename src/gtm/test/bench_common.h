@@ -0,0 +1,44 @@
+/*
+ * bench_common.h
+ *
+ *	  Thread and step harness shared by the GTM micro-benchmarks.
+ *
+ * src/gtm/test/bench_common.h
+ */
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <sys/types.h>
+#include <pthread.h>
+
+#include "gtm/gtm_c.h"
+#include "gtm/libpq-fe.h"
+#include "gtm/gtm_client.h"
+
+#define BENCH_MAX_THREADS	128
+
+/*
+ * One request of a benchmark, sent on the connection of client thread id.
+ * Returns false if it failed, else the value the GTM handed out, which must
+ * keep increasing within a thread.
+ */
+typedef bool (*BenchOp) (GTM_Conn *conn, int id, int64 *value);
+
+typedef struct BenchResult
+{
+	double		rate;			/* requests per second, all threads */
+	uint64		errors;
+	bool		backwards;		/* some thread got a value out of order */
+} BenchResult;
+
+extern char	   *bench_host;
+extern int		bench_port;
+extern int		bench_seconds;
+extern int		bench_max_threads;
+
+extern void bench_parse_args(int argc, char **argv);
+extern GTM_Conn *bench_connect(const char *node_name);
+extern void bench_run_step(int nthreads, const char *node_name, BenchOp op,
+			   bool strict, BenchResult *result);
+
+#endif							/* BENCH_COMMON_H */
@@ -0,0 +1,51 @@
+/*
+ * test_gts_bench.c
+ *
+ *	  Micro-benchmark of global timestamp issuance.
+ *
+ * Every client thread opens its own GTM connection and asks for global
+ * timestamps in a tight loop.  The run is repeated with 1, 2, 4, ... up to
+ * the requested number of threads and the aggregate GTS/s is printed for
+ * each step, so the same binary can be pointed at an old and a new GTM to
+ * compare them.  Each thread also checks that the timestamps it receives
+ * never go backwards.
+ *
+ * usage: test_gts_bench [-h host] [-p port] [-t max_threads] [-d seconds]
+ */
+
+#include <stdio.h>
+
+#include "bench_common.h"
+
+static bool
+gts_bench_op(GTM_Conn *conn, int id, int64 *value)
+{
+	Get_GTS_Result result = get_global_timestamp(conn);
+
+	if (result.gts == 0)
+		return false;
+	*value = result.gts;
+	return true;
+}
+
+int
+main(int argc, char **argv)
+{
+	int			nthreads;
+
+	bench_parse_args(argc, argv);
+
+	printf("%8s %14s %10s %s\n", "threads", "gts/s", "errors", "order");
+	for (nthreads = 1; nthreads <= bench_max_threads; nthreads *= 2)
+	{
+		BenchResult result;
+
+		bench_run_step(nthreads, "gts_bench", gts_bench_op, false, &result);
+		printf("%8d %14.0f %10lu %s\n",
+			   nthreads, result.rate, (unsigned long) result.errors,
+			   result.backwards ? "BACKWARDS" : "ok");
+		fflush(stdout);
+	}
+
+	return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * test_seq_bench.c
+ *
+ *	  Micro-benchmark of sequence nextval on GTM.
+ *
+ * Every client thread opens its own GTM connection and calls get_next in a
+ * tight loop.  The run is repeated with 1, 2, 4, ... up to the requested
+ * number of threads, first with all threads on one sequence and then with
+ * each thread on a sequence of its own, and the aggregate nextval/s is
+ * printed for each step.  The first case measures contention on a single
+ * hot sequence, the second the sequence directory itself.  Each thread also
+ * checks that the values it receives keep increasing.
+ *
+ * usage: test_seq_bench [-h host] [-p port] [-t max_threads] [-d seconds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+
+static char		bench_keys[BENCH_MAX_THREADS][64];
+
+/* all threads on sequence 0, or each on its own */
+static bool		bench_shared;
+
+static void
+bench_key(GTM_SequenceKey key, int i)
+{
+	key->gsk_key = bench_keys[i];
+	key->gsk_keylen = strlen(bench_keys[i]) + 1;
+	key->gsk_type = GTM_SEQ_FULL_NAME;
+}
+
+static bool
+seq_bench_op(GTM_Conn *conn, int id, int64 *value)
+{
+	GTM_SequenceKeyData key;
+	GTM_Sequence result;
+	GTM_Sequence rangemax;
+
+	bench_key(&key, bench_shared ? 0 : id);
+	if (get_next(conn, &key, "seq_bench", id + 1, 1, &result, &rangemax) != 0)
+		return false;
+	*value = result;
+	return true;
+}
+
+static void
+run_steps(bool shared)
+{
+	int			nthreads;
+
+	bench_shared = shared;
+	for (nthreads = 1; nthreads <= bench_max_threads; nthreads *= 2)
+	{
+		BenchResult result;
+
+		bench_run_step(nthreads, "seq_bench", seq_bench_op, true, &result);
+		printf("%-6s %8d %14.0f %10lu %s\n",
+			   shared ? "one" : "many", nthreads, result.rate,
+			   (unsigned long) result.errors,
+			   result.backwards ? "BACKWARDS" : "ok");
+		fflush(stdout);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	GTM_Conn   *conn;
+	int			i;
+
+	bench_parse_args(argc, argv);
+
+	/* sequence 0 is the shared one, the others are used one per thread */
+	conn = bench_connect("seq_bench");
+	for (i = 0; i < bench_max_threads; i++)
+	{
+		GTM_SequenceKeyData key;
+
+		snprintf(bench_keys[i], sizeof(bench_keys[i]),
+				 "seq_bench.public.seq_bench_%d", i);
+		bench_key(&key, i);
+		close_sequence(conn, &key, InvalidGlobalTransactionId);
+		if (open_sequence(conn, &key, 1, 1, 0x7ffffffffffffffeLL, 1, false,
+						  InvalidGlobalTransactionId) != 0)
+		{
+			fprintf(stderr, "could not create sequence %s\n", bench_keys[i]);
+			exit(1);
+		}
+	}
+
+	printf("%-6s %8s %14s %10s %s\n", "seqs", "threads", "nextval/s", "errors", "order");
+	run_steps(true);
+	run_steps(false);
+
+	for (i = 0; i < bench_max_threads; i++)
+	{
+		GTM_SequenceKeyData key;
+
+		bench_key(&key, i);
+		close_sequence(conn, &key, InvalidGlobalTransactionId);
+	}
+	GTMPQfinish(conn);
+
+	return 0;
+}
@@ -96,6 +96,7 @@ bool        isStartUp;
 int            scale_factor_threads = 1;
 #ifdef __OPENTENBASE__
 int         wal_writer_delay;
+int         wal_commit_delay;
 int         checkpoint_interval;
 char        *archive_command;
 bool        archive_mode;
@@ -148,6 +148,9 @@ extern void index_rescan(IndexScanDesc scan,
              ScanKey keys, int nkeys,
              ScanKey orderbys, int norderbys);
 extern void index_endscan(IndexScanDesc scan);
+#ifdef _SHARDING_
+extern void index_setscanshards(IndexScanDesc scan, Bitmapset *shards);
+#endif
 extern void index_markpos(IndexScanDesc scan);
 extern void index_restrpos(IndexScanDesc scan);
 extern Size index_parallelscan_estimate(Relation indexrel, Snapshot snapshot);
@@ -51,12 +51,16 @@ extern int     NewGtmPort;
 
 extern int reconnect_gtm_retry_times;
 extern int reconnect_gtm_retry_interval;
+extern bool enable_gts_batch;
 
 extern bool IsGTMConnected(void);
 extern void InitGTM(void);
 extern void CloseGTM(void);
 extern GTM_Timestamp 
 GetGlobalTimestampGTM(void);
+extern GTM_Timestamp GetSnapshotGlobalTimestampGTM(void);
+extern Size GTSBatchShmemSize(void);
+extern void GTSBatchShmemInit(void);
 extern GlobalTransactionId BeginTranGTM(GTM_Timestamp *timestamp, const char *globalSession);
 extern GlobalTransactionId BeginTranAutovacuumGTM(void);
 extern int CommitTranGTM(GlobalTransactionId gxid, int waited_xid_count,
@@ -137,6 +141,7 @@ extern Datum pg_list_storage_sequence(PG_FUNCTION_ARGS);
 extern Datum pg_list_storage_transaction(PG_FUNCTION_ARGS);
 extern Datum pg_check_storage_sequence(PG_FUNCTION_ARGS);
 extern Datum pg_check_storage_transaction(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_gts_batch(PG_FUNCTION_ARGS);
 extern void  CheckGTMConnection(void);
 extern int32 RenameDBSequenceGTM(const char *seqname, const char *newseqname);
 #endif
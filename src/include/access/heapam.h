@@ -123,6 +123,9 @@ extern HeapScanDesc heap_beginscan_sampling(Relation relation,
 						bool allow_strat, bool allow_sync, bool allow_pagemode);
 extern void heap_setscanlimits(HeapScanDesc scan, BlockNumber startBlk,
 				   BlockNumber endBlk);
+#ifdef _SHARDING_
+extern void heap_setscanshards(HeapScanDesc scan, Bitmapset *shards);
+#endif
 extern void heapgetpage(HeapScanDesc scan, BlockNumber page);
 extern void heap_rescan(HeapScanDesc scan, ScanKey key);
 extern void heap_rescan_set_params(HeapScanDesc scan, ScanKey key,
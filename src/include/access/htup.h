@@ -89,6 +89,16 @@ typedef struct RemoteDataRowData
     char        msg[0];                    /* last data row message */
 }     RemoteDataRowData;
 typedef RemoteDataRowData *RemoteDataRow;
+
+/*
+ * Set in the column count of a DataRow whose values are in binary format:
+ * fixed-width pass-by-value columns as their raw value in network byte
+ * order, everything else as produced by the type's send function.
+ */
+#define DATAROW_BINARY_FLAG        0x8000
+#define DATAROW_RAW_BYVAL(attr)    ((attr)->attbyval && (attr)->attlen > 0)
+#define DataRowIsBinary(row) \
+    (((unsigned char) (row)->msg[0] & (DATAROW_BINARY_FLAG >> 8)) != 0)
 #endif
 
 /*
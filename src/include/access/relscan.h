@@ -76,6 +76,11 @@ typedef struct HeapScanDescData
     Buffer        rs_cbuf;        /* current buffer in scan, if any */
     /* NB: if rs_cbuf is not InvalidBuffer, we hold a pin on that buffer */
     ParallelHeapScanDesc rs_parallel;    /* parallel scan information */
+#ifdef _SHARDING_
+    Bitmapset  *rs_shards;        /* only scan these shards, NULL = all */
+    ExtentID    rs_shard_eid;    /* extent whose visibility is cached */
+    bool        rs_shard_hidden;    /* is rs_shard_eid of a hidden shard? */
+#endif
 
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
     /* statistic account */
@@ -148,6 +153,12 @@ typedef struct IndexScanDescData
     /* state data for traversing HOT chains in index_getnext */
     bool        xs_continue_hot;    /* T if must keep walking HOT chain */
 
+#ifdef _SHARDING_
+    Bitmapset  *xs_shards;        /* only fetch heap tuples of these shards */
+    ExtentID    xs_shard_eid;    /* extent whose shard is cached */
+    bool        xs_shard_skip;    /* is xs_shard_eid outside xs_shards? */
+#endif
+
     
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
     /* statistic account */
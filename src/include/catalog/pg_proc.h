@@ -6688,6 +6688,19 @@ DESCR("gtm store: check gtm stored sequence status");
 DATA(insert OID = 5011 (  pg_check_storage_transaction        PGNSP PGUID 12 1 0 0 0 f f f f f f s r 1 0 2249 "16" "{16,25,25,23,23,1184,23,23,23,23}" "{i,o,o,o,o,o,o,o,o,o}" "{need_fix, gti_gid,node_list,gti_state,gti_store_handle,last_update_time,gs_next,gs_crc,error_msg,check_status}" _null_ _null_ pg_check_storage_transaction _null_ _null_ _null_ ));
 DESCR("gtm store: list gtm stored sequence info");
 
+DATA(insert OID = 5060 (  pg_stat_get_gts_batch        PGNSP PGUID 12 1 0 0 0 f f f f t f v s 0 0 2249 "" "{20,20,701,20,701,20}" "{o,o,o,o,o,o}" "{batches,requests,avg_batch_size,max_batch_size,avg_latency_us,max_latency_us}" _null_ _null_ pg_stat_get_gts_batch _null_ _null_ _null_ ));
+DESCR("statistics: batched snapshot global timestamp requests");
+DATA(insert OID = 5061 (  pg_stat_get_squeue_compression        PGNSP PGUID 12 1 0 0 0 f f f f t f v s 0 0 2249 "" "{20,20,20,20,701}" "{o,o,o,o,o}" "{streams,frames,raw_bytes,sent_bytes,ratio}" _null_ _null_ pg_stat_get_squeue_compression _null_ _null_ _null_ ));
+DESCR("statistics: compression of redistribution streams sent from this node");
+DATA(insert OID = 5062 (  pg_stat_get_remote_commit_latency        PGNSP PGUID 12 1 100 0 0 f f f f t t v s 0 0 2249 "" "{25,20,20}" "{o,o,o}" "{phase,le_us,count}" _null_ _null_ pg_stat_get_remote_commit_latency _null_ _null_ _null_ ));
+DESCR("statistics: latency histogram of the remote commit phases");
+DATA(insert OID = 5063 (  pg_stat_get_remote_commit_counts        PGNSP PGUID 12 1 0 0 0 f f f f t f v s 0 0 2249 "" "{20,20}" "{o,o}" "{one_phase,two_phase}" _null_ _null_ pg_stat_get_remote_commit_counts _null_ _null_ _null_ ));
+DESCR("statistics: write transactions committed in one and two phases");
+DATA(insert OID = 5064 (  pg_stat_get_remote_dml_batch_counts        PGNSP PGUID 12 1 0 0 0 f f f f t f v s 0 0 2249 "" "{20,20}" "{o,o}" "{batched_rows,round_trips_saved}" _null_ _null_ pg_stat_get_remote_dml_batch_counts _null_ _null_ _null_ ));
+DESCR("statistics: coordinator side INSERT rows sent to datanodes in batches");
+DATA(insert OID = 5065 (  pg_stat_get_sequence_cache        PGNSP PGUID 12 1 100 0 0 f f f f t t v s 0 0 2249 "" "{26,26,20,20,20,20,20}" "{o,o,o,o,o,o,o}" "{datid,seqrelid,hits,misses,refills,refill_time_us,max_refill_time_us}" _null_ _null_ pg_stat_get_sequence_cache _null_ _null_ _null_ ));
+DESCR("statistics: node-wide sequence value cache");
+
 DATA(insert OID = 8001 (  show_node_lock PGNSP PGUID 12 1 1000 0 0 f f f f t t v s 0 0 2249 "" "{25,25,25,25,25,25}" "{o,o,o,o,o,o}" "{HeavyLock,LightLock,Schema,Table,Shard,EventLock}" _null_ _null_ show_node_lock _null_ _null_ _null_ ));
 DESCR("show information about node lock");
 DATA(insert OID = 8002 (  pg_node_lock PGNSP PGUID 12 1 0 0 0 f f f f t f v s 6 0 16 "25 18 25 25 23 25" _null_ _null_ _null_ _null_  _null_ pg_node_lock _null_ _null_ _null_ ));
@@ -80,6 +80,9 @@ extern bool ActivateDatanodeStatementOnNode(const char *stmt_name, int nodeidx);
 extern bool HaveActiveDatanodeStatements(void);
 extern void DropDatanodeStatement(const char *stmt_name);
 extern void InactivateDatanodeStatementOnNode(int nodeidx);
+#ifdef __OPENTENBASE__
+extern void InactivateAllDatanodeStatements(void);
+#endif
 extern int SetRemoteStatementName(Plan *plan, const char *stmt_name, int num_params,
                         Oid *param_types, int n);
 #endif
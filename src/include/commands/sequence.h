@@ -102,6 +102,14 @@ extern bool IsTempSequence(Oid relid);
 extern char *GetGlobalSeqName(Relation rel, const char *new_seqname, const char *new_schemaname);
 #ifdef __OPENTENBASE__
 extern void RenameDatabaseSequence(const char* oldname, const char* newname);
+
+extern int shared_sequence_cache_range;
+
+extern Size SeqCacheShmemSize(void);
+extern void SeqCacheShmemInit(void);
+extern void AtEOXact_SeqCache(bool isCommit);
+extern void AtEOSubXact_SeqCache(bool isCommit, SubTransactionId mySubid,
+                                 SubTransactionId parentSubid);
 #endif
 #endif
 
@@ -200,6 +200,10 @@ typedef struct HashJoinTableData
 
     /* used for dense allocation of tuples (into linked chunks) */
     HashMemoryChunk chunks;        /* one list for the whole batch */
+#ifdef __OPENTENBASE__
+    /* hash values of all inner tuples, to be pushed to the outer producers */
+    struct bloom_filter *bloom;
+#endif
 }            HashJoinTableData;
 
 #endif                            /* HASHJOIN_H */
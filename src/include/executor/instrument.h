@@ -31,6 +31,7 @@ typedef struct BufferUsage
 	long		local_blks_written; /* # of local disk blocks written */
 	long		temp_blks_read; /* # of temp blocks read */
 	long		temp_blks_written;	/* # of temp blocks written */
+	long		shard_blks_skipped;	/* # of blocks of hidden shards skipped */
 	instr_time	blk_read_time;	/* time spent reading */
 	instr_time	blk_write_time; /* time spent writing */
 } BufferUsage;
@@ -37,6 +37,8 @@ extern void ExecParallelHashJoinInitializeDSM(HashJoinState *node, ParallelConte
 extern void ExecParallelHashJoinInitWorker(HashJoinState *node, ParallelWorkerContext *pwcxt);
 
 extern void ParallelHashJoinEreport(void);
+
+extern bool enable_runtime_bloom_filter;
 #endif
 
 #endif                            /* NODEHASHJOIN_H */
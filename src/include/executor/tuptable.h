@@ -127,6 +127,8 @@ typedef struct TupleTableSlot
     MemoryContext tts_drowcxt;     /* Context to store deformed */
     bool        tts_shouldFreeRow;    /* should pfree tts_dataRow? */
     struct AttInMetadata *tts_attinmeta;    /* store here info to extract values from the DataRow */
+    struct AttInMetadata *tts_attrecvmeta;  /* the same for DataRows in binary format */
+    struct DataRowOutMetadata *tts_attoutmeta;  /* info to build a DataRow of the values */
 #endif
     TupleDesc    tts_tupleDescriptor;    /* slot's tuple descriptor */
     MemoryContext tts_mcxt;        /* slot itself is in this context */
@@ -180,8 +182,16 @@ extern HeapTuple ExecCopySlotTuple_shard(TupleTableSlot *slot, bool hasshard, At
                                  AttrNumber secdiskey, Oid relid);
 extern MinimalTuple ExecCopySlotMinimalTuple(TupleTableSlot *slot);
 #ifdef PGXC
+struct StringInfoData;
+struct FmgrInfo;
+
+extern bool enable_binary_datarow;
+
 extern RemoteDataRow ExecCopySlotDatarow(TupleTableSlot *slot,
                     MemoryContext tmpcxt);
+extern bool DataRowBinaryCapable(TupleDesc tdesc);
+extern void DataRowAppendBinaryValue(struct StringInfoData *buf,
+                    Form_pg_attribute attr, struct FmgrInfo *sendfunc, Datum value);
 #endif
 extern HeapTuple ExecFetchSlotTuple(TupleTableSlot *slot);
 extern MinimalTuple ExecFetchSlotMinimalTuple(TupleTableSlot *slot);
@@ -104,6 +104,13 @@ typedef struct GTM_ThreadInfo
     bool                handle_standby;
 #endif
     GTM_WorkerStatistics  *stat_handle;     /* statistics hanndle */
+
+    /* load of a service thread, used to place new connections */
+    pg_atomic_uint32      thr_conn_count;       /* connections served */
+    pg_atomic_uint64      thr_request_count;    /* commands processed */
+    uint64                thr_sampled_requests; /* thr_request_count at last sample */
+    uint32                thr_request_rate;     /* commands per second at last sample */
+    volatile uint32       thr_queue_depth;      /* ready events of last epoll_wait */
     DataPumpBuf           *datapump_buff;   /* log collection buff */
     bool                  am_syslogger;
 } GTM_ThreadInfo;
@@ -157,6 +164,7 @@ extern   bool	enable_gtm_sequence_debug;
 extern	 bool 	enable_gtm_debug;
 extern   bool   enable_sync_commit;
 extern   int    warnning_time_cost;
+extern   bool   enable_gtm_load_balance;
 #endif
 /*
  * pthread keys to get thread specific information
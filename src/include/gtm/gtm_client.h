@@ -301,6 +301,7 @@ int bkup_begin_transaction(GTM_Conn *conn, GTM_IsolationLevel isolevel,
 						   uint32 client_id, GTM_Timestamp timestamp);
 #ifdef __OPENTENBASE__
 Get_GTS_Result get_global_timestamp(GTM_Conn *conn);
+Get_GTS_Result get_snapshot_global_timestamp(GTM_Conn *conn);
 #ifdef __XLOG__
 int check_gtm_status(GTM_Conn *conn, int *status, GTM_Timestamp *master,XLogRecPtr *master_ptr,
 					 int *standby_count,int **slave_is_sync, GTM_Timestamp **standby ,
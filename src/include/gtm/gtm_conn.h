@@ -30,6 +30,7 @@ typedef struct GTM_ConnectionInfo
     struct GTM_ThreadInfo    *con_thrinfo;
     bool                    con_authenticated;
     bool                    con_init;
+    bool                    con_counted;    /* counted in con_thrinfo's load */
     uint32                    con_client_id;
     uint32                    con_idx;
 
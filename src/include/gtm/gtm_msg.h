@@ -129,6 +129,9 @@ typedef enum GTM_MessageType
     MSG_GET_ERRORLOG,
 #endif
     MSG_SEQUENCE_COPY,
+#ifdef __OPENTENBASE__
+	MSG_GETGTS_SNAPSHOT,		/* Get a global timestamp for a snapshot */
+#endif
 
 	/*
 	 * Must be at the end
@@ -357,6 +357,7 @@ const char *const config_type_names[] =\
 #define GTM_OPTNAME_WORKER_THREADS		"worker_threads"
 #define GTM_OPTNAME_ENABLE_DEBUG        "enable_gtm_debug"
 #define GTM_OPTNAME_ENABLE_SEQ_DEBUG    "enable_gtm_sequence_debug"
+#define GTM_OPTNAME_ENABLE_LOAD_BALANCE "enable_gtm_load_balance"
 #define GTM_OPTNAME_SCALE_FACTOR_THREADS		"scale_factor_threads"
 #define GTM_OPTNAME_WORKER_THREADS_NUMBER		"worker_thread_number"
 
@@ -367,6 +368,7 @@ const char *const config_type_names[] =\
 #ifdef __XLOG__
 #define GTM_OPTNAME_SYNCHRONOUS_COMMIT	"synchronous_commit"
 #define GTM_OPTNAME_WAL_WRITER_DELAY    "wal_writer_delay"
+#define GTM_OPTNAME_WAL_COMMIT_DELAY    "wal_commit_delay"
 #define GTM_OPTNAME_CHECKPOINT_INTERVAL "checkpoint_interval"
 #define GTM_OPTNAME_ARCHIVE_COMMAND     "archive_command"
 #define GTM_OPTNAME_ARCHIVE_MODE        "archive_mode"
@@ -26,6 +26,7 @@
 #include "gtm/gtm_list.h"
 #include "gtm/gtm_msg.h"
 #include "gtm/libpq-fe.h"
+#include "port/atomics.h"
 
 extern char *GTMProxyLogFile;
 
@@ -104,6 +105,15 @@ typedef struct GTMProxy_ThreadInfo
 
     GTM_Conn                *thr_gtm_conn;        /* Connection to GTM */
 
+    /*
+     * Coalescing statistics: backend requests answered by grouped upstream
+     * requests, and the number of upstream requests that served them.
+     */
+    pg_atomic_uint64        thr_gts_requests;
+    pg_atomic_uint64        thr_gts_upstream;
+    pg_atomic_uint64        thr_snap_requests;
+    pg_atomic_uint64        thr_snap_upstream;
+
     /* Reconnect Info */
     int                        can_accept_SIGUSR2;
     int                        reconnect_issued;
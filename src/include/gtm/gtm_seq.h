@@ -58,6 +58,7 @@ typedef struct GTM_SeqInfo
 	int32			gs_ref_count;
 	int32			gs_state;
 	GTM_RWLock		gs_lock;
+	s_lock_t		gs_ref_lck;		/* protects gs_ref_count and gs_state */
 #ifdef __OPENTENBASE__
 	bool			 gs_reserved;	 /* whether we have reserve value*/
 	GTMStorageHandle gs_store_handle;
@@ -168,6 +168,8 @@ typedef struct GTM_Transactions
 	GTM_RWLock			gt_TransArrayLock;
 	pg_atomic_uint32	gt_global_xid;
 
+	/* gt_last_cycle and gt_global_timestamp are published via gt_ts_seqlock */
+	pg_atomic_uint64	gt_ts_seqlock;
 	GlobalTimestamp		gt_last_cycle;
 	GlobalTimestamp 	gt_global_timestamp;
 	/* For debug purpose */
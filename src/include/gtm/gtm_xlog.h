@@ -25,6 +25,10 @@
 #define NUM_XLOGINSERT_LOCKS  8
 
 #define XLOG_KEEP_ALIVE_TIME 10
+
+/* fsync batch size buckets: 1, 2, 3-4, 5-8, ... 65-128, more */
+#define XLOG_FLUSH_BATCH_BUCKETS 9
+
 typedef uint64 offset_t;
 
 typedef struct XLogCtlInsert
@@ -76,6 +80,14 @@ typedef struct XLogCtlData
 
     GTM_MutexLock  walwrite_lck;
     uint64         last_write_idx;
+
+    /* group flush, see XLogFlush() */
+    GTM_MutexLock  flush_lck;
+    GTM_CV         flush_cv;
+    bool           flush_in_progress;
+    XLogRecPtr     flush_request;    /* highest position asked to be flushed */
+    uint32         flush_waiters;    /* requests since the last flush started */
+    uint64         flush_batch_hist[XLOG_FLUSH_BATCH_BUCKETS];
     
     s_lock_t       walwirte_info_lck;
     XLogwrtResult  LogwrtResult;
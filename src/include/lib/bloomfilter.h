@@ -0,0 +1,45 @@
+/*-------------------------------------------------------------------------
+ *
+ * bloomfilter.h
+ *	  Space-efficient set membership testing on 32-bit hash values
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  src/include/lib/bloomfilter.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+/*
+ * The filter is a single palloc'd chunk with no pointers inside, so it can be
+ * copied byte for byte into shared memory or a network message and used
+ * there.  bloom_total_size() tells how many bytes to copy.
+ *
+ *		k_hash_funcs	number of bits set per element
+ *		seed			mixed into every element before probing
+ *		nbits			size of the bitset in bits, always a power of two
+ *		bitset			the bits
+ */
+typedef struct bloom_filter
+{
+	int			k_hash_funcs;
+	uint32		seed;
+	uint32		nbits;
+	unsigned char bitset[FLEXIBLE_ARRAY_MEMBER];
+} bloom_filter;
+
+#define BLOOM_FILTER_MIN_BYTES	64
+
+extern bloom_filter *bloom_create(double total_elems, Size max_bytes,
+			 uint32 seed);
+extern void bloom_free(bloom_filter *filter);
+extern Size bloom_total_size(bloom_filter *filter);
+extern bool bloom_check_size(bloom_filter *filter, Size size);
+extern void bloom_add_hash(bloom_filter *filter, uint32 hash);
+extern bool bloom_lacks_hash(bloom_filter *filter, uint32 hash);
+extern double bloom_prop_bits_set(bloom_filter *filter);
+
+#endif							/* BLOOMFILTER_H */
@@ -388,6 +388,7 @@ typedef struct Scan
 #ifdef __OPENTENBASE__
     bool        ispartchild;
     int         childidx;
+    Bitmapset  *scan_shards;    /* shards the quals can match, NULL = all */
 #endif
 } Scan;
 
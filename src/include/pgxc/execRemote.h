@@ -65,6 +65,8 @@
 #define BIT_SET(data, bit)   ((1 << (bit)) & (data)) 
 
 extern int DataRowBufferSize;
+extern bool enable_shard_route_cache;
+extern int remote_dml_batch_size;
 
 extern bool need_global_snapshot;
 extern List *executed_node_list;
@@ -231,6 +233,13 @@ typedef struct RemoteQueryState
     int            su_num_params;
 
     uint32        dml_prepared_mask[WORD_NUMBER_FOR_NODES]; 
+
+    /* INSERTs sent to the datanodes but not acknowledged yet */
+    int            dml_batch;            /* 0 undecided, 1 batch rows, -1 don't */
+    PGXCNodeHandle **dml_batch_conns;    /* connections with rows in flight */
+    int           *dml_batch_pending;    /* rows in flight per connection */
+    int            dml_batch_nconns;
+    int            dml_batch_rows;        /* rows in flight in total */
 #endif
 }    RemoteQueryState;
 
@@ -266,6 +275,8 @@ typedef struct RemoteSubplanState
     bool        finish_init;
     int32       eflags;                       /* estate flag. */
     ParallelWorkerStatus *parallel_status; /* Shared storage for parallel worker. */
+    bool        filter_pushed;          /* runtime filter was pushed down */
+    StringInfo  pending_filter;         /* runtime filter to send at start */
 #endif
 } RemoteSubplanState;
 
@@ -440,12 +451,17 @@ extern bool ExecRemoteDML(ModifyTableState *mtstate, ItemPointer tupleid, HeapTu
               TupleTableSlot *slot, TupleTableSlot *planSlot, EState *estate, EPQState *epqstate,
               bool canSetTag, TupleTableSlot **returning, UPSERT_ACTION *result,
               ResultRelInfo *resultRelInfo, int rel_index);
+extern void ExecRemoteDMLFlush(ModifyTableState *mtstate);
 extern void ExecDisconnectRemoteSubplan(RemoteSubplanState *node);
 extern void SetCurrentHandlesReadonly(void);
 
 extern TupleDesc create_tuple_desc(char *msg_body, size_t len);
 
 extern void ExecFinishRemoteSubplan(RemoteSubplanState *node);
+struct bloom_filter;
+extern void ExecRemoteSubplanPushFilter(RemoteSubplanState *node, int nkeys,
+                            AttrNumber *attnos, Oid *keytypes,
+                            struct bloom_filter *filter);
 extern void ExecShutdownRemoteSubplan(RemoteSubplanState *node);
 extern bool SetSnapshot(EState *state);
 
@@ -479,6 +495,14 @@ extern int pgxc_node_receive_responses(const int conn_count, PGXCNodeHandle ** c
 extern bool validate_combiner(ResponseCombiner *combiner);
 #endif
 
+#ifdef __OPENTENBASE__
+extern Size RemoteCommitStatsShmemSize(void);
+extern void RemoteCommitStatsShmemInit(void);
+extern Datum pg_stat_get_remote_commit_latency(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_remote_commit_counts(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_remote_dml_batch_counts(PG_FUNCTION_ARGS);
+#endif
+
 #ifdef __TWO_PHASE_TRANS__
 extern char *get_nodelist(char * prepareGID, bool localNode, bool implicit);
 extern void InitLocalTwoPhaseState(void);
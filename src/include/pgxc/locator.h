@@ -197,6 +197,9 @@ extern int getLocatorNodeCount(Locator *self);
 extern Oid primary_data_node;
 extern Oid preferred_data_node[MAX_PREFERRED_NODES];
 extern int num_preferred_data_nodes;
+#ifdef __OPENTENBASE__
+extern bool enable_shard_scan_pruning;
+#endif
 
 extern void InitRelationLocInfo(void);
 extern char GetLocatorType(Oid relid);
@@ -224,6 +227,13 @@ extern ExecNodes *GetRelationNodesByQuals(Oid reloid,
 										  RelationAccessType relaccess,
 										  Node **dis_qual,
 										  Node **sec_quals);
+#ifdef __OPENTENBASE__
+extern Bitmapset *GetRelationShardsByQuals(Oid reloid,
+										   RelationLocInfo *rel_loc_info,
+										   Index varno,
+										   Node *quals);
+extern bool ShardScanPruningEnabled(void);
+#endif
 
 extern bool IsTypeHashDistributable(Oid col_type);
 extern List *GetAllDataNodes(void);
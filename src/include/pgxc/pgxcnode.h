@@ -208,10 +208,15 @@ extern int	ensure_in_buffer_capacity(size_t bytes_needed, PGXCNodeHandle * handl
 extern int	ensure_out_buffer_capacity(size_t bytes_needed, PGXCNodeHandle * handle);
 
 extern int	pgxc_node_send_query(PGXCNodeHandle * handle, const char *query);
+extern int	pgxc_node_send_query_noflush(PGXCNodeHandle *handle, const char *query);
 extern int	pgxc_node_send_rollback(PGXCNodeHandle * handle, const char *query);
 extern int	pgxc_node_send_describe(PGXCNodeHandle * handle, bool is_statement,
 						const char *name);
 extern int	pgxc_node_send_execute(PGXCNodeHandle * handle, const char *portal, int fetch);
+#ifdef __OPENTENBASE__
+extern int	pgxc_node_send_runtime_filter(PGXCNodeHandle *handle, const char *portal,
+							  const char *body, int bodylen);
+#endif
 extern int	pgxc_node_send_close(PGXCNodeHandle * handle, bool is_statement,
 					 const char *name);
 extern int	pgxc_node_send_sync(PGXCNodeHandle * handle);
@@ -272,9 +277,13 @@ extern int	pgxc_node_is_data_enqueued(PGXCNodeHandle *conn);
 
 extern int	send_some(PGXCNodeHandle * handle, int len);
 extern int	pgxc_node_flush(PGXCNodeHandle *handle);
+extern int	pgxc_node_flush_all(PGXCNodeHandle **connections, int count);
 extern int	pgxc_node_flush_read(PGXCNodeHandle *handle);
 
 extern char get_message(PGXCNodeHandle *conn, int *len, char **msg);
+#ifdef __OPENTENBASE__
+extern int expand_compressed_message(PGXCNodeHandle *conn, char *msg, int len);
+#endif
 
 extern void add_error_message(PGXCNodeHandle * handle, const char *message);
 
@@ -286,6 +295,9 @@ extern void PGXCNodeResetParams(bool only_local);
 extern char *PGXCNodeGetSessionParamStr(void);
 extern char *PGXCNodeGetTransactionParamStr(void);
 extern void pgxc_node_set_query(PGXCNodeHandle *handle, const char *set_query);
+#ifdef __OPENTENBASE__
+extern void pgxc_node_set_query_finish(PGXCNodeHandle *handle);
+#endif
 extern void RequestInvalidateRemoteHandles(void);
 extern void RequestRefreshRemoteHandles(void);
 extern bool PoolerMessagesPending(void);
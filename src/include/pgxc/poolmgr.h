@@ -127,6 +127,7 @@ typedef struct
 	char	   *connstr;
 	int         nwarming;   /* connection number warming in progress */
 	int         nquery;     /* connection number query memory size in progress */
+	int         nbuilding;  /* connection number being established */
 	int			freeSize;	/* available connections */
 	int			size;  		/* total pool size */
 
@@ -143,6 +144,10 @@ typedef struct databasepool
 	char	   *pgoptions;		/* Connection options */
 	HTAB	   *nodePools; 		/* Hashtable of PGXCNodePool, one entry for each
 								 * Coordinator or DataNode */
+	PGXCNodePool **dnNodePools;	/* nodePools entries by datanode index */
+	PGXCNodePool **cnNodePools;	/* nodePools entries by coordinator index */
+	int32		ndnNodePools;
+	int32		ncnNodePools;
 	time_t		oldest_idle;
  	bool        bneed_warm;
 	bool        bneed_precreate;
@@ -258,6 +263,9 @@ extern int	PoolerPort;
 extern int	PoolConnKeepAlive;
 extern int	PoolMaintenanceTimeout;
 extern bool PersistentConnections;
+#ifdef __OPENTENBASE__
+extern bool enable_session_multiplexing;
+#endif
 
 extern char *g_PoolerWarmBufferInfo;
 extern char *g_unpooled_database;
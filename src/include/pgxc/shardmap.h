@@ -49,6 +49,7 @@
 #define STRINGLENGTH 1024   /* string buffer length */
 
 extern int32       GetNodeIndexByHashValue(Oid group, long shardIdx);
+extern uint32      GetShardMapVersion(void);
 extern Bitmapset  *g_DatanodeShardgroupBitmap;
 extern List       *g_TempKeyValueList;
 extern bool         g_IsExtension;
@@ -152,6 +152,7 @@ extern bool  g_DataPumpDebug;
 extern int32 g_SndThreadNum;
 extern int32 g_SndThreadBufferSize;
 extern int32 g_SndBatchSize;
+extern int32 g_SndCompressThreshold;
 extern int   consumer_connect_timeout;
 extern int   g_DisConsumer_timeout;
 
@@ -172,6 +173,42 @@ extern void SendDataRemote(SharedQueue squeue, int32 consumerIdx, TupleTableSlot
 
 extern void create_datapump_socket_dir(void);
 
+/*
+ * Compressed redistribution frame: 'z', int32 length, codec, int32 length of
+ * the raw data, compressed data.  The raw data is a run of complete protocol
+ * messages, the receiver splices it back into its input buffer.
+ */
+#define SQUEUE_COMPRESSED_MSG     'z'
+#define SQUEUE_COMPRESSED_HDRSZ   (1 + 4 + 1 + 4)
+#define SQUEUE_CODEC_LZ           1
+
+extern int32 SqueueCompressData(const char *src, int32 srclen, char *dst, int32 dstcap, uint32 *htab);
+extern int32 SqueueDecompressData(const char *src, int32 srclen, char *dst, int32 dstcap);
+extern Datum pg_stat_get_squeue_compression(PG_FUNCTION_ARGS);
+
+/*
+ * Runtime filter of a consumer: 'y', int32 length, portal name, int16 number
+ * of keys, for each key int16 column number and int32 type, then int32
+ * length and the Bloom filter of the hash values the consumer's hash join
+ * can match.  Keys are hashed with the default hash function of their type,
+ * combined the way ExecHashGetHashValue does.  The backend serving the
+ * consumer's connection stores the filter in the portal's shared queue, and
+ * the producer drops the rows for that consumer the filter rejects.
+ */
+#define SQUEUE_RUNTIME_FILTER_MSG        'y'
+#define SQUEUE_RUNTIME_FILTER_MAX_KEYS   8
+#define SQUEUE_RUNTIME_FILTER_MAX_BYTES  (32 * 1024)
+
+typedef struct RuntimeFilterCacheData *RuntimeFilterCache;
+
+extern void SharedQueueSetRuntimeFilter(struct StringInfoData *msg);
+extern void SharedQueuePollRuntimeFilter(void);
+extern RuntimeFilterCache SharedQueueRuntimeFilterCacheCreate(SharedQueue squeue);
+extern bool SharedQueueRuntimeFilterPass(RuntimeFilterCache cache, int consumerIdx,
+							 TupleTableSlot *slot);
+extern bool SharedQueueRuntimeFilterFlushPending(void);
+extern void AtEOXact_SharedQueueFilters(void);
+
 extern bool needParallelSend(SharedQueue squeue);
 extern void SetLocatorInfo(SharedQueue squeue, int *consMap, int len, char distributionType, Oid keytype, AttrNumber distributionKey);
 
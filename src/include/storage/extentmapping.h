@@ -412,6 +412,7 @@ extern void     ema_get_eme_extract(Relation rel,
                                             ShardID     *sid, 
                                             int *hwm, 
                                             uint8 *freespace);
+extern bool     ema_get_eme_shardid(Relation rel, ExtentID eid, ShardID *sid);
 extern void     ema_set_eme_hwm(Relation rel, ExtentID eid, int16 hwm);
 extern void     ema_set_eme_link(Relation rel, 
                                         ExtentID eid, 
@@ -271,6 +271,7 @@ extern bool    support_oracle_compatible;
 extern int32   g_TransferSpeed;
 /* slicent copy from */
 extern bool g_enable_copy_silence;
+extern bool g_enable_copy_partial_parse;
 extern bool g_enable_user_authority_force_check;
 extern bool enable_buffer_mprotect;
 extern bool enable_clog_mprotect;
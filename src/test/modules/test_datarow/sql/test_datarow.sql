@@ -0,0 +1,6 @@
+CREATE EXTENSION test_datarow;
+
+-- Both encodings must round-trip a lineitem-like row; timings vary, so only
+-- check that each run completed.
+SELECT test_datarow_bench(1000, false) >= 0 AS text_ok;
+SELECT test_datarow_bench(1000, true) >= 0 AS binary_ok;
@@ -0,0 +1,9 @@
+/* src/test/modules/test_datarow/test_datarow--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_datarow" to load this file. \quit
+
+CREATE FUNCTION test_datarow_bench(nrows pg_catalog.int4,
+                                   binary pg_catalog.bool)
+   RETURNS pg_catalog.float8
+       AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
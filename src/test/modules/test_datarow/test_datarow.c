@@ -0,0 +1,187 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_datarow.c
+ *		Micro-benchmark of text and binary inter-node DataRow encoding.
+ *
+ * Rows shaped like a TPC-H lineitem shuffle are encoded with
+ * ExecCopySlotDatarow and decoded again through a DataRow slot, which is
+ * the work a redistribution does per tuple on the sending and receiving
+ * side.  The GUC enable_binary_datarow selects the format for the run.
+ *
+ * Copyright (c) 2013-2017, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_datarow/test_datarow.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/tupdesc.h"
+#include "catalog/pg_type.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "portability/instr_time.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/timestamp.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(test_datarow_bench);
+
+#define BENCH_NATTS		8
+
+static TupleDesc
+bench_tupdesc(void)
+{
+	TupleDesc	tdesc = CreateTemplateTupleDesc(BENCH_NATTS, false);
+
+	TupleDescInitEntry(tdesc, 1, "l_orderkey", INT8OID, -1, 0);
+	TupleDescInitEntry(tdesc, 2, "l_partkey", INT4OID, -1, 0);
+	TupleDescInitEntry(tdesc, 3, "l_quantity", NUMERICOID, -1, 0);
+	TupleDescInitEntry(tdesc, 4, "l_extendedprice", NUMERICOID, -1, 0);
+	TupleDescInitEntry(tdesc, 5, "l_discount", FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tdesc, 6, "l_shipdate", DATEOID, -1, 0);
+	TupleDescInitEntry(tdesc, 7, "l_commitstamp", TIMESTAMPOID, -1, 0);
+	TupleDescInitEntry(tdesc, 8, "l_comment", TEXTOID, -1, 0);
+
+	return tdesc;
+}
+
+/*
+ * Fill values[] with the i-th row.  Numerics and the comment are built once
+ * by the caller so the loop measures the DataRow work, not the generator.
+ */
+static void
+bench_fill_row(Datum *values, int64 i, Datum *quantities, Datum price,
+			   Datum comment)
+{
+	values[0] = Int64GetDatum(i);
+	values[1] = Int32GetDatum((int32) (i % 200000));
+	values[2] = quantities[i % 50];
+	values[3] = price;
+	values[4] = Float8GetDatum(0.01 * (i % 11));
+	values[5] = DateADTGetDatum((DateADT) (i % 2556));
+	values[6] = TimestampGetDatum((Timestamp) i * USECS_PER_SEC);
+	values[7] = comment;
+}
+
+static void
+bench_check_row(TupleTableSlot *slot, Datum *values)
+{
+	TupleDesc	tdesc = slot->tts_tupleDescriptor;
+	int			i;
+
+	slot_getallattrs(slot);
+	for (i = 0; i < tdesc->natts; i++)
+	{
+		Oid			typoutput;
+		bool		typisvarlena;
+		char	   *expected;
+		char	   *actual;
+
+		if (slot->tts_isnull[i])
+			elog(ERROR, "column %d decoded as NULL", i + 1);
+
+		getTypeOutputInfo(TupleDescAttr(tdesc, i)->atttypid,
+						  &typoutput, &typisvarlena);
+		expected = OidOutputFunctionCall(typoutput, values[i]);
+		actual = OidOutputFunctionCall(typoutput, slot->tts_values[i]);
+		if (strcmp(expected, actual) != 0)
+			elog(ERROR, "column %d decoded as \"%s\", expected \"%s\"",
+				 i + 1, actual, expected);
+	}
+}
+
+/*
+ * test_datarow_bench(nrows, binary) returns the milliseconds spent encoding
+ * and decoding nrows rows in the chosen format.
+ */
+Datum
+test_datarow_bench(PG_FUNCTION_ARGS)
+{
+	int32		nrows = PG_GETARG_INT32(0);
+	bool		binary = PG_GETARG_BOOL(1);
+	bool		save_binary = enable_binary_datarow;
+	TupleDesc	tdesc;
+	TupleTableSlot *src;
+	TupleTableSlot *dst;
+	MemoryContext tmpcxt;
+	Datum		quantities[50];
+	Datum		price;
+	Datum		comment;
+	instr_time	start;
+	instr_time	duration;
+	int64		i;
+
+	if (nrows < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("nrows must be positive")));
+
+	tdesc = bench_tupdesc();
+	src = MakeSingleTupleTableSlot(tdesc);
+	dst = MakeSingleTupleTableSlot(tdesc);
+	tmpcxt = AllocSetContextCreate(CurrentMemoryContext,
+								   "test_datarow encode",
+								   ALLOCSET_DEFAULT_SIZES);
+
+	for (i = 0; i < 50; i++)
+		quantities[i] = DirectFunctionCall1(int4_numeric, Int32GetDatum(i + 1));
+	price = DirectFunctionCall3(numeric_in, CStringGetDatum("38214.56"),
+								ObjectIdGetDatum(InvalidOid),
+								Int32GetDatum(-1));
+	comment = CStringGetTextDatum("carefully final deposits detect slyly agai");
+
+	enable_binary_datarow = binary;
+	PG_TRY();
+	{
+		RemoteDataRow datarow;
+
+		/* make sure the chosen format round-trips before timing it */
+		ExecClearTuple(src);
+		bench_fill_row(src->tts_values, 0, quantities, price, comment);
+		memset(src->tts_isnull, false, BENCH_NATTS * sizeof(bool));
+		ExecStoreVirtualTuple(src);
+		datarow = ExecCopySlotDatarow(src, tmpcxt);
+		if (DataRowIsBinary(datarow) != binary)
+			elog(ERROR, "DataRow was not encoded in %s format",
+				 binary ? "binary" : "text");
+		ExecStoreDataRowTuple(datarow, dst, true);
+		bench_check_row(dst, src->tts_values);
+
+		INSTR_TIME_SET_CURRENT(start);
+		for (i = 0; i < nrows; i++)
+		{
+			ExecClearTuple(src);
+			bench_fill_row(src->tts_values, i, quantities, price, comment);
+			memset(src->tts_isnull, false, BENCH_NATTS * sizeof(bool));
+			ExecStoreVirtualTuple(src);
+
+			datarow = ExecCopySlotDatarow(src, tmpcxt);
+			ExecStoreDataRowTuple(datarow, dst, true);
+			slot_getallattrs(dst);
+
+			CHECK_FOR_INTERRUPTS();
+		}
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, start);
+	}
+	PG_CATCH();
+	{
+		enable_binary_datarow = save_binary;
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	enable_binary_datarow = save_binary;
+
+	ExecDropSingleTupleTableSlot(dst);
+	ExecDropSingleTupleTableSlot(src);
+	MemoryContextDelete(tmpcxt);
+
+	PG_RETURN_FLOAT8(INSTR_TIME_GET_MILLISEC(duration));
+}
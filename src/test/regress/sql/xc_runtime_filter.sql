@@ -0,0 +1,44 @@
+--
+-- XC_RUNTIME_FILTER
+--
+
+-- Bloom filters pushed from hash joins to the producers of a redistributed
+-- outer side must not change any result
+CREATE TABLE xc_rf_outer (a int, b int, c int) DISTRIBUTE BY SHARD (c);
+CREATE TABLE xc_rf_inner (a int, b int, v text) DISTRIBUTE BY SHARD (v);
+INSERT INTO xc_rf_outer SELECT CASE WHEN i % 97 = 0 THEN NULL ELSE i % 1000 END, i % 7, i FROM generate_series(1, 10000) i;
+INSERT INTO xc_rf_inner SELECT i * 3, i % 7, 'i' || i FROM generate_series(1, 50) i;
+INSERT INTO xc_rf_inner VALUES (NULL, 1, 'n1'), (NULL, 2, 'n2'), (3, 3, 'dup');
+ANALYZE xc_rf_outer;
+ANALYZE xc_rf_inner;
+SET enable_mergejoin = off;
+SET enable_nestloop = off;
+
+SET enable_runtime_bloom_filter = on;
+-- inner join
+SELECT count(*), sum(o.c) FROM xc_rf_outer o JOIN xc_rf_inner i ON o.a = i.a;
+-- semi join
+SELECT count(*), sum(o.c) FROM xc_rf_outer o WHERE EXISTS (SELECT 1 FROM xc_rf_inner i WHERE i.a = o.a);
+-- right join, the NULL keys of the inner side stay unmatched
+SELECT count(*), count(o.c), sum(o.c) FROM xc_rf_outer o RIGHT JOIN xc_rf_inner i ON o.a = i.a;
+-- multi-key join
+SELECT count(*), sum(o.c) FROM xc_rf_outer o JOIN xc_rf_inner i ON o.a = i.a AND o.b = i.b;
+SELECT count(*), count(o.c), sum(o.c) FROM xc_rf_outer o RIGHT JOIN xc_rf_inner i ON o.a = i.a AND o.b = i.b;
+-- join keys that are NULL on the outer side
+SELECT count(*) FROM xc_rf_outer o JOIN xc_rf_inner i ON o.a = i.a WHERE o.a IS NULL;
+SELECT count(*), count(i.v) FROM xc_rf_outer o LEFT JOIN xc_rf_inner i ON o.a = i.a WHERE o.a IS NULL;
+
+SET enable_runtime_bloom_filter = off;
+SELECT count(*), sum(o.c) FROM xc_rf_outer o JOIN xc_rf_inner i ON o.a = i.a;
+SELECT count(*), sum(o.c) FROM xc_rf_outer o WHERE EXISTS (SELECT 1 FROM xc_rf_inner i WHERE i.a = o.a);
+SELECT count(*), count(o.c), sum(o.c) FROM xc_rf_outer o RIGHT JOIN xc_rf_inner i ON o.a = i.a;
+SELECT count(*), sum(o.c) FROM xc_rf_outer o JOIN xc_rf_inner i ON o.a = i.a AND o.b = i.b;
+SELECT count(*), count(o.c), sum(o.c) FROM xc_rf_outer o RIGHT JOIN xc_rf_inner i ON o.a = i.a AND o.b = i.b;
+SELECT count(*) FROM xc_rf_outer o JOIN xc_rf_inner i ON o.a = i.a WHERE o.a IS NULL;
+SELECT count(*), count(i.v) FROM xc_rf_outer o LEFT JOIN xc_rf_inner i ON o.a = i.a WHERE o.a IS NULL;
+
+RESET enable_runtime_bloom_filter;
+RESET enable_mergejoin;
+RESET enable_nestloop;
+DROP TABLE xc_rf_outer;
+DROP TABLE xc_rf_inner;
@@ -0,0 +1,40 @@
+--
+-- XC_SEQUENCE_CACHE
+--
+
+-- Sequence values taken from the node-wide cache
+SET shared_sequence_cache_range = 10;
+CREATE SEQUENCE xc_seqcache_1;
+SELECT 'xc_seqcache_1'::regclass::oid AS seqcache_oid \gset
+
+-- Values keep their order across ranges
+SELECT nextval('xc_seqcache_1') FROM generate_series(1, 12);
+SELECT count(*), min(v), max(v), count(DISTINCT v)
+  FROM (SELECT nextval('xc_seqcache_1') AS v FROM generate_series(1, 40)) s;
+SELECT hits > 0 AS hits, misses > 0 AS misses
+  FROM pg_stat_get_sequence_cache() WHERE seqrelid = :seqcache_oid;
+
+-- setval and ALTER SEQUENCE throw away the cached values
+SELECT setval('xc_seqcache_1', 100);
+SELECT nextval('xc_seqcache_1');
+ALTER SEQUENCE xc_seqcache_1 RESTART WITH 500;
+SELECT nextval('xc_seqcache_1');
+SELECT nextval('xc_seqcache_1');
+
+-- The entry stays if the drop does not commit
+BEGIN;
+DROP SEQUENCE xc_seqcache_1;
+ROLLBACK;
+BEGIN;
+SAVEPOINT s1;
+DROP SEQUENCE xc_seqcache_1;
+ROLLBACK TO SAVEPOINT s1;
+COMMIT;
+SELECT count(*) FROM pg_stat_get_sequence_cache() WHERE seqrelid = :seqcache_oid;
+SELECT nextval('xc_seqcache_1');
+
+-- and is removed when it does
+DROP SEQUENCE xc_seqcache_1;
+SELECT count(*) FROM pg_stat_get_sequence_cache() WHERE seqrelid = :seqcache_oid;
+
+RESET shared_sequence_cache_range;
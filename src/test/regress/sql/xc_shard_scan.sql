@@ -0,0 +1,80 @@
+--
+-- XC_SHARD_SCAN
+--
+
+-- Scans of shard tables restricted to the shards of distribution key quals
+CREATE TABLE xc_shard_scan (a int, b text) DISTRIBUTE BY SHARD (a);
+INSERT INTO xc_shard_scan SELECT i, 'v' || i FROM generate_series(1, 1000) i;
+INSERT INTO xc_shard_scan VALUES (NULL, 'null');
+CREATE INDEX xc_shard_scan_a ON xc_shard_scan (a);
+ANALYZE xc_shard_scan;
+
+-- Sequential scans
+SET enable_indexscan = off;
+SET enable_indexonlyscan = off;
+SET enable_bitmapscan = off;
+SELECT a, b FROM xc_shard_scan WHERE a = 42;
+SELECT a, b FROM xc_shard_scan WHERE a IN (7, 42, 999) ORDER BY a;
+SELECT a, b FROM xc_shard_scan WHERE a IN (7, NULL) ORDER BY a;
+SELECT a, b FROM xc_shard_scan WHERE a = 1001;
+SELECT a, b FROM xc_shard_scan WHERE a = '42'::numeric;
+SELECT count(*) FROM xc_shard_scan WHERE a = 42 OR b = 'v43';
+SET enable_shard_scan_pruning = off;
+SELECT a, b FROM xc_shard_scan WHERE a = 42;
+SELECT a, b FROM xc_shard_scan WHERE a IN (7, 42, 999) ORDER BY a;
+SELECT a, b FROM xc_shard_scan WHERE a IN (7, NULL) ORDER BY a;
+SELECT a, b FROM xc_shard_scan WHERE a = 1001;
+SELECT a, b FROM xc_shard_scan WHERE a = '42'::numeric;
+SELECT count(*) FROM xc_shard_scan WHERE a = 42 OR b = 'v43';
+RESET enable_shard_scan_pruning;
+RESET enable_indexscan;
+RESET enable_indexonlyscan;
+RESET enable_bitmapscan;
+
+-- Index scans
+SET enable_seqscan = off;
+SET enable_indexonlyscan = off;
+SET enable_bitmapscan = off;
+SELECT a, b FROM xc_shard_scan WHERE a = 42;
+SELECT a, b FROM xc_shard_scan WHERE a IN (7, 42, 999) ORDER BY a;
+SELECT a, b FROM xc_shard_scan WHERE a IN (7, NULL) ORDER BY a;
+SELECT a, b FROM xc_shard_scan WHERE a = 1001;
+SELECT a, b FROM xc_shard_scan WHERE a = 42 AND b = 'v42';
+SET enable_shard_scan_pruning = off;
+SELECT a, b FROM xc_shard_scan WHERE a = 42;
+SELECT a, b FROM xc_shard_scan WHERE a IN (7, 42, 999) ORDER BY a;
+SELECT a, b FROM xc_shard_scan WHERE a IN (7, NULL) ORDER BY a;
+SELECT a, b FROM xc_shard_scan WHERE a = 1001;
+SELECT a, b FROM xc_shard_scan WHERE a = 42 AND b = 'v42';
+RESET enable_shard_scan_pruning;
+RESET enable_seqscan;
+RESET enable_indexonlyscan;
+RESET enable_bitmapscan;
+
+-- Prepared statements keep their shard set in the cached plan, it must
+-- not be used once the key to shard mapping or the switch changes
+PREPARE xc_shard_scan_const AS SELECT a, b FROM xc_shard_scan WHERE a = 42 ORDER BY b;
+PREPARE xc_shard_scan_param(int) AS SELECT a, b FROM xc_shard_scan WHERE a = $1 ORDER BY b;
+EXECUTE xc_shard_scan_const;
+EXECUTE xc_shard_scan_const;
+EXECUTE xc_shard_scan_param(42);
+EXECUTE xc_shard_scan_param(42);
+EXECUTE xc_shard_scan_param(42);
+EXECUTE xc_shard_scan_param(42);
+EXECUTE xc_shard_scan_param(42);
+EXECUTE xc_shard_scan_param(42);
+SET enable_key_value = on;
+INSERT INTO xc_shard_scan VALUES (42, 'v42 again');
+EXECUTE xc_shard_scan_const;
+EXECUTE xc_shard_scan_param(42);
+RESET enable_key_value;
+SET enable_shard_scan_pruning = off;
+EXECUTE xc_shard_scan_const;
+EXECUTE xc_shard_scan_param(42);
+RESET enable_shard_scan_pruning;
+EXECUTE xc_shard_scan_const;
+EXECUTE xc_shard_scan_param(42);
+DEALLOCATE xc_shard_scan_const;
+DEALLOCATE xc_shard_scan_param;
+
+DROP TABLE xc_shard_scan;